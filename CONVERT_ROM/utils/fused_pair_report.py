@@ -0,0 +1,84 @@
+import argparse
+import os
+import sys
+from collections import Counter
+
+from translate_rom_to_cpp import (BARRIER_HANDLERS, CPU_SM5A, CPU_SM510, CPU_SM511_2, JUMP_HANDLERS,
+                                  Translator, get_cpu, read_pack_roms)
+
+
+# Report of opcode pairs (one after the other in the rom, without jump between) of each game.
+# Used to choose the fused pairs of the block cache (get_fused_pairs() of each cpu, SM5XX_core.h).
+# Count is static (nb times in code reachable from reset), number of executions is in debug_fused_pair().
+
+# same list as get_fused_pairs() of each cpu (TR on SM5A, T on SM510 and SM511/2)
+FUSED_PAIRS = {
+    ("op_lb", "g_op_exc"), ("op_lb", "op_exci"), ("op_lb", "op_excd"), ("op_lb", "g_op_lda"),
+    ("g_op_lbl", "g_op_exc"), ("g_op_lbl", "op_exci"), ("g_op_lbl", "g_op_lda"),
+    ("g_op_tam", "op_t"), ("g_op_tc", "op_t"), ("g_op_ta0", "op_t"), ("g_op_tis", "op_t"),
+    ("g_op_tam", "op_tr"), ("g_op_tc", "op_tr"), ("g_op_ta0", "op_tr"), ("g_op_tis", "op_tr"),
+}
+
+
+def mnemonic(handler: str) -> str:
+    # op_exci -> EXCI, g_op_lbl -> LBL (same names as debug_fused_pair())
+    return handler.split("op_", 1)[1].upper()
+
+
+def count_pairs(translator: Translator) -> Counter:
+    pairs = Counter()
+    for pc in translator.walk():
+        first = translator.instruction(pc)
+        if first is None or first["handler"] in JUMP_HANDLERS or first["handler"] in BARRIER_HANDLERS:
+            continue
+        if first["handler"] == "g_op_lax":  # next opcode depend of LAX after it -> never first of a pair
+            continue
+        second = translator.instruction((pc[0], pc[1], first["word_after"]))
+        if second is None or second["handler"] in BARRIER_HANDLERS:
+            continue
+        pairs[(first["handler"], second["handler"])] += 1
+    return pairs
+
+
+def print_report(ref: str, cpu_name: str, pairs: Counter, top: int):
+    total = sum(pairs.values())
+    fused = sum(count for pair, count in pairs.items() if pair in FUSED_PAIRS)
+    print(f"{ref} ({cpu_name}) : {total} pairs, {fused} fused ({100.0 * fused / max(total, 1):.1f}%)")
+    for (first, second), count in pairs.most_common(top):
+        mark = "fused" if (first, second) in FUSED_PAIRS else ""
+        print(f"    {mnemonic(first) + '+' + mnemonic(second):<14} {count:>5}  {mark}")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Frequency of opcode pairs of Game & Watch roms (fused pairs of block cache)")
+    parser.add_argument("input", help="rom pack (.ykp) or rom file")
+    parser.add_argument("--game", action="append", default=[], help="ref of game (pack only, default all)")
+    parser.add_argument("--cpu", choices=["SM5A", "SM510", "SM511_2"], help="force cpu (default same choice as get_cpu())")
+    parser.add_argument("--top", type=int, default=10, help="nb pairs listed by game (default 10)")
+    args = parser.parse_args()
+
+    if args.input.lower().endswith(".ykp"):
+        roms = read_pack_roms(args.input)
+        if args.game:
+            roms = [(ref, rom) for ref, rom in roms if ref in args.game]
+    else:
+        with open(args.input, "rb") as f:
+            roms = [(os.path.splitext(os.path.basename(args.input))[0], f.read())]
+
+    all_pairs = Counter()
+    for ref, rom in roms:
+        cpu = {"SM5A": CPU_SM5A, "SM510": CPU_SM510, "SM511_2": CPU_SM511_2}[args.cpu] if args.cpu else get_cpu(rom)
+        if cpu is None:
+            print(f"{ref}: rom size {len(rom)} not supported, skipped")
+            continue
+        pairs = count_pairs(Translator(cpu, rom))
+        all_pairs.update(pairs)
+        print_report(ref, cpu.class_name, pairs, args.top)
+
+    if len(roms) > 1:
+        print_report("all games", "-", all_pairs, args.top * 2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,433 @@
+import argparse
+import os
+import re
+import struct
+import sys
+
+
+# Ahead of time translation of Game & Watch roms to C++ (see source/SM5XX/SM5XX_translated.h).
+# Walk the rom in the order of the program counter (6 bit polynomial counter, not +1), from reset
+# and from each jump target, and emit one function per basic block with opcodes already decoded.
+# The emulator use a block only if nothing else (clock event, sound) can happen during it.
+
+SCRIPT_DIR = os.path.dirname(__file__)
+REPO_DIR = os.path.abspath(os.path.join(SCRIPT_DIR, "..", ".."))
+DEFAULT_OUTPUT_DIR = os.path.join(REPO_DIR, "source", "SM5XX", "translated")
+
+ROM_WORD = 63  # word 63 is never reached by the program counter alone
+ROM_MAME_LINE = 16
+ROM_MAME_WORD = 64
+
+MAX_OPCODE_PER_BLOCK = 24
+MAX_CYCLE_PER_BLOCK = 128  # block need this free before next clock event (512 cycles) -> keep it small
+
+# same value as get_cpu_type_id()
+CPU_TYPE_SM5A = 0
+CPU_TYPE_SM510 = 1
+CPU_TYPE_SM511_2 = 2
+
+
+def next_word(word: int) -> int:
+    tmp = 1 if (word & 0x01) == ((word >> 1) & 0x01) else 0
+    return (tmp << 5) | (word >> 1)
+
+
+def rom_hash(rom: bytes) -> int:
+    # same as translated_rom_hash() (FNV-1a 32 bit)
+    h = 0x811C9DC5
+    for b in rom:
+        h ^= b
+        h = (h * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+##################################### Decode of each cpu #####################################
+# Copy of decode_opcode(), no_pc_increase() and is_on_double_octet() of each cpu
+
+def decode_sm5a(op: int) -> str:
+    hi = op & 0xF0
+    if hi == 0x20: return "g_op_lax"
+    if hi == 0x30: return "g_op_adx"
+    if hi == 0x40: return "op_lb"
+    if hi == 0x70: return "op_ssr"
+    if hi in (0x80, 0x90, 0xA0, 0xB0): return "op_tr"
+    if hi in (0xC0, 0xD0, 0xE0, 0xF0): return "op_trs"
+    by_fc = {0x04: "g_op_rm", 0x0C: "g_op_sm", 0x10: "g_op_exc", 0x14: "op_exci",
+             0x18: "g_op_lda", 0x1C: "op_excd", 0x54: "g_op_tmi"}
+    if (op & 0xFC) in by_fc: return by_fc[op & 0xFC]
+    return {
+        0x00: "op_skip", 0x01: "op_atr", 0x02: "op_sbm", 0x03: "op_atbp",
+        0x08: "g_op_add", 0x09: "g_op_add11", 0x0A: "g_op_coma", 0x0B: "g_op_exbla",
+        0x50: "g_op_ta", 0x51: "g_op_tb", 0x52: "g_op_tc", 0x53: "g_op_tam",
+        0x58: "g_op_tis", 0x59: "op_ptw", 0x5A: "g_op_ta0", 0x5B: "g_op_tabl",
+        0x5C: "op_tw", 0x5D: "op_dtw", 0x5E: "op_extended", 0x5F: "g_op_lbl",
+        0x60: "op_comcn", 0x61: "op_pdtw", 0x62: "op_wr", 0x63: "op_ws",
+        0x64: "op_incb", 0x65: "g_op_idiv", 0x66: "g_op_rc", 0x67: "g_op_sc",
+        0x68: "op_rmf", 0x69: "op_smf", 0x6A: "op_kta", 0x6B: "op_rbm",
+        0x6C: "op_decb", 0x6D: "op_comcb", 0x6E: "op_rtn", 0x6F: "op_rtns",
+    }.get(op, "g_op_illegal")
+
+
+def decode_sm510(op: int) -> str:
+    hi = op & 0xF0
+    if hi == 0x20: return "g_op_lax"
+    if hi == 0x30: return "g_op_adx"
+    if hi == 0x40: return "op_lb"
+    if hi in (0x80, 0x90, 0xA0, 0xB0): return "op_t"
+    if hi in (0xC0, 0xD0, 0xE0, 0xF0): return "op_tm"
+    by_fc = {0x04: "g_op_rm", 0x0C: "g_op_sm", 0x10: "g_op_exc", 0x14: "op_exci",
+             0x18: "g_op_lda", 0x1C: "op_excd", 0x54: "g_op_tmi",
+             0x70: "op_tl", 0x74: "op_tl", 0x78: "op_tl", 0x7C: "op_tml"}
+    if (op & 0xFC) in by_fc: return by_fc[op & 0xFC]
+    return {
+        0x00: "op_skip", 0x01: "op_atbp", 0x02: "op_sbm", 0x03: "op_atpl",
+        0x08: "g_op_add", 0x09: "g_op_add11", 0x0A: "g_op_coma", 0x0B: "g_op_exbla",
+        0x51: "g_op_tb", 0x52: "g_op_tc", 0x53: "g_op_tam", 0x58: "g_op_tis",
+        0x59: "op_atl", 0x5A: "g_op_ta0", 0x5B: "g_op_tabl", 0x5D: "g_op_cend",
+        0x5E: "g_op_ta", 0x5F: "g_op_lbl",
+        0x60: "op_atfc", 0x61: "op_atr", 0x62: "op_wr", 0x63: "op_ws",
+        0x64: "op_incb", 0x65: "g_op_idiv", 0x66: "g_op_rc", 0x67: "g_op_sc",
+        0x68: "op_tf1", 0x69: "op_tf4", 0x6A: "op_kta", 0x6B: "op_rot",
+        0x6C: "op_decb", 0x6D: "op_bdc", 0x6E: "op_rtn0", 0x6F: "op_rtn1",
+    }.get(op, "g_op_illegal")
+
+
+def decode_sm511_2(op: int) -> str:
+    hi = op & 0xF0
+    if hi == 0x20: return "g_op_lax"
+    if hi == 0x30: return "g_op_adx"
+    if hi == 0x40: return "op_lb"
+    if hi == 0x70: return "op_tl"
+    if hi in (0x80, 0x90, 0xA0, 0xB0): return "op_t"
+    if hi in (0xC0, 0xD0, 0xE0, 0xF0): return "op_tm"
+    by_fc = {0x04: "g_op_rm", 0x0C: "g_op_sm", 0x10: "g_op_exc", 0x14: "op_exci",
+             0x18: "g_op_lda", 0x1C: "op_excd", 0x54: "g_op_tmi", 0x68: "op_tml"}
+    if (op & 0xFC) in by_fc: return by_fc[op & 0xFC]
+    return {
+        0x00: "op_rot", 0x01: "op_dta", 0x02: "op_sbm", 0x03: "op_atpl",
+        0x08: "g_op_add", 0x09: "g_op_add11", 0x0A: "g_op_coma", 0x0B: "g_op_exbla",
+        0x50: "op_kta", 0x51: "g_op_tb", 0x52: "g_op_tc", 0x53: "g_op_tam",
+        0x58: "g_op_tis", 0x59: "op_atl", 0x5A: "g_op_ta0", 0x5B: "g_op_tabl",
+        0x5C: "op_atx", 0x5D: "g_op_cend", 0x5E: "g_op_ta", 0x5F: "g_op_lbl",
+        0x60: "op_extended", 0x61: "op_pre", 0x62: "op_wr", 0x63: "op_ws",
+        0x64: "op_incb", 0x65: "g_op_idiv", 0x66: "g_op_rc", 0x67: "g_op_sc",
+        0x6C: "op_decb", 0x6D: "op_ptw", 0x6E: "op_rtn0", 0x6F: "op_rtn1",
+    }.get(op, "g_op_illegal")
+
+
+class CpuDescription:
+    def __init__(self, type_id, class_name, header, rom_col, rom_line, start_pc, decode, no_pc_increase, double_octet):
+        self.type_id = type_id
+        self.class_name = class_name
+        self.header = header
+        self.rom_col = rom_col
+        self.rom_line = rom_line
+        self.start_pc = start_pc  # init() and wake_up()
+        self.decode = decode
+        self.no_pc_increase = no_pc_increase
+        self.double_octet = double_octet
+
+
+CPU_SM5A = CpuDescription(
+    CPU_TYPE_SM5A, "SM5A", "SM5XX/SM5A/SM5A.h", 2, 16, [(0, 0x0F, 0), (0, 0, 0)], decode_sm5a,
+    lambda op: (op & 0xC0) == 0x80 or (op & 0xFE) == 0x6E,
+    lambda op: op in (0x5F, 0x5E),
+)
+CPU_SM510 = CpuDescription(
+    CPU_TYPE_SM510, "SM510", "SM5XX/SM510/SM510.h", 4, 11, [(3, 7, 0), (1, 0, 0)], decode_sm510,
+    lambda op: (op & 0xC0) == 0x80 or op == 0x03 or (op & 0xFE) == 0x6E,
+    lambda op: op == 0x5F or (op & 0xF0) == 0x70,
+)
+CPU_SM511_2 = CpuDescription(
+    CPU_TYPE_SM511_2, "SM511_2", "SM5XX/SM511_SM512/SM511_2.h", 4, 16, [(3, 7, 0), (1, 0, 0)], decode_sm511_2,
+    lambda op: (op & 0xC0) == 0x80 or op == 0x03 or (op & 0xFE) == 0x6E,
+    lambda op: op == 0x5F or (op & 0xF0) == 0x70 or (op & 0xFC) == 0x68 or op in (0x60, 0x61),
+)
+
+
+# instruction can skip next one (skip_instruction())
+SKIP_HANDLERS = {
+    "g_op_add11", "g_op_adx", "g_op_ta", "g_op_tb", "g_op_tc", "g_op_tam", "g_op_tis", "g_op_tmi",
+    "g_op_ta0", "g_op_tabl", "op_incb", "op_decb", "op_exci", "op_excd", "op_tf1", "op_tf4",
+}
+# set program counter -> end of block
+JUMP_HANDLERS = {
+    "op_t", "op_tm", "op_tl", "op_tml", "op_atpl", "op_rtn0", "op_rtn1",  # SM510, SM511/2
+    "op_tr", "op_trs", "op_rtn", "op_rtns",  # SM5A
+}
+CALL_HANDLERS = {"op_tm", "op_tml", "op_trs"}  # return address in buffer
+RETURN_SKIP_HANDLERS = {"op_rtn1", "op_rtns"}  # skip instruction at return address (unknown here)
+# never translated -> sleep, clock divider, sound, frequency of cpu (always by interpreter)
+BARRIER_HANDLERS = {"g_op_cend", "g_op_idiv", "g_op_illegal", "op_extended", "op_atr"}
+EXTRA_CYCLE = {"op_tm": 2, "op_dtw": 2, "op_pdtw": 2}  # cycle_curr_opcode += 2 in instruction
+
+
+def get_cpu(rom: bytes):
+    # same as get_cpu() of main.cpp
+    if len(rom) == 1856:
+        return CPU_SM5A
+    if len(rom) == 4096:
+        if any(rom[704 + i] != 0x00 for i in range(16)):
+            return CPU_SM511_2
+        return CPU_SM510
+    return None
+
+
+##################################### Translation #####################################
+
+class Translator:
+    def __init__(self, cpu: CpuDescription, rom: bytes):
+        self.cpu = cpu
+        self.rom = rom
+
+    def valid(self, pc) -> bool:
+        col, line, word = pc
+        return col < self.cpu.rom_col and line < self.cpu.rom_line and word < ROM_WORD
+
+    def read(self, pc) -> int:
+        # same as load_rom() -> read_rom_value()
+        col, line, word = pc
+        index = ROM_MAME_LINE * ROM_MAME_WORD * col + ROM_MAME_WORD * line + word
+        return self.rom[index] if index < len(self.rom) else 0x00
+
+    def instruction(self, pc):
+        # decode of opcode on pc -> None if can not be translated
+        if not self.valid(pc):
+            return None
+        col, line, word = pc
+        op = self.read(pc)
+        handler = self.cpu.decode(op)
+        nb_byte = 2 if self.cpu.double_octet(op) else 1
+        nb_cycle = 2 * nb_byte
+
+        param = None
+        word_exec = word  # program counter during instruction (param of 2 octets opcode read by instruction)
+        word_after = word
+        if nb_byte == 2:
+            param_pc = (col, line, next_word(word))
+            if not self.valid(param_pc):
+                return None
+            param = self.read(param_pc)
+        if not self.cpu.no_pc_increase(op):
+            word_exec = next_word(word)
+            word_after = word_exec
+            if nb_byte == 2:
+                word_after = next_word(word_after)
+            if word_after == ROM_WORD:
+                return None
+
+        ins = {
+            "pc": pc, "opcode": op, "param": param, "handler": handler, "nb_byte": nb_byte,
+            "nb_cycle": nb_cycle, "word_exec": word_exec, "word_after": word_after, "skip_cycle": 0,
+            "extra_cycle": EXTRA_CYCLE.get(handler, 0),
+        }
+        if handler == "g_op_lax":
+            # next lax are always skipped (known with rom) -> program counter after all of them
+            next_pc = (col, line, word_after)
+            while self.valid(next_pc) and (self.read(next_pc) & 0xF0) == 0x20:
+                ins["extra_cycle"] += 2
+                next_pc = (col, line, next_word(next_pc[2]))
+            if not self.valid(next_pc):
+                return None
+            ins["word_after"] = next_pc[2]
+        elif handler in SKIP_HANDLERS:
+            skipped = self.instruction((col, line, word_after))
+            if skipped is None:
+                return None
+            ins["skip_cycle"] = skipped["nb_cycle"]
+        elif handler in RETURN_SKIP_HANDLERS:
+            ins["skip_cycle"] = 4  # worst case : opcode on 2 octets at return address
+        return ins
+
+    def skip(self, pc):
+        # same as skip_instruction() : pc after the instruction on pc, even if it is a jump
+        col, line, word = pc
+        word = next_word(word)
+        if self.cpu.double_octet(self.read(pc)):
+            word = next_word(word)
+        return (col, line, word)
+
+    def successors(self, ins):
+        # entries of block found with this instruction (the instruction itself are in a block or interpreted)
+        col, line, word = ins["pc"]
+        handler = ins["handler"]
+        op = ins["opcode"]
+        param = ins["param"]
+        next_pc = (col, line, ins["word_after"])
+        found = []
+
+        if handler not in JUMP_HANDLERS:
+            found.append(next_pc)
+            if ins["skip_cycle"] > 0 or handler == "op_extended":  # op_extended : tmel on SM511/2
+                found.append(self.skip(next_pc))
+            return found
+
+        if handler in CALL_HANDLERS:  # return address (+ skip of rtn1/rtns)
+            found.append(next_pc)
+            found.append(self.skip(next_pc))
+
+        if handler == "op_t":
+            found.append((col, line, op & 0x3F))
+        elif handler == "op_tl":
+            found.append(((param & 0xC0) >> 6, op & 0x0F, param & 0x3F))
+        elif handler == "op_tml":
+            found.append(((param & 0xC0) >> 6, op & 0x03, param & 0x3F))
+        elif handler == "op_tm":
+            idx = self.read((0, 0, op & 0x3F))
+            found.append(((idx & 0xC0) >> 6, 4, idx & 0x3F))
+        elif handler == "op_atpl":  # low part of word = accumulator
+            found.extend((col, line, (word & 0x30) | a) for a in range(16))
+        elif handler in ("op_tr", "op_trs"):  # SM5A : line and col depend of buffer / flags
+            found.extend((c, l, op & 0x3F) for c in range(self.cpu.rom_col) for l in range(self.cpu.rom_line))
+            if handler == "op_trs":
+                found.append((col, (line & 0x0C) | ((op & 0x30) >> 4), op & 0x0F))
+        return found
+
+    def walk(self):
+        # all entries reachable from start of cpu, in program counter order
+        entries = []
+        seen = set()
+        todo = list(self.cpu.start_pc)
+        while todo:
+            pc = todo.pop()
+            if pc in seen or not self.valid(pc):
+                continue
+            seen.add(pc)
+            entries.append(pc)
+            ins = self.instruction(pc)
+            if ins is not None:
+                todo.extend(self.successors(ins))
+        return sorted(entries)
+
+    def block(self, pc):
+        # basic block from pc : stop after jump, before instruction never translated, or at max size
+        instructions = []
+        max_cycle = 0
+        while len(instructions) < MAX_OPCODE_PER_BLOCK:
+            ins = self.instruction(pc)
+            if ins is None or ins["handler"] in BARRIER_HANDLERS:
+                break
+            cycle = ins["nb_cycle"] + ins["extra_cycle"]
+            if max_cycle + cycle + ins["skip_cycle"] > MAX_CYCLE_PER_BLOCK:
+                break
+            instructions.append(ins)
+            max_cycle += cycle
+            if ins["handler"] in JUMP_HANDLERS:
+                break
+            pc = (pc[0], pc[1], ins["word_after"])
+        if not instructions:
+            return None
+        # a skip end the block -> only one skip in worst case
+        max_cycle += max(ins["skip_cycle"] for ins in instructions)
+        return {
+            "pc": instructions[0]["pc"], "instructions": instructions, "max_cycle": max_cycle,
+            "end_by_jump": instructions[-1]["handler"] in JUMP_HANDLERS,
+        }
+
+
+def block_name(pc) -> str:
+    return "block_%d_%02d_%02x" % pc
+
+
+def generate_cpp(ref: str, rom: bytes, cpu: CpuDescription):
+    translator = Translator(cpu, rom)
+    entries = translator.walk()
+    blocks = [b for b in (translator.block(pc) for pc in entries) if b is not None]
+    h = "0x%08Xu" % rom_hash(rom)
+    name = "Translated_Rom<%s, %s>" % (cpu.class_name, h)
+    nb_opcode = sum(len(b["instructions"]) for b in blocks)
+
+    out = []
+    out.append("// Generated by CONVERT_ROM/utils/translate_rom_to_cpp.py -> do not edit")
+    out.append("// rom %s (%s, %d octets) : %d entries, %d blocks, %d opcodes" % (ref, cpu.class_name, len(rom), len(entries), len(blocks), nb_opcode))
+    out.append('#include "%s"' % cpu.header)
+    out.append('#include "SM5XX/SM5XX_translated.h"')
+    out.append("")
+    out.append("")
+    out.append("template <>")
+    out.append("struct %s {" % name)
+    out.append("    using CPU = %s;" % cpu.class_name)
+    out.append("    static const Translated_Block<CPU> blocks[%d];" % len(blocks))
+    for b in blocks:
+        out.append("")
+        out.append("    static uint32_t %s(CPU& cpu, uint32_t& nb_opcode){" % block_name(b["pc"]))
+        out.append("        uint32_t nb_cycle = 0;")
+        for i, ins in enumerate(b["instructions"]):
+            comment = "%02X" % ins["opcode"] if ins["param"] is None else "%02X %02X" % (ins["opcode"], ins["param"])
+            out.append("        nb_cycle += cpu.execute_translated_opcode<&CPU::%s>(0x%02X, %d, 0x%02X); // %s"
+                       % (ins["handler"], ins["opcode"], ins["nb_cycle"], ins["word_exec"], comment))
+            last = i == len(b["instructions"]) - 1
+            if ins["skip_cycle"] > 0 and not last:
+                out.append("        if(cpu.program_counter.word != 0x%02X){ nb_opcode += %d; return nb_cycle; } // skip"
+                           % (ins["word_after"], i + 1))
+        out.append("        nb_opcode += %d;" % len(b["instructions"]))
+        out.append("        return nb_cycle;")
+        out.append("    }")
+    out.append("};")
+    out.append("")
+    out.append("const Translated_Block<%s> %s::blocks[%d] = {" % (cpu.class_name, name, len(blocks)))
+    for b in blocks:
+        col, line, word = b["pc"]
+        out.append("    { %d, %d, %s, &%s::%s },"
+                   % ((col * 16 + line) * 64 + word, b["max_cycle"], "true" if b["end_by_jump"] else "false", name, block_name(b["pc"])))
+    out.append("};")
+    out.append("")
+    out.append("static Translated_Rom_Info translated_rom_info = {")
+    out.append('    %s, %d, %s::blocks, %d, "%s", nullptr' % (h, cpu.type_id, name, len(blocks), ref))
+    out.append("};")
+    out.append("static const bool translated_rom_registered = register_translated_rom(translated_rom_info);")
+    out.append("")
+    return "\n".join(out), len(blocks), nb_opcode
+
+
+##################################### Input #####################################
+
+def read_pack_roms(path: str):
+    # games of a yokoi_pack_<target>.ykp (see write of pack in convert_3ds.py)
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, _fmt, _platform, _content, nb_game, _nb_file, games_offset, _files_offset, _data_offset = struct.unpack_from("<IIIIIIIII", data, 0)
+    if magic != 0x31504B59:
+        raise ValueError(f"{path} is not a rom pack (YKP1)")
+    roms = []
+    for i in range(nb_game):
+        entry = struct.unpack_from("<" + "I" * 25, data, games_offset + i * 25 * 4)
+        ref_off, ref_len = entry[2], entry[3]
+        rom_off, rom_size = entry[6], entry[7]
+        ref = data[ref_off:ref_off + ref_len].decode("utf-8")
+        roms.append((ref, data[rom_off:rom_off + rom_size]))
+    return roms
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Translate Game & Watch roms to C++ (one file per game)")
+    parser.add_argument("input", help="rom pack (.ykp) or rom file")
+    parser.add_argument("--game", action="append", default=[], help="ref of game to translate (pack only, default all)")
+    parser.add_argument("--out", default=DEFAULT_OUTPUT_DIR, help="output folder (default source/SM5XX/translated)")
+    parser.add_argument("--cpu", choices=["SM5A", "SM510", "SM511_2"], help="force cpu (default same choice as get_cpu())")
+    args = parser.parse_args()
+
+    if args.input.lower().endswith(".ykp"):
+        roms = read_pack_roms(args.input)
+        if args.game:
+            roms = [(ref, rom) for ref, rom in roms if ref in args.game]
+    else:
+        with open(args.input, "rb") as f:
+            roms = [(os.path.splitext(os.path.basename(args.input))[0], f.read())]
+
+    os.makedirs(args.out, exist_ok=True)
+    for ref, rom in roms:
+        cpu = {"SM5A": CPU_SM5A, "SM510": CPU_SM510, "SM511_2": CPU_SM511_2}[args.cpu] if args.cpu else get_cpu(rom)
+        if cpu is None:
+            print(f"{ref}: rom size {len(rom)} not supported, skipped")
+            continue
+        code, nb_block, nb_opcode = generate_cpp(ref, rom, cpu)
+        path = os.path.join(args.out, "translated_" + re.sub(r"[^A-Za-z0-9_]", "_", ref) + ".cpp")
+        with open(path, "w", newline="\n") as f:
+            f.write(code)
+        print(f"{ref}: {cpu.class_name}, {nb_block} blocks, {nb_opcode} opcodes -> {path}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -67,6 +67,7 @@ void yokoi_return_to_menu_from_game() {
     g_gamea_pulse_frames.store(0);
     g_gameb_pulse_frames.store(0);
 
+    g_run_ahead.disable(); // second cpu of run-ahead is a copy of g_cpu
     g_cpu.reset();
     g_input.reset();
     g_segments.clear();
@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "SM5XX/SM5XX.h"
+#include "std/emulation_speed.h"
 
 namespace {
 std::atomic<bool> g_audio_can_run{false};
@@ -23,7 +24,8 @@ std::vector<int16_t> g_audio_ring;
 size_t g_audio_r = 0;
 size_t g_audio_w = 0;
 int g_audio_sample_rate = 0;
-uint16_t g_audio_wait = 0;
+uint32_t g_audio_accu_q16 = 0; // part of sample done (16.16)
+std::atomic<uint16_t> g_audio_speed_percent{SPEED_NORMAL};
 bool g_audio_curr_value = false;
 
 // ---------------------------
@@ -49,7 +51,7 @@ static void audio_reset_locked() {
     std::fill(g_audio_ring.begin(), g_audio_ring.end(), 0);
     g_audio_r = 0;
     g_audio_w = 0;
-    g_audio_wait = 0;
+    g_audio_accu_q16 = 0;
     g_audio_curr_value = false;
 }
 
@@ -277,26 +279,73 @@ void yokoi_audio_reconfigure_from_cpu(SM5XX* cpu) {
     audio_reset_locked();
 }
 
+// One cycle of sound. Normal speed: 1 sample each `div` cycles; faster skips samples, slower repeats them.
+static void audio_push_cycle_locked(bool value, uint32_t step_q16) {
+    g_audio_curr_value = g_audio_curr_value || value;
+    g_audio_accu_q16 += step_q16;
+    if (g_audio_accu_q16 < (1u << 16)) {
+        return;
+    }
+
+    // Square wave amplitude (matches 3DS behavior: on/off sample stream).
+    constexpr float kLimit = 0.8f;
+    int16_t sample = g_audio_curr_value ? (int16_t)(32767.0f * kLimit) : (int16_t)0;
+    g_audio_curr_value = false;
+    while (g_audio_accu_q16 >= (1u << 16)) {
+        g_audio_accu_q16 -= (1u << 16);
+        audio_push_sample_locked(sample);
+    }
+}
+
+static uint32_t audio_step_q16(SM5XX* cpu) {
+    const uint16_t percent = g_audio_speed_percent.load();
+    if (percent == SPEED_UNCAPPED || percent > SPEED_SOUND_MAX) {
+        return 0; // muted
+    }
+    uint16_t div = cpu->sound_divide_frequency ? (uint16_t)cpu->sound_divide_frequency : (uint16_t)1;
+    return speed_sample_step_q16(div, percent);
+}
+
+void yokoi_audio_set_speed(uint16_t percent) {
+    g_audio_speed_percent.store(percent);
+    std::lock_guard<std::mutex> lock(g_audio_mutex);
+    g_audio_accu_q16 = 0;
+}
+
 void yokoi_audio_update_step(SM5XX* cpu) {
     if (!cpu) {
         return;
     }
 
-    uint16_t div = cpu->sound_divide_frequency ? (uint16_t)cpu->sound_divide_frequency : (uint16_t)1;
-    g_audio_wait += 1;
-    g_audio_curr_value = g_audio_curr_value || cpu->get_active_sound();
-    if (g_audio_wait < div) {
+    const uint32_t step_q16 = audio_step_q16(cpu);
+    if (step_q16 == 0) {
         return;
     }
-    g_audio_wait = 0;
+    std::lock_guard<std::mutex> lock(g_audio_mutex);
+    audio_push_cycle_locked(cpu->get_active_sound(), step_q16);
+}
 
-    // Square wave amplitude (matches 3DS behavior: on/off sample stream).
-    constexpr float kLimit = 0.8f;
-    int16_t sample = g_audio_curr_value ? (int16_t)(32767.0f * kLimit) : (int16_t)0;
-    g_audio_curr_value = false;
+void yokoi_audio_update_events(SM5XX* cpu, const Cycle_Events& events, uint32_t nb_cycle) {
+    if (!cpu) {
+        return;
+    }
+
+    const uint32_t step_q16 = audio_step_q16(cpu);
+    if (step_q16 == 0) {
+        return;
+    }
 
+    // Same logic as yokoi_audio_update_step, but the mutex is taken once for the whole batch.
     std::lock_guard<std::mutex> lock(g_audio_mutex);
-    audio_push_sample_locked(sample);
+    bool value = events.sound_start;
+    uint16_t i_edge = 0;
+    for (uint32_t i_cycle = 0; i_cycle < nb_cycle; i_cycle++) {
+        if (i_edge < events.nb_sound_edge && events.sound_edge[i_edge] == i_cycle) {
+            value = !value;
+            i_edge++;
+        }
+        audio_push_cycle_locked(value, step_q16);
+    }
 }
 
 int yokoi_audio_get_source_rate() {
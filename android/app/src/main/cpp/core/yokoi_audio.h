@@ -3,6 +3,7 @@
 #include <cstdint>
 
 class SM5XX;
+struct Cycle_Events;
 
 void yokoi_audio_set_can_run(bool can_run);
 
@@ -12,6 +13,13 @@ void yokoi_audio_reconfigure_from_cpu(SM5XX* cpu);
 // Push one audio step based on CPU state. Intended to be called regularly from the emulation loop.
 void yokoi_audio_update_step(SM5XX* cpu);
 
+// Push the audio steps of a batch of `nb_cycle` cycles, rebuilt from the sound edges of run_cycles.
+void yokoi_audio_update_events(SM5XX* cpu, const Cycle_Events& events, uint32_t nb_cycle);
+
+// Speed of emulation (Emulation_Speed percent): samples skipped or repeated so sound keeps real-time length,
+// muted when too fast.
+void yokoi_audio_set_speed(uint16_t percent);
+
 // Returns the current source sample rate (best effort).
 int yokoi_audio_get_source_rate();
 
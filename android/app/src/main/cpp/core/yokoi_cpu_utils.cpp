@@ -3,9 +3,7 @@
 #include <time.h>
 
 #include "SM5XX/SM5XX.h"
-#include "SM5XX/SM5A/SM5A.h"
-#include "SM5XX/SM510/SM510.h"
-#include "SM5XX/SM511_SM512/SM511_2.h"
+#include "SM5XX/get_cpu.h"
 
 void yokoi_cpu_set_time_if_needed(SM5XX* cpu) {
     if (!cpu || cpu->is_time_set()) {
@@ -27,20 +25,12 @@ bool yokoi_cpu_create_instance(std::unique_ptr<SM5XX>& out, const uint8_t* rom,
         return false;
     }
 
-    if (size_rom == 1856) {
-        out = std::make_unique<SM5A>();
-        return true;
-    }
-    if (size_rom == 4096) {
-        // Heuristic from 3DS main.cpp
-        for (int i = 0; i < 16; i++) {
-            if (rom[i + 704] != 0x00) {
-                out = std::make_unique<SM511_2>();
-                return true;
-            }
-        }
-        out = std::make_unique<SM510>();
-        return true;
+    // Same as 3DS: choice of cpu + translated rom if linked, else interpreter
+    SM5XX* cpu = nullptr;
+    if (!get_cpu(cpu, rom, size_rom)) {
+        out.reset();
+        return false;
     }
-    return false;
+    out.reset(cpu);
+    return true;
 }
@@ -3,6 +3,7 @@
 #include <chrono>
 
 #include "SM5XX/SM5XX.h"
+#include "std/debug_log.h"
 
 #include "yokoi_audio.h"
 #include "yokoi_controller_state.h"
@@ -55,10 +56,24 @@ void emu_thread_main() {
                 int b = g_gameb_pulse_frames.load();
                 if (b > 0) g_gameb_pulse_frames.store(b - 1);
 
-                g_rate_accu += g_cpu->frequency;
-                uint32_t steps = (uint32_t)(g_rate_accu / kTargetFps);
-                g_rate_accu -= (uint32_t)(steps * kTargetFps);
-                while (steps > 0) {
+                uint32_t steps = g_emulation_speed.cycles_of_frame(g_cpu->frequency, kTargetFps);
+                // Segments presented from run-ahead, not from the real frame (except during time-set grace).
+                const bool use_run_ahead = g_run_ahead.is_active() && g_time_set_grace_counter <= 0;
+                // Fast: segments published once per host frame, not at each update nobody sees.
+                const bool segments_by_frame = g_emulation_speed.is_fast();
+                Cycle_Events cycle_events;
+                while (steps > 0 || g_emulation_speed.next_frame_in_budget(steps, g_cpu->frequency, kTargetFps)) {
+                    // Cycle by cycle only during the time-set grace period, else batch of cycles.
+                    if (g_time_set_grace_counter <= 0) {
+                        const uint32_t nb_cycle = g_cpu->run_cycles(steps, cycle_events);
+                        if (cycle_events.segments_updated && !use_run_ahead && !segments_by_frame) {
+                            update_segments_from_cpu(g_cpu.get());
+                        }
+                        yokoi_audio_update_events(g_cpu.get(), cycle_events, nb_cycle);
+                        steps -= nb_cycle;
+                        continue;
+                    }
+
                     if (g_cpu->step()) {
                         if (g_time_set_grace_counter > 0) {
                             g_time_set_grace_counter--;
@@ -70,6 +85,17 @@ void emu_thread_main() {
                     yokoi_audio_update_step(g_cpu.get());
                     steps--;
                 }
+
+                if (use_run_ahead) {
+                    g_run_ahead.run(g_cpu.get(), kTargetFps, [](SM5XX* future) { update_segments_from_cpu(future); });
+                    static uint32_t s_run_ahead_frames = 0;
+                    if (++s_run_ahead_frames % 600 == 0) {
+                        YOKOI_LOG("run-ahead: %u frame(s) cost last=%uus avg=%uus", (unsigned)g_run_ahead.get_nb_frame(),
+                                  (unsigned)g_run_ahead.get_last_cost_us(), (unsigned)g_run_ahead.get_average_cost_us());
+                    }
+                } else if (segments_by_frame) {
+                    update_segments_from_cpu(g_cpu.get()); // nothing if no update during the frame
+                }
             }
         }
 
@@ -53,7 +53,7 @@ void reset_runtime_state_for_new_game() {
     g_right_action_down.store(false);
     g_action_mask.store(0);
     g_start_requested.store(false);
-    g_rate_accu = 0;
+    g_emulation_speed.reset();
 }
 } // namespace
 
@@ -131,6 +131,8 @@ void yokoi_load_game_by_index_and_init(uint8_t idx) {
     update_segments_from_cpu(g_cpu.get());
     reset_runtime_state_for_new_game();
     g_time_set_grace_counter = kTimeSetGracePeriod;
+    const RunAheadSetting run_ahead = load_run_ahead_setting(g_game->ref);
+    g_run_ahead.configure(g_cpu.get(), g_game, run_ahead.mode, run_ahead.nb_frame);
     g_texture_generation.fetch_add(1);
 
     __android_log_print(ANDROID_LOG_INFO, kLogTag, "Loaded game: %s (%s)", g_game->name.c_str(), g_game->ref.c_str());
@@ -39,6 +39,8 @@ std::shared_ptr<const std::vector<Segment>> g_segments_meta;
 std::shared_ptr<std::vector<uint8_t>> g_seg_on_front;
 std::shared_ptr<std::vector<uint8_t>> g_seg_on_back;
 std::atomic<uint32_t> g_seg_generation{1};
+std::atomic<uint32_t> g_seg_publish_serial{0};
+Segment_Blink_Filter g_segment_blink_filter;
 
 void* g_asset_manager = nullptr;
 
@@ -85,6 +87,8 @@ float g_top_off_x = 0.0f;
 float g_bottom_off_x = 0.0f;
 float g_bottom_off_y = 0.0f;
 
-uint32_t g_rate_accu = 0;
+Emulation_Speed g_emulation_speed;
+
+Run_Ahead g_run_ahead;
 
 int g_time_set_grace_counter = 0;
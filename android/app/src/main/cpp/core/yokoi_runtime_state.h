@@ -9,7 +9,10 @@
 #include <vector>
 
 #include "std/GW_ROM.h"
+#include "std/run_ahead.h"
+#include "std/emulation_speed.h"
 #include "yokoi_gl.h"
+#include "yokoi_segments_state.h"
 
 class SM5XX;
 class Virtual_Input;
@@ -41,6 +44,10 @@ extern std::shared_ptr<const std::vector<Segment>> g_segments_meta;
 extern std::shared_ptr<std::vector<uint8_t>> g_seg_on_front;
 extern std::shared_ptr<std::vector<uint8_t>> g_seg_on_back;
 extern std::atomic<uint32_t> g_seg_generation;
+// +1 each time a new segment snapshot is published to g_seg_on_front (under g_segment_snapshot_mutex).
+// Same value -> renderers can reuse the segment vertices of the previous frame.
+extern std::atomic<uint32_t> g_seg_publish_serial;
+extern Segment_Blink_Filter g_segment_blink_filter;
 
 // Asset manager is Android-only; keep as void* here to avoid JNI includes.
 extern void* g_asset_manager;
@@ -88,7 +95,11 @@ extern float g_top_off_x;
 extern float g_bottom_off_x;
 extern float g_bottom_off_y;
 
-extern uint32_t g_rate_accu;
+// Cycles by frame (fast-forward / slow-motion), set from UI and used by emulation thread under g_cpu_mutex.
+extern Emulation_Speed g_emulation_speed;
+
+// Run-ahead of current game (setting per game), configured at load, used by emulation thread under g_cpu_mutex.
+extern Run_Ahead g_run_ahead;
 
 // Some games overwrite their clock RAM during early startup.
 // The implementation works around this by re-applying the host time for a short grace period.
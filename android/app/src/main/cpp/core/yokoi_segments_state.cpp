@@ -7,23 +7,17 @@
 #include "yokoi_runtime_state.h"
 
 void update_segments_from_cpu(SM5XX* cpu) {
+    update_segments_from_cpu(cpu, g_segment_blink_filter);
+}
+
+void update_segments_from_cpu(SM5XX* cpu, Segment_Blink_Filter& filter) {
     if (!cpu || !cpu->segments_state_are_update) {
         return;
     }
+    cpu->segments_state_are_update = false;
 
     std::shared_ptr<const std::vector<Segment>> meta;
     std::shared_ptr<std::vector<uint8_t>> back;
-    static thread_local std::vector<uint8_t> state;
-    static thread_local std::vector<uint8_t> buffer;
-    static thread_local uint32_t last_gen = 0;
-
-    const uint32_t gen = g_seg_generation.load();
-    if (gen != last_gen) {
-        state.clear();
-        buffer.clear();
-        last_gen = gen;
-    }
-
     {
         std::lock_guard<std::mutex> snap_lock(g_segment_snapshot_mutex);
         meta = g_segments_meta;
@@ -31,29 +25,33 @@ void update_segments_from_cpu(SM5XX* cpu) {
     }
 
     if (!meta || !back) {
-        cpu->segments_state_are_update = false;
         return;
     }
 
-    const size_t n = meta->size();
-    if (state.size() != n) state.assign(n, 0);
-    if (buffer.size() != n) buffer.assign(n, 0);
-    if (back->size() != n) back->assign(n, 0);
-
-    for (size_t i = 0; i < n; i++) {
-        const Segment& seg = (*meta)[i];
-        const bool new_state = cpu->get_segments_state(seg.id[0], seg.id[1], seg.id[2]);
+    const uint32_t gen = g_seg_generation.load();
+    const bool reset = (gen != filter.generation || filter.planes.size() != meta->size());
+    if (reset) {
+        filter.planes.set_segments(meta->data(), meta->size());
+        filter.generation = gen;
+    }
 
-        bool s = state[i] != 0;
-        bool b = buffer[i] != 0;
+    // Whole display compared with a few XOR: no change and filter stable -> same output, nothing to publish.
+    uint64_t changed[SEGMENT_BITS_WORD];
+    const bool segments_changed = cpu->read_segment_changes(changed) || cpu != filter.cpu_read;
+    filter.cpu_read = cpu;
+    if (!reset && !segments_changed && filter.planes.is_stable()) {
+        return;
+    }
 
-        // Same blink-protection behavior as 3DS renderer.
-        s = s && (new_state || b);
-        s = s || (new_state && b);
+    const bool visible_changed = filter.planes.update(cpu->segment_bits);
+    if (!reset && !visible_changed) {
+        return; // front buffer already shows this
+    }
 
-        buffer[i] = s ? 1 : 0;
-        state[i] = new_state ? 1 : 0;
-        (*back)[i] = buffer[i];
+    const size_t n = meta->size();
+    if (back->size() != n) back->assign(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        (*back)[i] = filter.planes.is_visible(i) ? 1 : 0;
     }
 
     // Publish the snapshot by swapping front/back pointers, but only if the generation
@@ -62,8 +60,7 @@ void update_segments_from_cpu(SM5XX* cpu) {
         std::lock_guard<std::mutex> snap_lock(g_segment_snapshot_mutex);
         if (g_seg_generation.load() == gen && g_seg_on_back == back) {
             std::swap(g_seg_on_front, g_seg_on_back);
+            g_seg_publish_serial.fetch_add(1);
         }
     }
-
-    cpu->segments_state_are_update = false;
 }
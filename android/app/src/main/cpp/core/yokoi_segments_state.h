@@ -1,9 +1,23 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
+
+#include "std/blink_filter.h"
 
 class SM5XX;
 
+// Blink-protection state of one emulated game (std/blink_filter.h, same code as 3DS renderer).
+// Owned by the caller -> several cpu instances do not share hidden buffers.
+struct Segment_Blink_Filter {
+    Blink_Filter planes;
+    uint32_t generation = 0; // g_seg_generation of the planes, other value -> segments set again
+    const SM5XX* cpu_read = nullptr; // segment_bits of this cpu in planes
+};
+
 // Publishes the latest segment on/off snapshot for rendering.
 // Same behavior as the prior in-file implementation.
+void update_segments_from_cpu(SM5XX* cpu, Segment_Blink_Filter& filter);
+
+// Same with the filter of g_cpu (g_segment_blink_filter)
 void update_segments_from_cpu(SM5XX* cpu);
@@ -935,107 +935,118 @@ static void render_frame(GlResources& r, int panel) {
             0x3db8e4u,
         };
 
-        static thread_local std::vector<RenderVertex> seg_verts;
-        seg_verts.clear();
-
-        // For non-mask segment atlases, some games tag certain segments with a color index.
-        // We batch lit segments by color index and draw them as alpha masks with a constant RGB.
-        static thread_local std::vector<RenderVertex> seg_color_verts[5];
-        bool has_colored_segments = false;
-        if (!is_mask) {
-            for (auto& v : seg_color_verts) {
-                v.clear();
-            }
-        }
-
         std::shared_ptr<const std::vector<Segment>> meta;
         std::shared_ptr<std::vector<uint8_t>> on;
+        uint32_t publish_serial = 0;
         {
             std::lock_guard<std::mutex> snap_lock(g_segment_snapshot_mutex);
             meta = g_segments_meta;
             on = g_seg_on_front;
-        }
-
-        const size_t seg_count = meta ? meta->size() : 0;
-        seg_verts.reserve(seg_count * 6);
-        if (!is_mask) {
-            for (auto& v : seg_color_verts) {
-                v.reserve(seg_count * 6);
-            }
-        }
-
-        // 3DS-style segment marking/shadow passes are only for non-mask segment atlases.
-        static thread_local std::vector<RenderVertex> seg_mark_verts;
-        static thread_local std::vector<RenderVertex> seg_shadow_verts;
-        if (!is_mask) {
-            seg_mark_verts.clear();
-            seg_shadow_verts.clear();
-            seg_mark_verts.reserve(seg_count * 6);
-            seg_shadow_verts.reserve(seg_count * 6);
-        } else {
-            seg_mark_verts.clear();
-            seg_shadow_verts.clear();
+            publish_serial = g_seg_publish_serial.load();
         }
 
         uint16_t scale = g_segment_info[2] ? g_segment_info[2] : 1;
         float texW = (float)g_segment_info[0];
         float texH = (float)g_segment_info[1];
 
-        if (meta) for (size_t si = 0; si < meta->size(); si++) {
-            const auto& seg = (*meta)[si];
-            const bool seg_on = (on && si < on->size()) ? ((*on)[si] != 0) : false;
-            if (!is_combined) {
-                if (!g_split_two_screens_to_panels && is_panel1) {
-                    continue;
-                }
-                if (g_split_two_screens_to_panels && (int)seg.screen != panel) {
-                    continue;
+        // Everything the vertices depend on besides the segment snapshot.
+        const float key[18] = {
+            (float)panel, contentW, contentH, panel_x, panel_y,
+            g_top_off_x, g_bottom_off_x, g_bottom_off_y,
+            g_screen_off_x[0], g_screen_off_x[1], g_screen_off_y[0], g_screen_off_y[1],
+            g_split_two_screens_to_panels ? 1.0f : 0.0f, (float)scale, texW, texH,
+            (r.tex_segments != 0) ? 1.0f : 0.0f, is_mask ? 1.0f : 0.0f,
+        };
+
+        // LCD unchanged since previous frame -> draw the same vertices again, no rebuild.
+        SegmentVertexCache& cache = r.seg_cache;
+        const bool cache_ok = cache.valid && cache.publish_serial == publish_serial
+                && cache.meta == meta.get() && cache.front == on.get()
+                && std::equal(key, key + 18, cache.key);
+
+        if (!cache_ok) {
+            cache.valid = true;
+            cache.publish_serial = publish_serial;
+            cache.meta = meta.get();
+            cache.front = on.get();
+            std::copy(key, key + 18, cache.key);
+
+            const size_t seg_count = meta ? meta->size() : 0;
+            cache.lit.clear();
+            cache.lit.reserve(seg_count * 6);
+            // For non-mask segment atlases, some games tag certain segments with a color index.
+            // We batch lit segments by color index and draw them as alpha masks with a constant RGB.
+            cache.has_colored = false;
+            for (auto& v : cache.color) {
+                v.clear();
+                if (!is_mask) {
+                    v.reserve(seg_count * 6);
                 }
             }
+            // 3DS-style segment marking/shadow passes are only for non-mask segment atlases.
+            cache.mark.clear();
+            cache.shadow.clear();
+            if (!is_mask) {
+                cache.mark.reserve(seg_count * 6);
+                cache.shadow.reserve(seg_count * 6);
+            }
 
-            float base_gx = 0.0f;
-            float base_gy = 0.0f;
-            get_screen_base_global(seg.screen, base_gx, base_gy);
-
-            float sx2 = (float)seg.pos_scr[0] / (float)scale + base_gx;
-            float sy2 = (float)seg.pos_scr[1] / (float)scale + base_gy;
-            float sw = (float)seg.size_tex[0] / (float)scale;
-            float sh = (float)seg.size_tex[1] / (float)scale;
-
-            float sx_local = to_local_x(sx2);
-            float sy_local = to_local_y(sy2);
-
-            float u0 = 0.0f;
-            float v0 = 0.0f;
-            float u1 = 1.0f;
-            float v1 = 1.0f;
+            if (meta) for (size_t si = 0; si < meta->size(); si++) {
+                const auto& seg = (*meta)[si];
+                const bool seg_on = (on && si < on->size()) ? ((*on)[si] != 0) : false;
+                if (!is_combined) {
+                    if (!g_split_two_screens_to_panels && is_panel1) {
+                        continue;
+                    }
+                    if (g_split_two_screens_to_panels && (int)seg.screen != panel) {
+                        continue;
+                    }
+                }
 
-            if (r.tex_segments != 0) {
-                float u = (float)seg.pos_tex[0];
-                float v = (float)seg.pos_tex[1];
-                float w = (float)seg.size_tex[0];
-                float h = (float)seg.size_tex[1];
-                calc_uv_rect(texW, texH, u, v, w, h, u0, v0, u1, v1);
-            }
+                float base_gx = 0.0f;
+                float base_gy = 0.0f;
+                get_screen_base_global(seg.screen, base_gx, base_gy);
+
+                float sx2 = (float)seg.pos_scr[0] / (float)scale + base_gx;
+                float sy2 = (float)seg.pos_scr[1] / (float)scale + base_gy;
+                float sw = (float)seg.size_tex[0] / (float)scale;
+                float sh = (float)seg.size_tex[1] / (float)scale;
+
+                float sx_local = to_local_x(sx2);
+                float sy_local = to_local_y(sy2);
+
+                float u0 = 0.0f;
+                float v0 = 0.0f;
+                float u1 = 1.0f;
+                float v1 = 1.0f;
+
+                if (r.tex_segments != 0) {
+                    float u = (float)seg.pos_tex[0];
+                    float v = (float)seg.pos_tex[1];
+                    float w = (float)seg.size_tex[0];
+                    float h = (float)seg.size_tex[1];
+                    calc_uv_rect(texW, texH, u, v, w, h, u0, v0, u1, v1);
+                }
 
-            if (!is_mask) {
-                // Segment marking effect: draw ALL segments very faintly (even if off).
-                // Matches 3DS: color ~0x101010 with user-controlled alpha.
-                append_quad_ndc_uv_canvas(seg_mark_verts, contentW, contentH, sx_local, sy_local, sw, sh, u0, v0, u1, v1);
+                if (!is_mask) {
+                    // Segment marking effect: draw ALL segments very faintly (even if off).
+                    // Matches 3DS: color ~0x101010 with user-controlled alpha.
+                    append_quad_ndc_uv_canvas(cache.mark, contentW, contentH, sx_local, sy_local, sw, sh, u0, v0, u1, v1);
 
-                // Shadow: draw only lit segments, slightly offset and darker.
-                if (seg_on) {
-                    append_quad_ndc_uv_canvas(seg_shadow_verts, contentW, contentH, sx_local + 2.0f, sy_local + 2.0f, sw, sh, u0, v0, u1, v1);
+                    // Shadow: draw only lit segments, slightly offset and darker.
+                    if (seg_on) {
+                        append_quad_ndc_uv_canvas(cache.shadow, contentW, contentH, sx_local + 2.0f, sy_local + 2.0f, sw, sh, u0, v0, u1, v1);
+                    }
                 }
-            }
 
-            // Main lit segments.
-            if (seg_on) {
-                if (!is_mask && seg.color_index > 0 && seg.color_index < 5) {
-                    has_colored_segments = true;
-                    append_quad_ndc_uv_canvas(seg_color_verts[seg.color_index], contentW, contentH, sx_local, sy_local, sw, sh, u0, v0, u1, v1);
-                } else {
-                    append_quad_ndc_uv_canvas(seg_verts, contentW, contentH, sx_local, sy_local, sw, sh, u0, v0, u1, v1);
+                // Main lit segments.
+                if (seg_on) {
+                    if (!is_mask && seg.color_index > 0 && seg.color_index < 5) {
+                        cache.has_colored = true;
+                        append_quad_ndc_uv_canvas(cache.color[seg.color_index], contentW, contentH, sx_local, sy_local, sw, sh, u0, v0, u1, v1);
+                    } else {
+                        append_quad_ndc_uv_canvas(cache.lit, contentW, contentH, sx_local, sy_local, sw, sh, u0, v0, u1, v1);
+                    }
                 }
             }
         }
@@ -1050,17 +1061,17 @@ static void render_frame(GlResources& r, int panel) {
         if (!is_mask) {
             // Pass 1: faint marking across all segments.
             float mark_a = (float)g_settings.segment_marking_alpha / 255.0f;
-            if (mark_a > 0.0f && !seg_mark_verts.empty()) {
+            if (mark_a > 0.0f && !cache.mark.empty()) {
                 float m = 16.0f / 255.0f;
                 glUniform4f(r.uMul, m, m, m, mark_a);
-                draw_vertices(seg_tex, seg_mark_verts);
+                draw_vertices(seg_tex, cache.mark);
             }
 
             // Pass 2: shadow under lit segments.
-            if (!seg_shadow_verts.empty()) {
+            if (!cache.shadow.empty()) {
                 float s = 17.0f / 255.0f;
                 glUniform4f(r.uMul, s, s, s, (float)0x18 / 255.0f);
-                draw_vertices(seg_tex, seg_shadow_verts);
+                draw_vertices(seg_tex, cache.shadow);
             }
         }
 
@@ -1078,17 +1089,17 @@ static void render_frame(GlResources& r, int panel) {
             }
             glUniform4f(r.uMul, seg_r, seg_g, seg_b, 1.0f);
         }
-        draw_vertices(seg_tex, seg_verts);
+        draw_vertices(seg_tex, cache.lit);
 
         // Extra pass: color-indexed segments (non-mask atlases only).
         // This mirrors the 3DS behavior (Virtual_Screen::update_screen) where the segment color
         // is selected via SEGMENT_COLOR[seg.color_index].
-        if (!is_mask && has_colored_segments) {
+        if (!is_mask && cache.has_colored) {
             if (r.uAlphaOnly >= 0) {
                 glUniform1f(r.uAlphaOnly, 1.0f);
             }
             for (uint32_t ci = 1; ci < 5; ci++) {
-                if (seg_color_verts[ci].empty()) {
+                if (cache.color[ci].empty()) {
                     continue;
                 }
                 const uint32_t rgb = kSegmentColorRgb[ci];
@@ -1096,7 +1107,7 @@ static void render_frame(GlResources& r, int panel) {
                 const float cg = (float)((rgb >> 8) & 0xFF) / 255.0f;
                 const float cb = (float)(rgb & 0xFF) / 255.0f;
                 glUniform4f(r.uMul, cr, cg, cb, 1.0f);
-                draw_vertices(seg_tex, seg_color_verts[ci]);
+                draw_vertices(seg_tex, cache.color[ci]);
             }
             // Restore default for subsequent layers.
             if (r.uAlphaOnly >= 0) {
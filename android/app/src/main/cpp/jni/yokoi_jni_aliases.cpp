@@ -37,6 +37,10 @@ JNIEXPORT jint JNICALL Java_com_retrovalou_yokoi_MainActivity_nativeGetBackgroun
 JNIEXPORT void JNICALL Java_com_retrovalou_yokoi_MainActivity_nativeSetBackgroundColor(JNIEnv* env, jclass clazz, jint rgb);
 JNIEXPORT jint JNICALL Java_com_retrovalou_yokoi_MainActivity_nativeGetSegmentMarkingAlpha(JNIEnv* env, jclass clazz);
 JNIEXPORT void JNICALL Java_com_retrovalou_yokoi_MainActivity_nativeSetSegmentMarkingAlpha(JNIEnv* env, jclass clazz, jint alpha);
+JNIEXPORT jint JNICALL Java_com_retrovalou_yokoi_MainActivity_nativeGetRunAheadFrames(JNIEnv* env, jclass clazz);
+JNIEXPORT void JNICALL Java_com_retrovalou_yokoi_MainActivity_nativeSetRunAheadFrames(JNIEnv* env, jclass clazz, jint frames);
+JNIEXPORT jint JNICALL Java_com_retrovalou_yokoi_MainActivity_nativeGetSpeedPercent(JNIEnv* env, jclass clazz);
+JNIEXPORT void JNICALL Java_com_retrovalou_yokoi_MainActivity_nativeSetSpeedPercent(JNIEnv* env, jclass clazz, jint percent);
 
 JNIEXPORT jboolean JNICALL Java_com_retrovalou_yokoi_MainActivity_nativeLoadRomPack(JNIEnv* env, jclass clazz, jstring path);
 JNIEXPORT jbyteArray JNICALL Java_com_retrovalou_yokoi_MainActivity_nativeGetPackFileBytes(JNIEnv* env, jclass clazz, jstring name);
@@ -218,3 +222,23 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_retrovalou_yokoi_nativebridge_YokoiNative_nativeSetSegmentMarkingAlpha(JNIEnv* env, jclass clazz, jint alpha) {
     Java_com_retrovalou_yokoi_MainActivity_nativeSetSegmentMarkingAlpha(env, clazz, alpha);
 }
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_retrovalou_yokoi_nativebridge_YokoiNative_nativeGetRunAheadFrames(JNIEnv* env, jclass clazz) {
+    return Java_com_retrovalou_yokoi_MainActivity_nativeGetRunAheadFrames(env, clazz);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_retrovalou_yokoi_nativebridge_YokoiNative_nativeSetRunAheadFrames(JNIEnv* env, jclass clazz, jint frames) {
+    Java_com_retrovalou_yokoi_MainActivity_nativeSetRunAheadFrames(env, clazz, frames);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_retrovalou_yokoi_nativebridge_YokoiNative_nativeGetSpeedPercent(JNIEnv* env, jclass clazz) {
+    return Java_com_retrovalou_yokoi_MainActivity_nativeGetSpeedPercent(env, clazz);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_retrovalou_yokoi_nativebridge_YokoiNative_nativeSetSpeedPercent(JNIEnv* env, jclass clazz, jint percent) {
+    Java_com_retrovalou_yokoi_MainActivity_nativeSetSpeedPercent(env, clazz, percent);
+}
@@ -1,8 +1,14 @@
 #include <jni.h>
 
 #include <cstdint>
+#include <mutex>
 
 #include "std/settings.h"
+#include "std/run_ahead.h"
+#include "std/emulation_speed.h"
+
+#include "yokoi_audio.h"
+#include "yokoi_runtime_state.h"
 
 extern "C" JNIEXPORT jint JNICALL
 Java_com_retrovalou_yokoi_MainActivity_nativeGetBackgroundColor(JNIEnv*, jclass) {
@@ -28,3 +34,43 @@ Java_com_retrovalou_yokoi_MainActivity_nativeSetSegmentMarkingAlpha(JNIEnv*, jcl
     g_settings.segment_marking_alpha = (uint8_t)alpha;
     save_settings();
 }
+
+// Run-ahead of the current game (0 = off), second cpu so audio stays continuous.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_retrovalou_yokoi_MainActivity_nativeGetRunAheadFrames(JNIEnv*, jclass) {
+    std::lock_guard<std::mutex> cpu_lock(g_cpu_mutex);
+    return g_game ? (jint)load_run_ahead_setting(g_game->ref).nb_frame : 0;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_retrovalou_yokoi_MainActivity_nativeSetRunAheadFrames(JNIEnv*, jclass, jint frames) {
+    if (frames < 0) frames = 0;
+    if (frames > RUN_AHEAD_MAX_FRAME) frames = RUN_AHEAD_MAX_FRAME;
+    std::lock_guard<std::mutex> cpu_lock(g_cpu_mutex);
+    if (!g_game) {
+        return;
+    }
+    RunAheadSetting setting;
+    setting.mode = RUN_AHEAD_SECOND;
+    setting.nb_frame = (uint8_t)frames;
+    save_run_ahead_setting(g_game->ref, setting);
+    if (g_cpu) {
+        g_run_ahead.configure(g_cpu.get(), g_game, setting.mode, setting.nb_frame);
+    }
+}
+
+// Speed of emulation in percent (0 = uncapped), for the session only.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_retrovalou_yokoi_MainActivity_nativeGetSpeedPercent(JNIEnv*, jclass) {
+    std::lock_guard<std::mutex> cpu_lock(g_cpu_mutex);
+    return (jint)g_emulation_speed.get_percent();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_retrovalou_yokoi_MainActivity_nativeSetSpeedPercent(JNIEnv*, jclass, jint percent) {
+    if (percent < 0) percent = SPEED_NORMAL;
+    if (percent > 800) percent = 800;
+    std::lock_guard<std::mutex> cpu_lock(g_cpu_mutex);
+    g_emulation_speed.set_percent((uint16_t)percent);
+    yokoi_audio_set_speed((uint16_t)percent);
+}
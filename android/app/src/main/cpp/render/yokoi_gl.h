@@ -4,6 +4,8 @@
 #include <GLES3/gl3.h>
 
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
 struct RenderVertex {
     float x;
@@ -12,6 +14,22 @@ struct RenderVertex {
     float v;
 };
 
+// Vertices of the segment layer kept between frames by render_frame.
+// Rebuilt only when a new segment snapshot is published or the layout/texture/panel changed (key).
+struct SegmentVertexCache {
+    bool valid = false;
+    uint32_t publish_serial = 0;
+    const void* meta = nullptr;
+    const void* front = nullptr;
+    float key[18] = {};
+
+    std::vector<RenderVertex> lit;
+    std::vector<RenderVertex> color[5]; // lit segments with Segment::color_index > 0
+    std::vector<RenderVertex> mark;
+    std::vector<RenderVertex> shadow;
+    bool has_colored = false;
+};
+
 struct GlResources {
     EGLContext ctx = EGL_NO_CONTEXT;
     int width = 0;
@@ -40,6 +58,8 @@ struct GlResources {
     int tex_console_h = 0;
     int tex_ui_w = 0;
     int tex_ui_h = 0;
+
+    SegmentVertexCache seg_cache;
 };
 
 GLuint yokoi_gl_compile_shader(GLenum type, const char* src);
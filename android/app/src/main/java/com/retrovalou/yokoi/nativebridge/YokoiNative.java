@@ -61,4 +61,12 @@ public final class YokoiNative {
 
     public static native int nativeGetSegmentMarkingAlpha();
     public static native void nativeSetSegmentMarkingAlpha(int alpha);
+
+    // Run-ahead of the current game, 0 = off.
+    public static native int nativeGetRunAheadFrames();
+    public static native void nativeSetRunAheadFrames(int frames);
+
+    // Speed of emulation in percent, 0 = uncapped.
+    public static native int nativeGetSpeedPercent();
+    public static native void nativeSetSpeedPercent(int percent);
 }
@@ -61,6 +61,35 @@ public final class SettingsMenu {
             10,
     };
 
+    private static final String[] RUN_AHEAD_NAMES = new String[]{
+            "Off",
+            "1 frame",
+            "2 frames",
+            "3 frames",
+            "4 frames",
+    };
+
+    private static final String[] SPEED_NAMES = new String[]{
+            "25%",
+            "50%",
+            "Normal",
+            "200%",
+            "400%",
+            "800%",
+            "Uncapped",
+    };
+
+    // Same order as SPEED_PRESETS of native emulation_speed.h, 0 = uncapped.
+    private static final int[] SPEED_PERCENT = new int[]{
+            25,
+            50,
+            100,
+            200,
+            400,
+            800,
+            0,
+    };
+
     public SettingsMenu(Activity activity) {
         this.activity = activity;
     }
@@ -166,6 +195,72 @@ public final class SettingsMenu {
             }
         });
 
+        if (inGame) {
+            TextView runAheadLabel = new TextView(activity);
+            runAheadLabel.setText("Run-ahead (this game)");
+            LinearLayout.LayoutParams runAheadLp = new LinearLayout.LayoutParams(
+                    ViewGroup.LayoutParams.WRAP_CONTENT,
+                    ViewGroup.LayoutParams.WRAP_CONTENT);
+            runAheadLp.topMargin = pad / 2;
+            runAheadLabel.setLayoutParams(runAheadLp);
+            root.addView(runAheadLabel);
+
+            Spinner runAheadSpinner = new Spinner(activity);
+            ArrayAdapter<String> runAheadAdapter = new ArrayAdapter<>(activity, android.R.layout.simple_spinner_item, RUN_AHEAD_NAMES);
+            runAheadAdapter.setDropDownViewResource(android.R.layout.simple_spinner_dropdown_item);
+            runAheadSpinner.setAdapter(runAheadAdapter);
+            runAheadSpinner.setSelection(clampInt(YokoiNative.nativeGetRunAheadFrames(), 0, RUN_AHEAD_NAMES.length - 1));
+            root.addView(runAheadSpinner);
+
+            final boolean[] ignoreFirstRunAhead = new boolean[]{true};
+            runAheadSpinner.setOnItemSelectedListener(new AdapterView.OnItemSelectedListener() {
+                @Override
+                public void onItemSelected(AdapterView<?> parent, View view, int position, long id) {
+                    if (ignoreFirstRunAhead[0]) {
+                        ignoreFirstRunAhead[0] = false;
+                        return;
+                    }
+                    YokoiNative.nativeSetRunAheadFrames(clampInt(position, 0, RUN_AHEAD_NAMES.length - 1));
+                }
+
+                @Override
+                public void onNothingSelected(AdapterView<?> parent) {
+                }
+            });
+
+            TextView speedLabel = new TextView(activity);
+            speedLabel.setText("Speed");
+            LinearLayout.LayoutParams speedLp = new LinearLayout.LayoutParams(
+                    ViewGroup.LayoutParams.WRAP_CONTENT,
+                    ViewGroup.LayoutParams.WRAP_CONTENT);
+            speedLp.topMargin = pad / 2;
+            speedLabel.setLayoutParams(speedLp);
+            root.addView(speedLabel);
+
+            Spinner speedSpinner = new Spinner(activity);
+            ArrayAdapter<String> speedAdapter = new ArrayAdapter<>(activity, android.R.layout.simple_spinner_item, SPEED_NAMES);
+            speedAdapter.setDropDownViewResource(android.R.layout.simple_spinner_dropdown_item);
+            speedSpinner.setAdapter(speedAdapter);
+            speedSpinner.setSelection(findSpeedIndex(YokoiNative.nativeGetSpeedPercent()));
+            root.addView(speedSpinner);
+
+            final boolean[] ignoreFirstSpeed = new boolean[]{true};
+            speedSpinner.setOnItemSelectedListener(new AdapterView.OnItemSelectedListener() {
+                @Override
+                public void onItemSelected(AdapterView<?> parent, View view, int position, long id) {
+                    if (ignoreFirstSpeed[0]) {
+                        ignoreFirstSpeed[0] = false;
+                        return;
+                    }
+                    YokoiNative.nativeSetSpeedPercent(SPEED_PERCENT[clampInt(position, 0, SPEED_PERCENT.length - 1)]);
+                }
+
+                @Override
+                public void onNothingSelected(AdapterView<?> parent) {
+                }
+            });
+        }
+
         TextView overlayLabel = new TextView(activity);
         overlayLabel.setText("On-screen controls");
         LinearLayout.LayoutParams overlayLabelLp = new LinearLayout.LayoutParams(
@@ -255,6 +350,15 @@ public final class SettingsMenu {
         dialog.show();
     }
 
+    private static int findSpeedIndex(int percent) {
+        for (int i = 0; i < SPEED_PERCENT.length; i++) {
+            if (SPEED_PERCENT[i] == percent) {
+                return i;
+            }
+        }
+        return 2; // Normal
+    }
+
     private static int clampInt(int v, int lo, int hi) {
         if (v < lo) return lo;
         if (v > hi) return hi;
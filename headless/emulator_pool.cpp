@@ -0,0 +1,236 @@
+#include "emulator_pool.h"
+
+#include "SM5XX/get_cpu.h"
+#include "virtual_i_o/virtual_input.h"
+#include "headless_game.h"
+
+
+Emulator_Pool::Emulator_Pool(unsigned nb_thread){
+    if(nb_thread == 0){ nb_thread = std::thread::hardware_concurrency(); }
+    if(nb_thread == 0){ nb_thread = 1; }
+
+    for(unsigned i = 0; i < nb_thread; i++){ queues.push_back(std::make_unique<Worker_Queue>()); }
+    for(unsigned i = 0; i < nb_thread; i++){ workers.emplace_back(&Emulator_Pool::worker_loop, this, size_t(i)); }
+}
+
+
+Emulator_Pool::~Emulator_Pool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    start_cv.notify_all();
+    for(std::thread& worker : workers){ worker.join(); }
+
+    for(auto& inst : instances){
+        delete inst->input; // use cpu -> before it
+        delete inst->cpu;
+    }
+    for(auto& list : free_cpu){
+        for(SM5XX* cpu : list){ delete cpu; }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Instances ///////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int Emulator_Pool::add_instance(const GW_rom* game){
+    if(get_cpu_type(game->rom, uint16_t(game->size_rom)) == CPU_TYPE_UNKNOWN){ return -1; }
+
+    int id;
+    if(!free_ids.empty()){
+        id = free_ids.back();
+        free_ids.pop_back();
+    }
+    else {
+        id = int(instances.size());
+        instances.push_back(std::make_unique<Pool_Instance>());
+        instances[id]->id = id;
+    }
+
+    load_game(*instances[id], game);
+    instances[id]->active = true;
+    nb_active++;
+    return id;
+}
+
+
+bool Emulator_Pool::reset_instance(int id, const GW_rom* game){
+    if(get_cpu_type(game->rom, uint16_t(game->size_rom)) == CPU_TYPE_UNKNOWN){ return false; }
+    load_game(*instances[id], game);
+    return true;
+}
+
+
+void Emulator_Pool::restart_instance(int id, const void* state){
+    Pool_Instance& inst = *instances[id];
+    if(!inst.active){ return; }
+
+    // rom, melody, time addresses and block cache stay valid -> only variables of cpu
+    SM5XX* cpu = inst.cpu;
+    if(state != nullptr){ cpu->restore(state); }
+    else {
+        cpu->init();
+        cpu->time_set(false);
+        cpu->segments_state_are_update = false;
+        cpu->set_input_multiplexage(inst.input == nullptr || inst.input->use_multiplexage);
+    }
+
+    inst.curr_rate = 0;
+    inst.nb_frame = 0;
+    inst.nb_opcode = 0;
+}
+
+
+void Emulator_Pool::remove_instance(int id){
+    Pool_Instance& inst = *instances[id];
+    if(!inst.active){ return; }
+
+    // cpu kept for next instance of same cpu type
+    delete inst.input;
+    inst.input = nullptr;
+    free_cpu[inst.cpu_type].push_back(inst.cpu);
+    inst.cpu = nullptr;
+    inst.game = nullptr;
+    inst.active = false;
+
+    free_ids.push_back(id);
+    nb_active--;
+}
+
+
+void Emulator_Pool::load_game(Pool_Instance& inst, const GW_rom* game){
+    uint8_t cpu_type = get_cpu_type(game->rom, uint16_t(game->size_rom));
+
+    delete inst.input; // link to cpu and game
+    inst.input = nullptr;
+    if(inst.cpu != nullptr && inst.cpu_type != cpu_type){
+        free_cpu[inst.cpu_type].push_back(inst.cpu);
+        inst.cpu = nullptr;
+    }
+
+    if(inst.cpu == nullptr && !free_cpu[cpu_type].empty()){
+        inst.cpu = free_cpu[cpu_type].back();
+        free_cpu[cpu_type].pop_back();
+    }
+
+    if(inst.cpu == nullptr){ get_cpu(inst.cpu, game->rom, uint16_t(game->size_rom)); } // only new allocation
+    else { inst.cpu->load_translated_rom(game->rom, game->size_rom); } // done by get_cpu for new cpu
+
+    // same state as a new cpu (init() does not reset what get_cpu / frontend set)
+    SM5XX* cpu = inst.cpu;
+    cpu->init();
+    cpu->load_rom(game->rom, game->size_rom);
+    cpu->load_rom_melody(game->melody, game->size_melody);
+    cpu->load_rom_time_addresses(game->ref);
+    cpu->time_set(false);
+    cpu->segments_state_are_update = false;
+
+    inst.input = get_input_config(cpu, game->ref);
+    cpu->set_input_multiplexage(inst.input == nullptr || inst.input->use_multiplexage);
+
+    inst.game = game;
+    inst.cpu_type = cpu_type;
+    inst.curr_rate = 0;
+    inst.nb_frame = 0;
+    inst.nb_opcode = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Run /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Emulator_Pool::run_instance(Pool_Instance& inst, uint32_t nb_frame){
+    Cycle_Events cycle_events;
+    for(uint32_t frame = 0; frame < nb_frame; frame++){
+        uint32_t step = cycles_of_frame(inst.cpu->frequency, inst.curr_rate);
+        while(step > 0){
+            step -= inst.cpu->run_cycles(step, cycle_events);
+            inst.nb_opcode += cycle_events.nb_opcode;
+        }
+        inst.nb_frame++;
+        if(frame_callback){ frame_callback(inst); }
+    }
+}
+
+
+void Emulator_Pool::run_slice(uint32_t nb_frame){
+    if(nb_active == 0 || nb_frame == 0){ return; }
+
+    {
+        // before tasks : a worker still in previous slice can already take one
+        std::lock_guard<std::mutex> lock(mutex);
+        slice_nb_frame = nb_frame;
+        slice_remaining = nb_active;
+    }
+
+    size_t num_queue = 0;
+    for(auto& inst : instances){
+        if(!inst->active){ continue; }
+        Worker_Queue& queue = *queues[num_queue];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.ids.push_back(inst->id);
+        }
+        num_queue = (num_queue + 1) % queues.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slice_generation++;
+    }
+    start_cv.notify_all();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [this]{ return slice_remaining.load() == 0; });
+}
+
+
+bool Emulator_Pool::pop_task(size_t num_worker, int& id){
+    { // own queue first (last pushed)
+        Worker_Queue& queue = *queues[num_worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.ids.empty()){
+            id = queue.ids.back();
+            queue.ids.pop_back();
+            return true;
+        }
+    }
+
+    // steal oldest task of other workers (slow games do not stop the slice)
+    for(size_t i = 1; i < queues.size(); i++){
+        Worker_Queue& queue = *queues[(num_worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.ids.empty()){
+            id = queue.ids.front();
+            queue.ids.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void Emulator_Pool::worker_loop(size_t num_worker){
+    uint64_t generation_done = 0;
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_cv.wait(lock, [&]{ return quit || slice_generation != generation_done; });
+            if(quit){ return; }
+            generation_done = slice_generation;
+        }
+
+        int id;
+        while(pop_task(num_worker, id)){
+            run_instance(*instances[id], slice_nb_frame);
+            if(slice_remaining.fetch_sub(1) == 1){
+                std::lock_guard<std::mutex> lock(mutex);
+                done_cv.notify_one();
+            }
+        }
+    }
+}
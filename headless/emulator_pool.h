@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "std/GW_ROM.h"
+#include "SM5XX/SM5XX.h"
+
+class Virtual_Input;
+
+// Many independent games emulated at once (regression sweep, bot training).
+// All instances advance by slices of emulated time (nb frames of 1/60 s), in parallel on a work stealing thread pool.
+// An instance removed keeps its cpu : next instance with same cpu type reuse it (no new allocation).
+//
+// Functions of the pool are called from one thread only (owner of the pool).
+// frame callback is called by worker threads : only touch the instance given.
+
+struct Pool_Instance {
+    int id = -1;
+    bool active = false;
+    const GW_rom* game = nullptr;
+    SM5XX* cpu = nullptr;
+    Virtual_Input* input = nullptr; // nullptr if no input config for game
+    uint8_t cpu_type;
+    uint32_t curr_rate = 0; // rest of cycles per frame (cycles_of_frame)
+    uint64_t nb_frame = 0; // frames emulated since add / reset
+    uint64_t nb_opcode = 0;
+};
+
+class Emulator_Pool {
+public :
+    // called after each frame of each instance (hash, input of next frame, ...)
+    using Frame_Callback = std::function<void(Pool_Instance&)>;
+
+    explicit Emulator_Pool(unsigned nb_thread = 0); // 0 -> nb cores of host
+    ~Emulator_Pool();
+
+    int add_instance(const GW_rom* game); // id, -1 if rom not supported
+    bool reset_instance(int id, const GW_rom* game); // new game (or restart) in same instance
+    void restart_instance(int id, const void* state = nullptr); // same game from state (snapshot of cpu) or from init, no allocation
+    void remove_instance(int id);
+
+    Pool_Instance& instance(int id){ return *instances[id]; }
+    size_t nb_instance() const { return nb_active; }
+    unsigned nb_thread() const { return unsigned(workers.size()); }
+    void set_frame_callback(Frame_Callback callback){ frame_callback = std::move(callback); }
+
+    void run_slice(uint32_t nb_frame = 1); // all instances, return when all are done
+
+private :
+    struct Worker_Queue {
+        std::mutex mutex;
+        std::deque<int> ids;
+    };
+
+    std::vector<std::unique_ptr<Pool_Instance>> instances; // address stable (given to callback)
+    std::vector<int> free_ids;
+    std::vector<SM5XX*> free_cpu[3]; // by cpu type, cpu of removed instances
+    size_t nb_active = 0;
+    Frame_Callback frame_callback;
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Worker_Queue>> queues; // 1 by worker
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    uint64_t slice_generation = 0;
+    uint32_t slice_nb_frame = 0;
+    std::atomic<size_t> slice_remaining{0};
+    bool quit = false;
+
+    void load_game(Pool_Instance& inst, const GW_rom* game);
+    void run_instance(Pool_Instance& inst, uint32_t nb_frame);
+    bool pop_task(size_t num_worker, int& id);
+    void worker_loop(size_t num_worker);
+};
@@ -0,0 +1,56 @@
+#include "headless_game.h"
+
+#include <cstdlib>
+
+#include "std/gw_pack.h"
+#include "SM5XX/get_cpu.h"
+
+
+const GW_rom* find_game(const std::string& ref_or_index){
+    if(gw_pack::game_count() == 0){ return nullptr; }
+    if(ref_or_index.empty()){ return gw_pack::game_at(0); }
+    for(size_t i = 0; i < gw_pack::game_count(); i++){
+        if(gw_pack::game_at(i)->ref == ref_or_index){ return gw_pack::game_at(i); }
+    }
+    char* end = nullptr;
+    unsigned long index = strtoul(ref_or_index.c_str(), &end, 10);
+    if(end != ref_or_index.c_str() && *end == '\0' && index < gw_pack::game_count()){ return gw_pack::game_at(index); }
+    return nullptr;
+}
+
+
+SM5XX* load_game_cpu(const GW_rom* game){
+    SM5XX* cpu = nullptr;
+    if(!get_cpu(cpu, game->rom, uint16_t(game->size_rom))){ return nullptr; }
+    cpu->init();
+    cpu->load_rom(game->rom, game->size_rom);
+    cpu->load_rom_melody(game->melody, game->size_melody);
+    cpu->load_rom_time_addresses(game->ref);
+    return cpu;
+}
+
+
+uint64_t hash_segments(SM5XX* cpu, const GW_rom* game){
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for(size_t i = 0; i < game->size_segment; i++){
+        const Segment& seg = game->segment[i];
+        hash ^= segment_bit_value(cpu->segment_bits, seg.bit) ? 1 : 0;
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+
+bool load_pack_texture(const std::string& path, Image_RGBA& out, std::string* error_out){
+    // pack store files by basename (same as loadTexture_file of 3DS), png for Android / RGDS packs
+    std::string base = path.substr(path.find_last_of('/') + 1);
+    if(base.size() >= 4 && base.compare(base.size() - 4, 4, ".t3x") == 0){ base.replace(base.size() - 4, 4, ".png"); }
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if(base.empty() || !gw_pack::get_file_bytes(base, data, size) || size == 0){
+        if(error_out){ *error_out = "'" + base + "' not in pack (3DS pack has only .t3x)"; }
+        return false;
+    }
+    return png_decode(data, size, out, error_out);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "std/GW_ROM.h"
+#include "std/png_image.h"
+#include "SM5XX/SM5XX.h"
+
+// Common part of host tools (yokoi_headless, yokoi_bench) : game of pack -> cpu ready to run
+
+const uint32_t FPS_HEADLESS = 60; // same as frontends -> 1 frame = 1/60 s
+
+// game of loaded pack by ref or index, nullptr if not found
+const GW_rom* find_game(const std::string& ref_or_index);
+
+// same init as frontends (get_cpu + roms), nullptr if rom not supported
+SM5XX* load_game_cpu(const GW_rom* game);
+
+// FNV-1a 64 of state of all segments of the game (same order as pack)
+uint64_t hash_segments(SM5XX* cpu, const GW_rom* game);
+
+// texture of game from pack (path of GW_rom, .t3x -> .png as Android), false + message in error_out if not found
+bool load_pack_texture(const std::string& path, Image_RGBA& out, std::string* error_out = nullptr);
+
+// nb cycles of next frame : keep rest of division -> exact frequency on long run (same as 3DS main.cpp)
+inline uint32_t cycles_of_frame(uint32_t frequency, uint32_t& curr_rate){
+    curr_rate += frequency;
+    uint32_t step = curr_rate / FPS_HEADLESS;
+    curr_rate -= step * FPS_HEADLESS;
+    return step;
+}
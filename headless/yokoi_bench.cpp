@@ -0,0 +1,547 @@
+// Benchmark of cpu cores : all games of a rom pack, throughput of step() and run_cycles.
+// Each game : warm-up, then timed window of emulated time (best of N repeats -> stable between runs),
+// in attract mode (no input) and with canned input (same presses for each run).
+//
+// Result by game and by cpu family : cycles/s, instructions/s, ns/instruction -> stdout, CSV and/or JSON.
+// Compare CSV of 2 commits to find slowdown of step() / instruction files before release.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <memory>
+
+#include "std/gw_pack.h"
+#include "std/timer.h"
+#include "SM5XX/SM5XX.h"
+#include "SM5XX/get_cpu.h"
+#include "virtual_i_o/virtual_input.h"
+#include "headless_game.h"
+#include "emulator_pool.h"
+#include "yokoi_env.h"
+#include "SM5XX/SM5A/SM5A_lockstep.h"
+#include "SM5XX/SM510/SM510_lockstep.h"
+
+
+const uint32_t CANNED_INPUT_START = 30; // frame of Game A press
+const uint32_t CANNED_INPUT_PERIOD = 20; // 1 press of game button each 20 frames
+const uint32_t CANNED_INPUT_HOLD = 6; // frames before release
+const uint32_t LOCKSTEP_INPUT_SHIFT = 3; // canned input of lane n : n * shift frames late -> lanes diverge
+
+
+struct Options {
+    std::string pack_path;
+    std::vector<std::string> games; // empty -> all games of pack
+    std::string csv_path;
+    std::string json_path;
+    double warmup = 2.0;
+    double seconds = 10.0;
+    int repeat = 3;
+    bool path_run = true;
+    bool path_step = true;
+    bool mode_attract = true;
+    bool mode_input = true;
+    int pool = 0; // > 0 -> nb instances run together in Emulator_Pool (throughput of all host)
+    int threads = 0; // of pool, 0 -> nb cores
+    int env = 0; // > 0 -> steps/s of yokoi_env with env instances of each game (random actions)
+    bool lockstep = false; // SM5A/SM510 : 16 lanes of same game in lockstep vs 16 run_cycles
+};
+
+struct Bench_Result {
+    std::string game; // ref of game, "*" for total of family
+    std::string cpu;
+    std::string mode; // attract / input
+    std::string path; // run_cycles / step
+    double emulated_seconds = 0;
+    uint64_t host_ns = 0;
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+
+    double cycles_per_s() const { return host_ns ? cycles * 1e9 / host_ns : 0; }
+    double instructions_per_s() const { return host_ns ? instructions * 1e9 / host_ns : 0; }
+    double ns_per_instruction() const { return instructions ? double(host_ns) / instructions : 0; }
+};
+
+
+static void print_usage(){
+    printf("usage: yokoi_bench <pack.ykp> [options]\n");
+    printf("  --game <ref|index>      game to bench, can be repeated (default all games of pack)\n");
+    printf("  --warmup <s>            emulated time before timed window (default 2)\n");
+    printf("  --seconds <s>           emulated time of timed window (default 10)\n");
+    printf("  --repeat <n>            best of n timed windows (default 3)\n");
+    printf("  --path <run|step|both>  run_cycles and/or step() (default both)\n");
+    printf("  --mode <attract|input|both>  no input and/or canned input (default both)\n");
+    printf("  --csv <file>            write results as CSV\n");
+    printf("  --json <file>           write results as JSON\n");
+    printf("  --pool <n>              run n instances together (games in turn) on thread pool, attract mode\n");
+    printf("  --threads <n>           threads of pool (default nb cores)\n");
+    printf("  --env <n>               steps/s of yokoi_env (C API) with n instances of each game, random actions\n");
+    printf("  --lockstep              SM5A/SM510 : 16 instances of game in lockstep, input shifted by instance\n");
+}
+
+static bool parse_options(int argc, char** argv, Options& opt){
+    for(int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if(arg == "--game" && has_value){ opt.games.push_back(argv[++i]); }
+        else if(arg == "--warmup" && has_value){ opt.warmup = atof(argv[++i]); }
+        else if(arg == "--seconds" && has_value){ opt.seconds = atof(argv[++i]); }
+        else if(arg == "--repeat" && has_value){ opt.repeat = atoi(argv[++i]); }
+        else if(arg == "--csv" && has_value){ opt.csv_path = argv[++i]; }
+        else if(arg == "--json" && has_value){ opt.json_path = argv[++i]; }
+        else if(arg == "--pool" && has_value){ opt.pool = atoi(argv[++i]); }
+        else if(arg == "--threads" && has_value){ opt.threads = atoi(argv[++i]); }
+        else if(arg == "--env" && has_value){ opt.env = atoi(argv[++i]); }
+        else if(arg == "--lockstep"){ opt.lockstep = true; }
+        else if(arg == "--path" && has_value){
+            std::string value = argv[++i];
+            opt.path_run = (value == "run" || value == "both");
+            opt.path_step = (value == "step" || value == "both");
+            if(!opt.path_run && !opt.path_step){ return false; }
+        }
+        else if(arg == "--mode" && has_value){
+            std::string value = argv[++i];
+            opt.mode_attract = (value == "attract" || value == "both");
+            opt.mode_input = (value == "input" || value == "both");
+            if(!opt.mode_attract && !opt.mode_input){ return false; }
+        }
+        else if(arg[0] != '-' && opt.pack_path.empty()){ opt.pack_path = arg; }
+        else { return false; }
+    }
+    return !opt.pack_path.empty() && opt.seconds > 0 && opt.warmup >= 0 && opt.repeat > 0 && opt.pool >= 0 && opt.threads >= 0 && opt.env >= 0;
+}
+
+
+// canned input : Game A to start, then press each button of game in turn (same for every run)
+static void canned_input(Virtual_Input* v_input, uint32_t frame){
+    if(v_input == nullptr || frame < CANNED_INPUT_START){ return; }
+    uint32_t t = frame - CANNED_INPUT_START;
+    if(t % CANNED_INPUT_PERIOD != 0 && t % CANNED_INPUT_PERIOD != CANNED_INPUT_HOLD){ return; }
+    bool state = (t % CANNED_INPUT_PERIOD == 0);
+    uint32_t num_press = t / CANNED_INPUT_PERIOD;
+
+    if(num_press == 0){ v_input->set_input(PART_SETUP, BUTTON_GAMEA, state); return; }
+
+    uint8_t part = (num_press % 2) ? PART_LEFT : PART_RIGHT;
+    uint8_t configuration = (part == PART_LEFT) ? v_input->left_configuration : v_input->right_configuration;
+    uint8_t button = BUTTON_NOTHING;
+    switch(configuration){
+        case CONF_1_BUTTON_ACTION: button = BUTTON_ACTION; break;
+        case CONF_2_BUTTON_UPDOWN: button = ((num_press / 2) % 2) ? BUTTON_DOWN : BUTTON_UP; break;
+        case CONF_2_BUTTON_LEFTRIGHT: button = ((num_press / 2) % 2) ? BUTTON_RIGHT : BUTTON_LEFT; break;
+        case CONF_4_BUTTON_DIRECTION: {
+            static const uint8_t directions[4] = { BUTTON_LEFT, BUTTON_UP, BUTTON_RIGHT, BUTTON_DOWN };
+            button = directions[(num_press / 2) % 4];
+            break;
+        }
+        default: return;
+    }
+    v_input->set_input(part, button, state);
+}
+
+
+// emulate nb_frame frames, return nb instructions executed
+static uint64_t run_frames(SM5XX* cpu, Virtual_Input* v_input, bool use_input, bool use_step,
+                            uint32_t first_frame, uint32_t nb_frame, uint32_t& curr_rate){
+    uint64_t nb_instruction = 0;
+    Cycle_Events cycle_events;
+    for(uint32_t frame = first_frame; frame < first_frame + nb_frame; frame++){
+        if(use_input){ canned_input(v_input, frame); }
+        uint32_t step = cycles_of_frame(cpu->frequency, curr_rate);
+        if(use_step){
+            for(; step > 0; step--){ nb_instruction += cpu->step() ? 1 : 0; }
+            continue;
+        }
+        while(step > 0){
+            step -= cpu->run_cycles(step, cycle_events);
+            nb_instruction += cycle_events.nb_opcode;
+        }
+    }
+    return nb_instruction;
+}
+
+
+static void bench_game(const GW_rom* game, const Options& opt, bool use_input, bool use_step, Bench_Result& result){
+    uint32_t nb_frame_warmup = uint32_t(opt.warmup * FPS_HEADLESS + 0.5);
+    uint32_t nb_frame = uint32_t(opt.seconds * FPS_HEADLESS + 0.5);
+
+    result.game = game->ref;
+    result.mode = use_input ? "input" : "attract";
+    result.path = use_step ? "step" : "run_cycles";
+    result.emulated_seconds = double(nb_frame) / FPS_HEADLESS;
+    result.host_ns = UINT64_MAX;
+
+    // new cpu for each repeat -> exactly same work, keep best time (less noise of host)
+    for(int r = 0; r < opt.repeat; r++){
+        SM5XX* cpu = load_game_cpu(game);
+        Virtual_Input* v_input = get_input_config(cpu, game->ref);
+        if(v_input != nullptr){ cpu->set_input_multiplexage(v_input->use_multiplexage); }
+        result.cpu = cpu->name_cpu;
+
+        uint32_t curr_rate = 0;
+        run_frames(cpu, v_input, use_input, use_step, 0, nb_frame_warmup, curr_rate);
+
+        uint64_t cycle_start = cpu->cycle_count;
+        uint64_t time_start = time_us_64_p();
+        uint64_t nb_instruction = run_frames(cpu, v_input, use_input, use_step, nb_frame_warmup, nb_frame, curr_rate);
+        uint64_t time_ns = (time_us_64_p() - time_start) * 1000;
+        if(time_ns == 0){ time_ns = 1000; } // timer resolution
+
+        if(time_ns < result.host_ns){ result.host_ns = time_ns; }
+        result.cycles = cpu->cycle_count - cycle_start;
+        result.instructions = nb_instruction;
+
+        delete v_input;
+        delete cpu;
+    }
+}
+
+
+// all instances in 1 pool, slices of 1 s : throughput of whole host + check instances are independent
+// (all instances of a game must end with same segments and same cycles)
+static bool bench_pool(const std::vector<const GW_rom*>& games, const Options& opt, Bench_Result& result){
+    Emulator_Pool pool(unsigned(opt.threads));
+    for(int i = 0; i < opt.pool; i++){ pool.add_instance(games[i % games.size()]); }
+
+    uint32_t nb_frame_warmup = uint32_t(opt.warmup * FPS_HEADLESS + 0.5);
+    uint32_t nb_frame = uint32_t(opt.seconds * FPS_HEADLESS + 0.5);
+
+    result.game = "pool";
+    result.cpu = "*";
+    result.mode = "attract";
+    result.path = "pool_x" + std::to_string(opt.pool) + "_t" + std::to_string(pool.nb_thread());
+    result.emulated_seconds = double(nb_frame) / FPS_HEADLESS;
+    result.host_ns = UINT64_MAX;
+
+    for(int r = 0; r < opt.repeat; r++){
+        for(int i = 0; i < opt.pool; i++){ pool.reset_instance(i, games[i % games.size()]); } // cpu reused
+
+        pool.run_slice(nb_frame_warmup);
+        uint64_t cycle_start = 0, opcode_start = 0;
+        for(int i = 0; i < opt.pool; i++){
+            cycle_start += pool.instance(i).cpu->cycle_count;
+            opcode_start += pool.instance(i).nb_opcode;
+        }
+
+        uint64_t time_start = time_us_64_p();
+        for(uint32_t frame = 0; frame < nb_frame; frame += FPS_HEADLESS){
+            pool.run_slice(std::min<uint32_t>(FPS_HEADLESS, nb_frame - frame));
+        }
+        uint64_t time_ns = (time_us_64_p() - time_start) * 1000;
+        if(time_ns == 0){ time_ns = 1000; } // timer resolution
+
+        if(time_ns < result.host_ns){ result.host_ns = time_ns; }
+        result.cycles = 0;
+        result.instructions = 0;
+        for(int i = 0; i < opt.pool; i++){
+            result.cycles += pool.instance(i).cpu->cycle_count;
+            result.instructions += pool.instance(i).nb_opcode;
+        }
+        result.cycles -= cycle_start;
+        result.instructions -= opcode_start;
+    }
+
+    // instance i and i + nb games : same game
+    bool identical = true;
+    for(int i = int(games.size()); i < opt.pool; i++){
+        Pool_Instance& a = pool.instance(i);
+        Pool_Instance& b = pool.instance(i - int(games.size()));
+        identical = identical && (a.cpu->cycle_count == b.cpu->cycle_count)
+                    && (hash_segments(a.cpu, a.game) == hash_segments(b.cpu, b.game));
+    }
+    return identical;
+}
+
+
+// 16 instances of a game, canned input shifted by instance : lanes of SM5XX_Lockstep vs 16 cpu with run_cycles.
+// cpu of each instance keep its Virtual_Input -> input copied to lane each frame.
+// Check : each lane end in same state as its cpu (cycles and segments)
+template <class Lockstep, class CPU>
+static bool bench_lockstep_game(const GW_rom* game, const Options& opt, Bench_Result& result, Bench_Result& result_scalar){
+    uint32_t nb_frame_warmup = uint32_t(opt.warmup * FPS_HEADLESS + 0.5);
+    uint32_t nb_frame = uint32_t(opt.seconds * FPS_HEADLESS + 0.5);
+
+    SM5XX* cpu[LOCKSTEP_NB_LANE];
+    Virtual_Input* v_input[LOCKSTEP_NB_LANE];
+    std::unique_ptr<Lockstep> lockstep = std::make_unique<Lockstep>();
+
+    result.game = result_scalar.game = game->ref;
+    result.mode = result_scalar.mode = "input";
+    result.path = "lockstep_x" + std::to_string(LOCKSTEP_NB_LANE);
+    result_scalar.path = "run_cycles_x" + std::to_string(LOCKSTEP_NB_LANE);
+    result.emulated_seconds = result_scalar.emulated_seconds = double(nb_frame) / FPS_HEADLESS;
+    result.host_ns = result_scalar.host_ns = UINT64_MAX;
+
+    bool identical = true;
+    for(int r = 0; r < opt.repeat; r++){
+        for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){
+            cpu[lane] = load_game_cpu(game);
+            v_input[lane] = get_input_config(cpu[lane], game->ref);
+            if(v_input[lane] != nullptr){ cpu[lane]->set_input_multiplexage(v_input[lane]->use_multiplexage); }
+        }
+        result.cpu = result_scalar.cpu = cpu[0]->name_cpu;
+        lockstep->load(*static_cast<CPU*>(cpu[0]));
+
+        // lockstep : cpu only hold input
+        uint32_t curr_rate = 0;
+        uint64_t cycle_start = 0, opcode_start = 0, time_start = 0;
+        for(uint32_t frame = 0; frame < nb_frame_warmup + nb_frame; frame++){
+            if(frame == nb_frame_warmup){
+                for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){ cycle_start += lockstep->get_cycle_count(lane); }
+                opcode_start = lockstep->debug_nb_lane_opcode + lockstep->debug_nb_scalar_opcode;
+                time_start = time_us_64_p();
+            }
+            for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){
+                if(frame >= lane * LOCKSTEP_INPUT_SHIFT){ canned_input(v_input[lane], frame - lane * LOCKSTEP_INPUT_SHIFT); }
+                lockstep->copy_input(lane, *static_cast<CPU*>(cpu[lane]));
+            }
+            lockstep->run_frame(cycles_of_frame(cpu[0]->frequency, curr_rate));
+        }
+        uint64_t time_ns = (time_us_64_p() - time_start) * 1000;
+        if(time_ns == 0){ time_ns = 1000; } // timer resolution
+        if(time_ns < result.host_ns){ result.host_ns = time_ns; }
+        result.cycles = 0;
+        for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){ result.cycles += lockstep->get_cycle_count(lane); }
+        result.cycles -= cycle_start;
+        result.instructions = lockstep->debug_nb_lane_opcode + lockstep->debug_nb_scalar_opcode - opcode_start;
+
+        // same work with run_cycles (new cpu -> same input from frame 0)
+        for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){
+            delete v_input[lane];
+            delete cpu[lane];
+            cpu[lane] = load_game_cpu(game);
+            v_input[lane] = get_input_config(cpu[lane], game->ref);
+            if(v_input[lane] != nullptr){ cpu[lane]->set_input_multiplexage(v_input[lane]->use_multiplexage); }
+        }
+        curr_rate = 0;
+        cycle_start = 0;
+        uint64_t nb_instruction = 0;
+        Cycle_Events cycle_events;
+        for(uint32_t frame = 0; frame < nb_frame_warmup + nb_frame; frame++){
+            if(frame == nb_frame_warmup){
+                for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){ cycle_start += cpu[lane]->cycle_count; }
+                time_start = time_us_64_p();
+            }
+            uint32_t step = cycles_of_frame(cpu[0]->frequency, curr_rate);
+            for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){
+                if(frame >= lane * LOCKSTEP_INPUT_SHIFT){ canned_input(v_input[lane], frame - lane * LOCKSTEP_INPUT_SHIFT); }
+                for(uint32_t remain = step; remain > 0; ){
+                    remain -= cpu[lane]->run_cycles(remain, cycle_events);
+                    if(frame >= nb_frame_warmup){ nb_instruction += cycle_events.nb_opcode; }
+                }
+            }
+        }
+        time_ns = (time_us_64_p() - time_start) * 1000;
+        if(time_ns == 0){ time_ns = 1000; }
+        if(time_ns < result_scalar.host_ns){ result_scalar.host_ns = time_ns; }
+        result_scalar.cycles = 0;
+        for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){ result_scalar.cycles += cpu[lane]->cycle_count; }
+        result_scalar.cycles -= cycle_start;
+        result_scalar.instructions = nb_instruction;
+
+        CPU lane_cpu(*static_cast<CPU*>(cpu[0]));
+        for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){
+            lockstep->store_lane(lane, lane_cpu);
+            identical = identical && (lane_cpu.cycle_count == cpu[lane]->cycle_count)
+                        && (hash_segments(&lane_cpu, game) == hash_segments(cpu[lane], game));
+            delete v_input[lane];
+            delete cpu[lane];
+        }
+    }
+    printf("# %s\n", lockstep->debug_lockstep().c_str());
+    return identical;
+}
+
+
+// yokoi_env as used by a trainer : 1 step = 1 frame of all instances + observations + rewards.
+// random actions in buttons of game, changed each 8 steps. Output -> steps/s (all instances), 0 if game not supported
+static double bench_env(const GW_rom* game, const Options& opt){
+    uint32_t nb_step = uint32_t(opt.seconds * FPS_HEADLESS + 0.5);
+    double best = 0;
+    for(int r = 0; r < opt.repeat; r++){
+        Yokoi_Env* env = yokoi_env_create(nullptr, game->ref.c_str(), opt.env, opt.threads); // pack already loaded
+        if(env == nullptr){ return 0; }
+        std::vector<uint32_t> actions(opt.env, 0);
+        std::vector<uint8_t> obs(size_t(opt.env) * yokoi_env_obs_size(env));
+        std::vector<float> rewards(opt.env);
+        uint32_t valid = yokoi_env_valid_actions(env);
+        uint32_t random = 0x12345678;
+
+        uint64_t time_start = time_us_64_p();
+        for(uint32_t step = 0; step < nb_step; step++){
+            if(step % 8 == 0){
+                for(uint32_t& action : actions){
+                    random = random * 1664525 + 1013904223;
+                    action = (random >> 8) & valid;
+                }
+            }
+            yokoi_env_step(env, actions.data(), obs.data(), rewards.data());
+        }
+        uint64_t time_ns = (time_us_64_p() - time_start) * 1000;
+        if(time_ns == 0){ time_ns = 1000; } // timer resolution
+        best = std::max(best, double(nb_step) * opt.env * 1e9 / time_ns);
+        yokoi_env_destroy(env);
+    }
+    return best;
+}
+
+
+static void print_result(const Bench_Result& result){
+    printf("%-10s %-12s %-8s %-10s %12.0f cycles/s %12.0f inst/s %8.2f ns/inst\n", result.game.c_str(), result.cpu.c_str(),
+            result.mode.c_str(), result.path.c_str(), result.cycles_per_s(), result.instructions_per_s(), result.ns_per_instruction());
+}
+
+static bool write_csv(const std::string& path, const std::vector<Bench_Result>& results){
+    FILE* file = fopen(path.c_str(), "w");
+    if(file == nullptr){ return false; }
+    fprintf(file, "game,cpu,mode,path,emulated_s,host_ns,cycles,instructions,cycles_per_s,instructions_per_s,ns_per_instruction\n");
+    for(const Bench_Result& r : results){
+        fprintf(file, "%s,%s,%s,%s,%.3f,%llu,%llu,%llu,%.0f,%.0f,%.3f\n", r.game.c_str(), r.cpu.c_str(), r.mode.c_str(), r.path.c_str(),
+                r.emulated_seconds, (unsigned long long)r.host_ns, (unsigned long long)r.cycles, (unsigned long long)r.instructions,
+                r.cycles_per_s(), r.instructions_per_s(), r.ns_per_instruction());
+    }
+    fclose(file);
+    return true;
+}
+
+static bool write_json(const std::string& path, const Options& opt, const std::vector<Bench_Result>& results){
+    FILE* file = fopen(path.c_str(), "w");
+    if(file == nullptr){ return false; }
+    fprintf(file, "{\n  \"warmup_s\": %.3f,\n  \"seconds\": %.3f,\n  \"repeat\": %d,\n  \"results\": [\n", opt.warmup, opt.seconds, opt.repeat);
+    for(size_t i = 0; i < results.size(); i++){
+        const Bench_Result& r = results[i];
+        fprintf(file, "    {\"game\": \"%s\", \"cpu\": \"%s\", \"mode\": \"%s\", \"path\": \"%s\", \"emulated_s\": %.3f, \"host_ns\": %llu, "
+                "\"cycles\": %llu, \"instructions\": %llu, \"cycles_per_s\": %.0f, \"instructions_per_s\": %.0f, \"ns_per_instruction\": %.3f}%s\n",
+                r.game.c_str(), r.cpu.c_str(), r.mode.c_str(), r.path.c_str(), r.emulated_seconds, (unsigned long long)r.host_ns,
+                (unsigned long long)r.cycles, (unsigned long long)r.instructions, r.cycles_per_s(), r.instructions_per_s(),
+                r.ns_per_instruction(), (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+
+int main(int argc, char** argv){
+    Options opt;
+    if(!parse_options(argc, argv, opt)){ print_usage(); return 2; }
+
+    std::string error;
+    if(!gw_pack::load(opt.pack_path, &error)){
+        fprintf(stderr, "error: can not load pack '%s' : %s\n", opt.pack_path.c_str(), error.c_str());
+        return 1;
+    }
+
+    std::vector<const GW_rom*> games;
+    if(opt.games.empty()){
+        for(size_t i = 0; i < gw_pack::game_count(); i++){ games.push_back(gw_pack::game_at(i)); }
+    }
+    for(const std::string& ref : opt.games){
+        const GW_rom* game = find_game(ref);
+        if(game == nullptr){ fprintf(stderr, "error: game '%s' not in pack\n", ref.c_str()); return 1; }
+        games.push_back(game);
+    }
+
+    std::vector<Bench_Result> results;
+    std::map<std::string, Bench_Result> families; // key : cpu/mode/path
+
+    if(opt.pool > 0){ // only supported games in pool
+        std::vector<const GW_rom*> pool_games;
+        for(const GW_rom* game : games){
+            SM5XX* cpu = load_game_cpu(game);
+            if(cpu == nullptr){ fprintf(stderr, "warning: rom of '%s' not supported, skipped\n", game->ref.c_str()); continue; }
+            delete cpu;
+            pool_games.push_back(game);
+        }
+        if(pool_games.empty()){ fprintf(stderr, "error: no game supported\n"); return 1; }
+        games = pool_games;
+
+        Bench_Result result;
+        bool identical = bench_pool(games, opt, result);
+        print_result(result);
+        printf("# instances of same game identical : %s\n", identical ? "yes" : "NO");
+        results.push_back(result);
+        games.clear(); // no bench by game
+    }
+
+    if(opt.env > 0){ // replace bench by game
+        for(const GW_rom* game : games){
+            double steps = bench_env(game, opt);
+            if(steps == 0){ fprintf(stderr, "warning: rom of '%s' not supported, skipped\n", game->ref.c_str()); continue; }
+            printf("%-10s env_x%d %12.0f steps/s\n", game->ref.c_str(), opt.env, steps);
+        }
+        games.clear();
+    }
+
+    if(opt.lockstep){ // only SM5A/SM510, replace bench by game
+        for(const GW_rom* game : games){
+            SM5XX* cpu = load_game_cpu(game);
+            uint8_t type = (cpu != nullptr) ? cpu->get_cpu_type_id() : CPU_TYPE_UNKNOWN;
+            delete cpu;
+            if(type != CPU_TYPE_SM5A && type != CPU_TYPE_SM510){
+                fprintf(stderr, "warning: '%s' is not SM5A/SM510, skipped\n", game->ref.c_str());
+                continue;
+            }
+
+            Bench_Result result, result_scalar;
+            bool identical = (type == CPU_TYPE_SM5A) ? bench_lockstep_game<SM5A_Lockstep, SM5A>(game, opt, result, result_scalar)
+                                                     : bench_lockstep_game<SM510_Lockstep, SM510>(game, opt, result, result_scalar);
+            print_result(result_scalar);
+            print_result(result);
+            printf("# lanes identical to run_cycles : %s\n", identical ? "yes" : "NO");
+            results.push_back(result_scalar);
+            results.push_back(result);
+        }
+        games.clear();
+    }
+
+    for(const GW_rom* game : games){
+        SM5XX* cpu = load_game_cpu(game);
+        if(cpu == nullptr){ fprintf(stderr, "warning: rom of '%s' not supported, skipped\n", game->ref.c_str()); continue; }
+        delete cpu;
+
+        for(int m = 0; m < 2; m++){
+            bool use_input = (m == 1);
+            if(use_input ? !opt.mode_input : !opt.mode_attract){ continue; }
+            for(int p = 0; p < 2; p++){
+                bool use_step = (p == 1);
+                if(use_step ? !opt.path_step : !opt.path_run){ continue; }
+
+                Bench_Result result;
+                bench_game(game, opt, use_input, use_step, result);
+                print_result(result);
+                results.push_back(result);
+
+                Bench_Result& family = families[result.cpu + "/" + result.mode + "/" + result.path];
+                family.game = "*";
+                family.cpu = result.cpu;
+                family.mode = result.mode;
+                family.path = result.path;
+                family.emulated_seconds += result.emulated_seconds;
+                family.host_ns += result.host_ns;
+                family.cycles += result.cycles;
+                family.instructions += result.instructions;
+            }
+        }
+    }
+
+    if(!families.empty()){ printf("# by cpu family\n"); }
+    for(const auto& family : families){
+        print_result(family.second);
+        results.push_back(family.second);
+    }
+
+    if(!opt.csv_path.empty() && !write_csv(opt.csv_path, results)){
+        fprintf(stderr, "error: can not write '%s'\n", opt.csv_path.c_str());
+        return 1;
+    }
+    if(!opt.json_path.empty() && !write_json(opt.json_path, opt, results)){
+        fprintf(stderr, "error: can not write '%s'\n", opt.json_path.c_str());
+        return 1;
+    }
+
+    gw_pack::unload();
+    return 0;
+}
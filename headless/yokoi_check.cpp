@@ -0,0 +1,231 @@
+// Self check of cpu cores, without rom pack (ctest) -> see BUILDING.md
+// Random roms of each cpu (SM5A, SM510, SM511/SM512) with random input, run with step() cycle per cycle (reference)
+// and with run_cycles (block cache, fused pairs, busy loop skip, rom translated in C++ if linked)
+// -> same state of cpu (snapshot), same segments and same sound at end of each frame.
+//
+// Roms translated : --write-roms <folder> write the roms of the check, then CONVERT_ROM/utils/translate_rom_to_cpp.py
+// on each file -> yokoi_check_translated (CMake does it if python is found).
+//
+// Output : one line per rom, "# fail <n>" at end. Exit code 1 if a check fail.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "SM5XX/SM5XX.h"
+#include "SM5XX/get_cpu.h"
+#include "headless_game.h"
+
+
+const uint32_t CHECK_FREQUENCY = 32768;
+const size_t ROM_SIZE_SM5A = 1856;
+const size_t ROM_SIZE_SM510 = 4096;
+const size_t MELODY_SIZE = 256;
+
+
+struct Options {
+    uint32_t nb_seed = 4; // roms by cpu
+    uint32_t nb_frame = 600;
+    std::string write_roms; // folder -> roms written, no check
+    bool require_translated = false; // fail if a rom has no translation linked
+};
+
+struct Check_Rom {
+    std::string name; // also ref of rom translated (name of file)
+    std::vector<uint8_t> rom;
+    std::vector<uint8_t> melody;
+};
+
+
+static uint32_t rng_state;
+static uint32_t rnd(){ rng_state ^= rng_state << 13; rng_state ^= rng_state >> 17; rng_state ^= rng_state << 5; return rng_state; }
+
+
+static void print_usage(){
+    printf("usage: yokoi_check [options]\n");
+    printf("  --seeds <n>            random roms by cpu (default 4)\n");
+    printf("  --frames <n>           frames by rom (default 600)\n");
+    printf("  --write-roms <folder>  write roms of the check (input of translate_rom_to_cpp.py) and exit\n");
+    printf("  --require-translated   fail if a rom is not translated in C++\n");
+}
+
+static bool parse_options(int argc, char** argv, Options& opt){
+    for(int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if(arg == "--require-translated"){ opt.require_translated = true; }
+        else if(arg == "--seeds" && has_value){ opt.nb_seed = uint32_t(atoi(argv[++i])); }
+        else if(arg == "--frames" && has_value){ opt.nb_frame = uint32_t(atoi(argv[++i])); }
+        else if(arg == "--write-roms" && has_value){ opt.write_roms = argv[++i]; }
+        else { return false; }
+    }
+    return opt.nb_seed > 0;
+}
+
+
+// rom of a cpu for a seed : random opcodes, more jumps / calls / returns / sleep with seed (density = seed % 4)
+static Check_Rom make_rom(uint8_t cpu_type, uint32_t seed){
+    static const char* names[] = { "sm5a", "sm510", "sm511" };
+    Check_Rom check;
+    check.name = std::string("check_") + names[cpu_type] + "_" + std::to_string(seed);
+    rng_state = seed * 7919 + cpu_type * 104729 + 1;
+    uint32_t density = seed % 4;
+
+    check.rom.resize(cpu_type == CPU_TYPE_SM5A ? ROM_SIZE_SM5A : ROM_SIZE_SM510);
+    for(uint8_t& op : check.rom){
+        op = uint8_t(rnd());
+        if(density > 0 && (rnd() % 4) == 0){ op = 0x80 | (rnd() & 0x3F); } // jumps on same line -> loops
+        if(density > 1 && (rnd() % 5) == 0){
+            static const uint8_t calls[] = { 0x58, 0x68, 0x69, 0x5D, 0x6A, 0x5E, 0x5A };
+            op = calls[rnd() % 7];
+        }
+    }
+    if(density > 2){ // many sleep
+        for(size_t i = 0; i + 1 < check.rom.size(); i++){
+            if((rnd() % 12) != 0){ continue; }
+            if(cpu_type == CPU_TYPE_SM5A){ check.rom[i] = 0x5E; check.rom[i + 1] = 0x00; i++; }
+            else { check.rom[i] = 0x5D; }
+        }
+    }
+    if(cpu_type == CPU_TYPE_SM510){ // no jump on line out of rom
+        for(uint8_t& op : check.rom){ if((op & 0xF0) == 0x70 && (op & 0x0F) >= 11 && op < 0x7C){ op = 0x70 | (op % 11); } }
+    }
+    // jump on word 63 : program counter stay on it (next_word[63] == 63) and read word 0 of next line
+    // -> lax there skip itself forever (true rom never jump on word 63)
+    for(size_t i = 0; i < check.rom.size(); i += 64){ if((check.rom[i] & 0xF0) == 0x20){ check.rom[i] = 0x00; } }
+    // get_cpu_type : SM511/SM512 if data at 704, else SM510
+    for(int i = 0; i < 16; i++){
+        if(cpu_type == CPU_TYPE_SM510){ check.rom[704 + i] = 0x00; }
+        else if(cpu_type == CPU_TYPE_SM511_2){ check.rom[704 + i] |= 0x01; }
+    }
+
+    check.melody.resize(MELODY_SIZE);
+    for(uint8_t& note : check.melody){ note = uint8_t(rnd()); }
+    return check;
+}
+
+static SM5XX* load_check_cpu(const Check_Rom& check, bool& translated){
+    SM5XX* cpu = nullptr;
+    if(!get_cpu(cpu, check.rom.data(), uint16_t(check.rom.size()))){ return nullptr; }
+    cpu->init();
+    cpu->load_rom(check.rom.data(), check.rom.size());
+    cpu->load_rom_melody(check.melody.data(), check.melody.size());
+    cpu->load_rom_time_addresses(check.name);
+    translated = cpu->load_translated_rom(check.rom.data(), check.rom.size());
+    return cpu;
+}
+
+
+static uint64_t fnv(uint64_t hash, uint64_t value){ return (hash ^ value) * 0x100000001B3ULL; }
+
+// 1 frame of reference : step() cycle per cycle, sound of each cycle in hash
+static uint64_t frame_step(SM5XX* cpu, uint32_t nb_cycle){
+    uint64_t sound = 0xCBF29CE484222325ULL;
+    for(uint32_t i = 0; i < nb_cycle; i++){
+        cpu->step();
+        sound = fnv(sound, cpu->get_active_sound());
+    }
+    return sound;
+}
+
+// 1 frame with run_cycles : sound of each cycle rebuilt from edges (same as frontends)
+static uint64_t frame_run_cycles(SM5XX* cpu, uint32_t nb_cycle, Cycle_Events& events){
+    uint64_t sound = 0xCBF29CE484222325ULL;
+    while(nb_cycle > 0){
+        uint32_t nb_done = cpu->run_cycles(nb_cycle, events);
+        bool value = events.sound_start;
+        uint32_t i_edge = 0;
+        for(uint32_t i = 0; i < nb_done; i++){
+            while(i_edge < events.nb_sound_edge && events.sound_edge[i_edge] == i){ value = !value; i_edge++; }
+            sound = fnv(sound, value);
+        }
+        nb_cycle -= nb_done;
+    }
+    return sound;
+}
+
+// "" if same, else first difference
+static std::string compare_cpu(SM5XX* ref, SM5XX* cpu, uint64_t sound_ref, uint64_t sound){
+    size_t size = ref->get_state_size();
+    std::vector<uint8_t> state_ref(size), state(size);
+    ref->snapshot(state_ref.data());
+    cpu->snapshot(state.data());
+    if(ref->cycle_count != cpu->cycle_count){ return "cycle_count"; }
+    if(state_ref != state){ return "state"; }
+    if(memcmp(ref->segment_bits, cpu->segment_bits, sizeof(ref->segment_bits)) != 0){ return "segments"; }
+    if(sound_ref != sound){ return "sound"; }
+    return "";
+}
+
+
+// reference and run_cycles on same rom with same input -> false if they are not the same at end of a frame
+static bool check_run_cycles(const Check_Rom& check, uint32_t nb_frame, bool require_translated){
+    bool translated = false;
+    std::unique_ptr<SM5XX> ref(load_check_cpu(check, translated));
+    std::unique_ptr<SM5XX> cpu(load_check_cpu(check, translated));
+    if(!ref || !cpu){ printf("%s : rom not supported\n", check.name.c_str()); return false; }
+    ref->set_busy_loop_skip(false);
+    ref->set_block_cache(false);
+    ref->set_translated_rom(false);
+    if(require_translated && !translated){ printf("%s : rom not translated\n", check.name.c_str()); return false; }
+
+    Cycle_Events events;
+    uint32_t curr_rate = 0;
+    rng_state = uint32_t(check.rom.size()) + check.rom[1] * 31 + check.rom[2] + 1;
+    for(uint32_t frame = 0; frame < nb_frame; frame++){
+        if((rnd() % 8) == 0){ // same input for both, between 2 frames
+            int group = rnd() % 8, line = rnd() % 10;
+            bool state = rnd() & 0x01;
+            ref->input_set(group, line, state);
+            cpu->input_set(group, line, state);
+        }
+        uint32_t nb_cycle = CHECK_FREQUENCY / FPS_HEADLESS;
+        curr_rate += CHECK_FREQUENCY % FPS_HEADLESS;
+        if(curr_rate >= FPS_HEADLESS){ curr_rate -= FPS_HEADLESS; nb_cycle++; }
+
+        uint64_t sound_ref = frame_step(ref.get(), nb_cycle);
+        uint64_t sound = frame_run_cycles(cpu.get(), nb_cycle, events);
+        std::string diff = compare_cpu(ref.get(), cpu.get(), sound_ref, sound);
+        if(!diff.empty()){
+            printf("%s : run_cycles%s different of step() at frame %u (%s)\n", check.name.c_str(), translated ? " translated" : "", frame, diff.c_str());
+            return false;
+        }
+    }
+    printf("%s : run_cycles%s ok\n", check.name.c_str(), translated ? " translated" : "");
+    return true;
+}
+
+
+int main(int argc, char** argv){
+    Options opt;
+    if(!parse_options(argc, argv, opt)){ print_usage(); return 2; }
+
+    std::vector<Check_Rom> roms;
+    for(uint8_t cpu_type : { CPU_TYPE_SM5A, CPU_TYPE_SM510, CPU_TYPE_SM511_2 }){
+        for(uint32_t seed = 1; seed <= opt.nb_seed; seed++){ roms.push_back(make_rom(cpu_type, seed)); }
+    }
+
+    if(!opt.write_roms.empty()){
+        for(const Check_Rom& check : roms){
+            std::string path = opt.write_roms + "/" + check.name + ".bin";
+            FILE* file = fopen(path.c_str(), "wb");
+            if(file == nullptr || fwrite(check.rom.data(), 1, check.rom.size(), file) != check.rom.size()){
+                fprintf(stderr, "error: can not write '%s'\n", path.c_str());
+                if(file){ fclose(file); }
+                return 1;
+            }
+            fclose(file);
+        }
+        return 0;
+    }
+
+    int nb_fail = 0;
+    for(const Check_Rom& check : roms){
+        if(!check_run_cycles(check, opt.nb_frame, opt.require_translated)){ nb_fail++; }
+    }
+    printf("# fail %d\n", nb_fail);
+    return nb_fail == 0 ? 0 : 1;
+}
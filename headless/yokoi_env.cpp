@@ -0,0 +1,203 @@
+#include "yokoi_env.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "std/gw_pack.h"
+#include "virtual_i_o/virtual_input.h"
+#include "headless_game.h"
+#include "emulator_pool.h"
+
+
+constexpr int ENV_MAX_SCORE_DIGIT = 8;
+
+// bit of action -> button of Virtual_Input
+struct Env_Button {
+    uint32_t bit;
+    uint8_t part;
+    uint8_t button;
+};
+
+static const Env_Button ENV_BUTTONS[] = {
+    { YOKOI_ACTION_GAMEA, PART_SETUP, BUTTON_GAMEA },
+    { YOKOI_ACTION_GAMEB, PART_SETUP, BUTTON_GAMEB },
+    { YOKOI_ACTION_TIME, PART_SETUP, BUTTON_TIME },
+    { YOKOI_ACTION_ALARM, PART_SETUP, BUTTON_ALARM },
+    { YOKOI_ACTION_ACL, PART_SETUP, BUTTON_ACL },
+    { YOKOI_ACTION_LEFT_ACTION, PART_LEFT, BUTTON_ACTION },
+    { YOKOI_ACTION_LEFT_LEFT, PART_LEFT, BUTTON_LEFT },
+    { YOKOI_ACTION_LEFT_RIGHT, PART_LEFT, BUTTON_RIGHT },
+    { YOKOI_ACTION_LEFT_UP, PART_LEFT, BUTTON_UP },
+    { YOKOI_ACTION_LEFT_DOWN, PART_LEFT, BUTTON_DOWN },
+    { YOKOI_ACTION_RIGHT_ACTION, PART_RIGHT, BUTTON_ACTION },
+    { YOKOI_ACTION_RIGHT_LEFT, PART_RIGHT, BUTTON_LEFT },
+    { YOKOI_ACTION_RIGHT_RIGHT, PART_RIGHT, BUTTON_RIGHT },
+    { YOKOI_ACTION_RIGHT_UP, PART_RIGHT, BUTTON_UP },
+    { YOKOI_ACTION_RIGHT_DOWN, PART_RIGHT, BUTTON_DOWN },
+};
+
+
+struct Yokoi_Env {
+    Emulator_Pool pool;
+    const GW_rom* game = nullptr;
+    bool own_pack = false;
+    int nb_env = 0;
+    int obs_size = 0;
+
+    std::vector<uint32_t> held; // action of previous step, by instance
+    std::vector<uint32_t> score; // score of previous step, by instance
+    std::vector<uint8_t> start_state; // snapshot of cpu at start of game -> reset
+
+    uint8_t nb_digit = 0;
+    uint8_t digit_col[ENV_MAX_SCORE_DIGIT];
+    uint8_t digit_line[ENV_MAX_SCORE_DIGIT];
+
+    // output of current step, written by workers (1 slot by instance)
+    uint8_t* obs_out = nullptr;
+    float* reward_out = nullptr;
+
+    explicit Yokoi_Env(unsigned nb_thread) : pool(nb_thread) {}
+};
+
+
+static void write_obs(const Yokoi_Env* env, SM5XX* cpu, uint8_t* obs){
+    memset(obs, 0, env->obs_size);
+    const Segment* segment = env->game->segment;
+    for(size_t i = 0; i < env->game->size_segment; i++){
+        obs[i >> 3] |= uint8_t(segment_bit_value(cpu->segment_bits, segment[i].bit) << (i & 7));
+    }
+}
+
+static uint32_t read_score(const Yokoi_Env* env, SM5XX* cpu){
+    uint32_t score = 0;
+    for(uint8_t i = 0; i < env->nb_digit; i++){
+        uint8_t digit = cpu->debug_get_elem_ram(env->digit_col[i], env->digit_line[i]) & 0x0F;
+        score = score * 10 + ((digit > 9) ? 0 : digit); // > 9 : digit not displayed
+    }
+    return score;
+}
+
+// button held -> new action, only buttons changed (Virtual_Input keep state of shared K bits)
+static void apply_action(Yokoi_Env* env, Pool_Instance& inst, uint32_t action){
+    uint32_t& held = env->held[inst.id];
+    uint32_t changed = held ^ action;
+    held = action;
+    if(changed == 0 || inst.input == nullptr){ return; }
+    for(const Env_Button& b : ENV_BUTTONS){
+        if(changed & b.bit){ inst.input->set_input(b.part, b.button, (action & b.bit) != 0); }
+    }
+}
+
+
+extern "C" {
+
+Yokoi_Env* yokoi_env_create(const char* pack_path, const char* ref_game, int n_envs, int nb_thread){
+    if(n_envs <= 0 || nb_thread < 0){ return nullptr; }
+
+    bool own_pack = false;
+    if(!gw_pack::is_loaded()){
+        if(pack_path == nullptr || !gw_pack::load(pack_path)){ return nullptr; }
+        own_pack = true;
+    }
+
+    const GW_rom* game = find_game(ref_game ? ref_game : "");
+    Yokoi_Env* env = (game != nullptr) ? new Yokoi_Env(unsigned(nb_thread)) : nullptr;
+    for(int i = 0; env != nullptr && i < n_envs; i++){
+        if(env->pool.add_instance(game) < 0){ delete env; env = nullptr; } // rom not supported
+    }
+    if(env == nullptr){
+        if(own_pack){ gw_pack::unload(); }
+        return nullptr;
+    }
+
+    env->game = game;
+    env->own_pack = own_pack;
+    env->nb_env = n_envs;
+    env->obs_size = int((game->size_segment + 7) / 8);
+    env->held.assign(n_envs, 0);
+    env->score.assign(n_envs, 0);
+    env->start_state.resize(env->pool.instance(0).cpu->get_state_size());
+    env->pool.instance(0).cpu->snapshot(env->start_state.data());
+
+    env->pool.set_frame_callback([env](Pool_Instance& inst){
+        if(env->obs_out != nullptr){ write_obs(env, inst.cpu, env->obs_out + size_t(inst.id) * env->obs_size); }
+        uint32_t score = read_score(env, inst.cpu);
+        if(env->reward_out != nullptr){ env->reward_out[inst.id] = float(int64_t(score) - int64_t(env->score[inst.id])); }
+        env->score[inst.id] = score;
+    });
+    return env;
+}
+
+
+void yokoi_env_destroy(Yokoi_Env* env){
+    if(env == nullptr){ return; }
+    bool own_pack = env->own_pack;
+    delete env; // pool first : cpu and input use game of pack
+    if(own_pack){ gw_pack::unload(); }
+}
+
+
+int yokoi_env_nb_env(const Yokoi_Env* env){ return env->nb_env; }
+
+int yokoi_env_obs_size(const Yokoi_Env* env){ return env->obs_size; }
+
+
+uint32_t yokoi_env_valid_actions(const Yokoi_Env* env){
+    const Virtual_Input* input = const_cast<Yokoi_Env*>(env)->pool.instance(0).input;
+    uint32_t valid = YOKOI_ACTION_GAMEA | YOKOI_ACTION_GAMEB | YOKOI_ACTION_TIME;
+    if(input == nullptr){ return valid; }
+
+    const uint8_t configuration[2] = { input->left_configuration, input->right_configuration };
+    for(int part = 0; part < 2; part++){
+        uint32_t buttons = 0;
+        switch(configuration[part]){
+            case CONF_1_BUTTON_ACTION: buttons = YOKOI_ACTION_LEFT_ACTION; break;
+            case CONF_2_BUTTON_UPDOWN: buttons = YOKOI_ACTION_LEFT_UP | YOKOI_ACTION_LEFT_DOWN; break;
+            case CONF_2_BUTTON_LEFTRIGHT: buttons = YOKOI_ACTION_LEFT_LEFT | YOKOI_ACTION_LEFT_RIGHT; break;
+            case CONF_4_BUTTON_DIRECTION: buttons = YOKOI_ACTION_LEFT_LEFT | YOKOI_ACTION_LEFT_RIGHT
+                                                    | YOKOI_ACTION_LEFT_UP | YOKOI_ACTION_LEFT_DOWN; break;
+            default: break;
+        }
+        valid |= (part == 0) ? buttons : (buttons << 8); // right = left << 8
+    }
+    return valid;
+}
+
+
+int yokoi_env_set_score_digits(Yokoi_Env* env, const uint8_t* col, const uint8_t* line, int nb_digit){
+    if(nb_digit < 0 || nb_digit > ENV_MAX_SCORE_DIGIT){ return 0; }
+    env->nb_digit = uint8_t(nb_digit);
+    for(int i = 0; i < nb_digit; i++){
+        env->digit_col[i] = col[i];
+        env->digit_line[i] = line[i];
+    }
+    for(int i = 0; i < env->nb_env; i++){ env->score[i] = read_score(env, env->pool.instance(i).cpu); }
+    return 1;
+}
+
+
+void yokoi_env_reset(Yokoi_Env* env, int id_env, uint8_t* obs_out){
+    int first = (id_env < 0) ? 0 : id_env;
+    int last = (id_env < 0) ? env->nb_env : id_env + 1;
+    for(int i = first; i < last; i++){
+        Pool_Instance& inst = env->pool.instance(i);
+        apply_action(env, inst, 0); // release all -> no button stay held in Virtual_Input
+        env->pool.restart_instance(i, env->start_state.data());
+        env->score[i] = read_score(env, inst.cpu);
+        if(obs_out != nullptr){ write_obs(env, inst.cpu, obs_out + size_t(i - first) * env->obs_size); }
+    }
+}
+
+
+void yokoi_env_step(Yokoi_Env* env, const uint32_t* actions, uint8_t* obs_out, float* reward_out){
+    for(int i = 0; i < env->nb_env; i++){ apply_action(env, env->pool.instance(i), actions ? actions[i] : 0); }
+
+    env->obs_out = obs_out;
+    env->reward_out = reward_out;
+    env->pool.run_slice(1);
+    env->obs_out = nullptr;
+    env->reward_out = nullptr;
+}
+
+} // extern "C"
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+
+// Batch of games for reinforcement learning (gym style), C API -> ctypes / cffi / any language.
+// n_envs instances of one game of a pack, each step = 1 frame (1/60 s) of every instance,
+// instances run in parallel on Emulator_Pool. No allocation after yokoi_env_create.
+//
+// Observation of an instance : state of each segment of the game (same order as pack), 1 bit by segment
+// -> yokoi_env_obs_size() octets, bit i = octet i / 8, bit i % 8.
+// Reward : difference of score between 2 steps. Score = digits in ram (1 nibble = 1 decimal digit,
+// same idea as clock digits of time_addresses.h), set by yokoi_env_set_score_digits. Without -> reward 0.
+//
+// Functions of an env are called from one thread only.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// action of an instance = buttons held during the step
+#define YOKOI_ACTION_GAMEA        (1u << 0)
+#define YOKOI_ACTION_GAMEB        (1u << 1)
+#define YOKOI_ACTION_TIME         (1u << 2)
+#define YOKOI_ACTION_ALARM        (1u << 3)
+#define YOKOI_ACTION_ACL          (1u << 4)
+#define YOKOI_ACTION_LEFT_ACTION  (1u << 8)
+#define YOKOI_ACTION_LEFT_LEFT    (1u << 9)
+#define YOKOI_ACTION_LEFT_RIGHT   (1u << 10)
+#define YOKOI_ACTION_LEFT_UP      (1u << 11)
+#define YOKOI_ACTION_LEFT_DOWN    (1u << 12)
+#define YOKOI_ACTION_RIGHT_ACTION (1u << 16)
+#define YOKOI_ACTION_RIGHT_LEFT   (1u << 17)
+#define YOKOI_ACTION_RIGHT_RIGHT  (1u << 18)
+#define YOKOI_ACTION_RIGHT_UP     (1u << 19)
+#define YOKOI_ACTION_RIGHT_DOWN   (1u << 20)
+
+typedef struct Yokoi_Env Yokoi_Env;
+
+// pack loaded if no pack yet (else pack already loaded is used), ref_game = ref or index in pack.
+// nb_thread = 0 -> nb cores of host. nullptr if pack, game or rom not supported
+Yokoi_Env* yokoi_env_create(const char* pack_path, const char* ref_game, int n_envs, int nb_thread);
+void yokoi_env_destroy(Yokoi_Env* env);
+
+int yokoi_env_nb_env(const Yokoi_Env* env);
+int yokoi_env_obs_size(const Yokoi_Env* env); // octets by instance
+uint32_t yokoi_env_valid_actions(const Yokoi_Env* env); // buttons of game (YOKOI_ACTION_*)
+
+// score digits : col[i], line[i] of ram, most significant first. 0 -> 1 on success
+int yokoi_env_set_score_digits(Yokoi_Env* env, const uint8_t* col, const uint8_t* line, int nb_digit);
+
+// game from start (snapshot of cpu taken at create) : env = -1 -> all instances. obs_out (n_envs * obs_size, or 1 instance) can be nullptr
+void yokoi_env_reset(Yokoi_Env* env, int id_env, uint8_t* obs_out);
+
+// actions[n_envs] -> 1 frame of all instances -> obs_out[n_envs * obs_size], reward_out[n_envs] (can be nullptr)
+void yokoi_env_step(Yokoi_Env* env, const uint32_t* actions, uint8_t* obs_out, float* reward_out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,358 @@
+// Headless runner : run a game of a rom pack from command line, without screen / sound / input device.
+// Used for profile and regression test of cpu on a host (Linux build farm) -> see BUILDING.md
+//
+// Output (stdout) :
+//   frame <n> <hash>   one line per frame (1/60 s) : hash of state of all segments of the game
+//   # ...              summary at end : emulated cycles, host time, throughput, final hash
+//
+// Movie (std/movie.h) : --record save input of the run at their cycle, --replay run it again uncapped
+// -> same hash for each frame (regression test, bug report with performance problem).
+//
+// Capture (std/frame_compositor.h) : --capture save picture of LCD in png when it changed, without gpu.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include "std/gw_pack.h"
+#include "std/timer.h"
+#include "std/movie.h"
+#include "std/blink_filter.h"
+#include "std/frame_compositor.h"
+#include "SM5XX/SM5XX.h"
+#include "SM5XX/get_cpu.h"
+#include "virtual_i_o/virtual_input.h"
+#include "headless_game.h"
+
+
+const int TIME_SET_GRACE_PERIOD = 500; // same as 3DS main.cpp : opcodes where time is set again (init of rom erase it)
+
+
+struct Options {
+    std::string pack_path;
+    std::string game; // ref or index in pack
+    std::string input_path;
+    std::string record_path; // movie saved at end
+    std::string replay_path; // movie played instead of input script
+    std::string capture_prefix; // png of LCD : <prefix>_<frame>.png
+    uint32_t capture_every = 1; // capture 1 frame on n
+    double seconds = 10.0;
+    bool uncapped = false;
+    bool list = false;
+    bool step = false; // step() cycle per cycle instead of run_cycles (reference for accuracy)
+    bool quiet = false; // no hash per frame
+    bool busy_loop_skip = true;
+    bool block_cache = true;
+    bool translated_rom = true;
+    int hour = -1, minute = 0, second = 0; // -1 -> time not set
+};
+
+// one line of input script : "<frame> <part> <button> <0|1> [player]"
+struct Input_Event {
+    uint64_t frame;
+    uint8_t part;
+    uint8_t button;
+    bool state;
+    uint8_t player;
+};
+
+
+static void print_usage(){
+    printf("usage: yokoi_headless <pack.ykp> [options]\n");
+    printf("  --list              list games of pack\n");
+    printf("  --game <ref|index>  game to run (default first of pack)\n");
+    printf("  --seconds <s>       emulated time (default 10)\n");
+    printf("  --uncapped          run as fast as possible (default real time)\n");
+    printf("  --input <file>      input script, lines \"<frame> <setup|left|right> <button> <0|1> [player]\"\n");
+    printf("  --time <hh:mm:ss>   set time of game at start (default not set)\n");
+    printf("  --record <file>     save movie of the run (start when time is set)\n");
+    printf("  --replay <file>     play movie uncapped (game, time, input and length of movie)\n");
+    printf("  --capture <prefix>  save LCD in <prefix>_<frame>.png when it changed (pack with png textures)\n");
+    printf("  --capture-every <n> capture 1 frame on n (default 1)\n");
+    printf("  --step              step() cycle per cycle instead of run_cycles (accuracy reference)\n");
+    printf("  --quiet             no hash per frame, only summary\n");
+    printf("  --no-busy-loop      disable busy loop skip\n");
+    printf("  --no-block-cache    disable block cache\n");
+    printf("  --no-translated     disable rom translated in C++\n");
+}
+
+static bool parse_options(int argc, char** argv, Options& opt){
+    for(int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if(arg == "--list"){ opt.list = true; }
+        else if(arg == "--uncapped"){ opt.uncapped = true; }
+        else if(arg == "--step"){ opt.step = true; }
+        else if(arg == "--quiet"){ opt.quiet = true; }
+        else if(arg == "--no-busy-loop"){ opt.busy_loop_skip = false; }
+        else if(arg == "--no-block-cache"){ opt.block_cache = false; }
+        else if(arg == "--no-translated"){ opt.translated_rom = false; }
+        else if(arg == "--game" && has_value){ opt.game = argv[++i]; }
+        else if(arg == "--input" && has_value){ opt.input_path = argv[++i]; }
+        else if(arg == "--record" && has_value){ opt.record_path = argv[++i]; }
+        else if(arg == "--replay" && has_value){ opt.replay_path = argv[++i]; }
+        else if(arg == "--capture" && has_value){ opt.capture_prefix = argv[++i]; }
+        else if(arg == "--capture-every" && has_value){ opt.capture_every = uint32_t(atoi(argv[++i])); }
+        else if(arg == "--seconds" && has_value){ opt.seconds = atof(argv[++i]); }
+        else if(arg == "--time" && has_value){
+            if(sscanf(argv[++i], "%d:%d:%d", &opt.hour, &opt.minute, &opt.second) != 3){ return false; }
+        }
+        else if(arg[0] != '-' && opt.pack_path.empty()){ opt.pack_path = arg; }
+        else { return false; }
+    }
+    return !opt.pack_path.empty() && opt.seconds > 0 && opt.capture_every > 0;
+}
+
+
+static bool parse_part(const std::string& name, uint8_t& part){
+    if(name == "setup"){ part = PART_SETUP; }
+    else if(name == "left"){ part = PART_LEFT; }
+    else if(name == "right"){ part = PART_RIGHT; }
+    else { return false; }
+    return true;
+}
+
+static bool parse_button(const std::string& name, uint8_t& button){
+    static const std::pair<const char*, uint8_t> buttons[] = {
+        {"gamea", BUTTON_GAMEA}, {"gameb", BUTTON_GAMEB}, {"time", BUTTON_TIME}, {"alarm", BUTTON_ALARM}, {"acl", BUTTON_ACL},
+        {"action", BUTTON_ACTION}, {"left", BUTTON_LEFT}, {"right", BUTTON_RIGHT}, {"up", BUTTON_UP}, {"down", BUTTON_DOWN},
+    };
+    for(const auto& b : buttons){
+        if(name == b.first){ button = b.second; return true; }
+    }
+    return false;
+}
+
+static bool load_input_script(const std::string& path, std::vector<Input_Event>& events){
+    std::ifstream file(path);
+    if(!file){ fprintf(stderr, "error: can not open input script '%s'\n", path.c_str()); return false; }
+
+    std::string line;
+    int num_line = 0;
+    while(std::getline(file, line)){
+        num_line++;
+        size_t comment = line.find('#');
+        if(comment != std::string::npos){ line.resize(comment); }
+        if(line.find_first_not_of(" \t\r") == std::string::npos){ continue; } // empty line
+        std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+        std::istringstream ss(line);
+        std::string part, button;
+        int state = 0, player = 1;
+
+        Input_Event event;
+        if(!(ss >> event.frame >> part >> button >> state) || !parse_part(part, event.part) || !parse_button(button, event.button)){
+            fprintf(stderr, "error: %s:%d bad input line\n", path.c_str(), num_line);
+            return false;
+        }
+        if(!(ss >> player)){ player = 1; }
+        event.state = (state != 0);
+        event.player = uint8_t(player);
+        events.push_back(event);
+    }
+    std::stable_sort(events.begin(), events.end(), [](const Input_Event& a, const Input_Event& b){ return a.frame < b.frame; });
+    return true;
+}
+
+
+static bool load_compositor(const GW_rom* game, Frame_Compositor& compositor, std::string* error_out){
+    Image_RGBA segment_texture, background_texture;
+    if(!load_pack_texture(game->path_segment, segment_texture, error_out)){ return false; }
+    bool with_background = !game->path_background.empty();
+    if(with_background && !load_pack_texture(game->path_background, background_texture, error_out)){ return false; }
+    return compositor.load(game->segment, game->size_segment, game->segment_info, segment_texture
+                            , game->background_info, with_background ? &background_texture : nullptr, AppSettings(), error_out);
+}
+
+
+static const char* cpu_name(const GW_rom* game){
+    switch(get_cpu_type(game->rom, uint16_t(game->size_rom))){ // same names as name_cpu
+        case CPU_TYPE_SM5A: return "SM5A";
+        case CPU_TYPE_SM510: return "SM510";
+        case CPU_TYPE_SM511_2: return "SM511_SM512";
+        default: return "unsupported";
+    }
+}
+
+
+int main(int argc, char** argv){
+    Options opt;
+    if(!parse_options(argc, argv, opt)){ print_usage(); return 2; }
+
+    std::string error;
+    if(!gw_pack::load(opt.pack_path, &error)){
+        fprintf(stderr, "error: can not load pack '%s' : %s\n", opt.pack_path.c_str(), error.c_str());
+        return 1;
+    }
+
+    if(opt.list){
+        for(size_t i = 0; i < gw_pack::game_count(); i++){
+            const GW_rom* game = gw_pack::game_at(i);
+            printf("%3u %-8s %-12s %s\n", (unsigned)i, game->ref.c_str(), cpu_name(game), game->name.c_str());
+        }
+        return 0;
+    }
+
+    Movie movie;
+    bool replay = !opt.replay_path.empty();
+    if(replay){
+        if(!movie.load(opt.replay_path, &error)){
+            fprintf(stderr, "error: can not load movie '%s' : %s\n", opt.replay_path.c_str(), error.c_str());
+            return 1;
+        }
+        opt.game = movie.ref;
+        opt.uncapped = true;
+        opt.hour = -1; // time in state of movie
+        opt.input_path.clear();
+        opt.record_path.clear();
+    }
+
+    const GW_rom* game = find_game(opt.game);
+    if(game == nullptr){ fprintf(stderr, "error: game '%s' not in pack\n", opt.game.c_str()); return 1; }
+
+    std::vector<Input_Event> input_events;
+    if(!opt.input_path.empty() && !load_input_script(opt.input_path, input_events)){ return 1; }
+
+    SM5XX* cpu = load_game_cpu(game);
+    if(cpu == nullptr){
+        fprintf(stderr, "error: rom of '%s' not supported (size %u)\n", game->ref.c_str(), (unsigned)game->size_rom);
+        return 1;
+    }
+    cpu->set_busy_loop_skip(opt.busy_loop_skip);
+    cpu->set_block_cache(opt.block_cache);
+    cpu->set_translated_rom(opt.translated_rom);
+
+    Virtual_Input* v_input = get_input_config(cpu, game->ref);
+    if(v_input != nullptr){ cpu->set_input_multiplexage(v_input->use_multiplexage); }
+    else if(!input_events.empty()){ fprintf(stderr, "warning: no input config for '%s', input script ignored\n", game->ref.c_str()); }
+
+    printf("# game %s (%s) cpu %s\n", game->ref.c_str(), game->name.c_str(), cpu->name_cpu.c_str());
+
+    bool capture = !opt.capture_prefix.empty();
+    Blink_Filter blink_filter;
+    Frame_Compositor compositor;
+    if(capture){
+        if(!load_compositor(game, compositor, &error)){ fprintf(stderr, "error: can not capture '%s' : %s\n", game->ref.c_str(), error.c_str()); return 1; }
+        blink_filter.set_segments(game->segment, game->size_segment);
+    }
+    uint64_t compose_us = 0;
+    uint64_t nb_compose = 0, nb_capture = 0;
+
+    uint64_t nb_frame = uint64_t(opt.seconds * FPS_HEADLESS + 0.5);
+    uint64_t frame_time_us = 1000000 / FPS_HEADLESS;
+    uint32_t curr_rate = 0;
+    uint64_t first_frame = 0; // frames numbered from start of movie (record / replay)
+    if(replay){
+        if(!movie.start_play(cpu)){ fprintf(stderr, "error: movie not made with cpu of '%s'\n", game->ref.c_str()); return 1; }
+        cpu->frequency = movie.frequency;
+        curr_rate = movie.rate_start;
+        nb_frame = UINT64_MAX;
+        printf("# movie %llu cycles %u input events\n", (unsigned long long)movie.get_nb_cycle(), (unsigned)movie.get_nb_event());
+    }
+    int time_set_grace_counter = (opt.hour >= 0) ? TIME_SET_GRACE_PERIOD : 0;
+    size_t i_event = 0;
+    uint64_t nb_opcode = 0;
+    uint64_t final_hash = 0xCBF29CE484222325ULL;
+    Cycle_Events cycle_events;
+
+    uint64_t time_start = time_us_64_p();
+    uint64_t frame = 0;
+    for(; frame < nb_frame; frame++){
+        if(replay && movie.is_finished(cpu)){ break; }
+        if(!opt.record_path.empty() && !movie.is_recording() && time_set_grace_counter <= 0){
+            movie.start_record(cpu, game->ref, curr_rate); // after time set -> set_time not in movie
+            first_frame = frame;
+        }
+
+        while(i_event < input_events.size() && input_events[i_event].frame <= frame){
+            const Input_Event& event = input_events[i_event];
+            if(v_input != nullptr){ v_input->set_input(event.part, event.button, event.state, event.player); }
+            i_event++;
+        }
+
+        uint32_t step = cycles_of_frame(cpu->frequency, curr_rate);
+
+        while(step > 0){
+            if(opt.step || time_set_grace_counter > 0){
+                if(replay){ movie.apply_inputs(cpu); }
+                if(cpu->step()){
+                    nb_opcode += 1;
+                    if(time_set_grace_counter > 0){
+                        time_set_grace_counter--;
+                        cpu->time_set(false); // force time again
+                        cpu->set_time(uint8_t(opt.hour), uint8_t(opt.minute), uint8_t(opt.second));
+                        cpu->time_set(true);
+                    }
+                }
+                step -= 1;
+                continue;
+            }
+            uint32_t nb_cycle = replay ? movie.play_cycles(cpu, step, cycle_events) : cpu->run_cycles(step, cycle_events);
+            nb_opcode += cycle_events.nb_opcode;
+            step -= nb_cycle;
+        }
+
+        uint64_t hash = hash_segments(cpu, game);
+        if(opt.record_path.empty() || movie.is_recording()){ // not frames of time set before movie
+            final_hash = (final_hash ^ hash) * 0x100000001B3ULL;
+            if(!opt.quiet){ printf("frame %llu %016llx\n", (unsigned long long)(frame - first_frame), (unsigned long long)hash); }
+
+            if(capture){
+                blink_filter.update(cpu->segment_bits); // each frame as frontends, even if not captured
+                if((frame - first_frame) % opt.capture_every == 0){
+                    uint64_t time_compose = time_us_64_p();
+                    bool changed = compositor.compose(blink_filter);
+                    compose_us += time_us_64_p() - time_compose;
+                    nb_compose++;
+                    if(changed){
+                        std::string path = opt.capture_prefix + "_" + std::to_string(frame - first_frame) + ".png";
+                        if(!png_save(path, compositor.get_frame(), &error)){
+                            fprintf(stderr, "error: can not save capture '%s' : %s\n", path.c_str(), error.c_str());
+                            capture = false;
+                        }
+                        else { nb_capture++; }
+                    }
+                }
+            }
+        }
+
+        if(!opt.uncapped){ // real time
+            uint64_t target = time_start + (frame + 1) * frame_time_us;
+            uint64_t now = time_us_64_p();
+            if(now < target){ sleep_us_p(target - now); }
+        }
+    }
+    uint64_t time_us = time_us_64_p() - time_start;
+    if(time_us == 0){ time_us = 1; }
+    nb_frame = frame;
+
+    if(movie.is_recording()){
+        movie.stop_record(cpu);
+        if(!movie.save(opt.record_path, &error)){ fprintf(stderr, "error: can not save movie '%s' : %s\n", opt.record_path.c_str(), error.c_str()); }
+        else { printf("# movie %llu cycles %u input events\n", (unsigned long long)movie.get_nb_cycle(), (unsigned)movie.get_nb_event()); }
+    }
+
+    double host_seconds = time_us / 1000000.0;
+    double emulated_seconds = double(nb_frame) / FPS_HEADLESS;
+    printf("# frames %llu emulated %.3f s host %.3f s (x%.1f)\n", (unsigned long long)nb_frame, emulated_seconds, host_seconds, emulated_seconds / host_seconds);
+    printf("# cycles %llu opcodes %llu -> %.0f cycles/s %.0f opcodes/s\n", (unsigned long long)cpu->cycle_count, (unsigned long long)nb_opcode,
+            cpu->cycle_count / host_seconds, nb_opcode / host_seconds);
+    printf("# busy loop skip %llu cycles in %u skip\n", (unsigned long long)cpu->debug_busy_loop_cycles_skipped, cpu->debug_busy_loop_nb_skip);
+    printf("# %s\n", cpu->debug_block_cache().c_str());
+    printf("# %s\n", cpu->debug_fused_pair().c_str());
+    if(nb_compose > 0){
+        double compose_seconds = (compose_us ? compose_us : 1) / 1000000.0;
+        printf("# capture %llu png, compose %llu frames in %.3f s (%.0f frames/s)\n", (unsigned long long)nb_capture
+                , (unsigned long long)nb_compose, compose_seconds, nb_compose / compose_seconds);
+    }
+    printf("# final hash %016llx\n", (unsigned long long)final_hash);
+
+    delete v_input;
+    delete cpu;
+    gw_pack::unload();
+    return 0;
+}
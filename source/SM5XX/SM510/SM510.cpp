@@ -1,5 +1,4 @@
 #include "SM5XX/SM510/SM510.h"
-#include "SM5XX/sm510/sm510.h"
 #include "std/timer.h"
 #include <cstring>
 #include <stdio.h>
@@ -8,6 +7,8 @@
 
 void SM510::init()
 {
+    decode_table = get_decode_table();
+
     program_counter = {3, 7, 0}; // Doc Sharp
     s_buffer_program_counter = {0, 0, 0};
     r_buffer_program_counter = {0, 0, 0};
@@ -42,10 +43,12 @@ void SM510::init()
     segments_state_are_update = false;
     alternativ_col_ram = 0x00; // used for sbm -> change temporaly value of ram col adresse
     cycle_curr_opcode = 0;
+    cycle_count = 0;
 
     for(int col = 0; col < SM510_RAM_VIDEO_COL+1; col++){
         for(int line = 0; line < SM510_RAM_LINE; line++){ segment_on[col][line] = 0x00; }
     }
+    pack_segments();
     flag_time_update_screen = 0x00;
 
     cpu_frequency_divider = 0x01;
@@ -74,6 +77,52 @@ bool SM510::is_on_double_octet(uint8_t opcode){
     ;
 }
 
+uint8_t SM510::block_kind(uint8_t opcode){
+    // T, ATPL, RTN, TL, TML and LBL are already end of block (build_decode_table)
+    if( (opcode == 0x5D) // CEND -> sleep
+        | (opcode == 0x61) // ATR -> sound
+        | (opcode == 0x65) // IDIV -> clock divider
+        | (opcode == 0x50) | (opcode == 0x5C) // illegal
+    ){ return BLOCK_BARRIER; }
+
+    if( ((opcode & 0xC0) == 0xC0) // TM
+        | ((opcode & 0xE0) == 0x20) // LAX (skip next LAX), ADX
+        | ((opcode & 0xF4) == 0x14) // EXCI, EXCD
+        | ((opcode & 0xFC) == 0x54) // TMI
+        | (opcode == 0x09) // ADD11
+        | ((opcode & 0xFC) == 0x50) // TB, TC, TAM
+        | (opcode == 0x58) | (opcode == 0x5A) | (opcode == 0x5B) | (opcode == 0x5E) // TIS, TA0, TABL, TA
+        | ((opcode & 0xF7) == 0x64) // INCB, DECB
+        | ((opcode & 0xFE) == 0x68) // TF1, TF4
+    ){ return BLOCK_END; }
+    return BLOCK_NEXT;
+}
+
+const Opcode_Decode* SM510::get_decode_table(){
+    static const Decode_Table table = build_decode_table(decode_opcode, no_pc_increase, is_on_double_octet, block_kind);
+    return table.entry;
+}
+
+const Fused_Pair<SM510>* SM510::get_fused_pairs(uint8_t& nb_pair){
+    // set ram adress then use it, test then jump (see CONVERT_ROM/utils/fused_pair_report.py)
+    static const Fused_Pair<SM510> pairs[] = {
+        { opcode_handler(&SM510::op_lb), opcode_handler(&SM510::g_op_exc), &run_fused_pair<&SM510::op_lb, &SM510::g_op_exc>, "LB+EXC" },
+        { opcode_handler(&SM510::op_lb), opcode_handler(&SM510::op_exci), &run_fused_pair<&SM510::op_lb, &SM510::op_exci>, "LB+EXCI" },
+        { opcode_handler(&SM510::op_lb), opcode_handler(&SM510::op_excd), &run_fused_pair<&SM510::op_lb, &SM510::op_excd>, "LB+EXCD" },
+        { opcode_handler(&SM510::op_lb), opcode_handler(&SM510::g_op_lda), &run_fused_pair<&SM510::op_lb, &SM510::g_op_lda>, "LB+LDA" },
+        { opcode_handler(&SM510::g_op_lbl), opcode_handler(&SM510::g_op_exc), &run_fused_pair<&SM510::g_op_lbl, &SM510::g_op_exc>, "LBL+EXC" },
+        { opcode_handler(&SM510::g_op_lbl), opcode_handler(&SM510::op_exci), &run_fused_pair<&SM510::g_op_lbl, &SM510::op_exci>, "LBL+EXCI" },
+        { opcode_handler(&SM510::g_op_lbl), opcode_handler(&SM510::g_op_lda), &run_fused_pair<&SM510::g_op_lbl, &SM510::g_op_lda>, "LBL+LDA" },
+        { opcode_handler(&SM510::g_op_tam), opcode_handler(&SM510::op_t), &run_fused_pair<&SM510::g_op_tam, &SM510::op_t>, "TAM+T" },
+        { opcode_handler(&SM510::g_op_tc), opcode_handler(&SM510::op_t), &run_fused_pair<&SM510::g_op_tc, &SM510::op_t>, "TC+T" },
+        { opcode_handler(&SM510::g_op_ta0), opcode_handler(&SM510::op_t), &run_fused_pair<&SM510::g_op_ta0, &SM510::op_t>, "TA0+T" },
+        { opcode_handler(&SM510::g_op_tis), opcode_handler(&SM510::op_t), &run_fused_pair<&SM510::g_op_tis, &SM510::op_t>, "TIS+T" },
+    };
+    static_assert(sizeof(pairs) / sizeof(pairs[0]) <= MAX_FUSED_PAIR, "too many fused pairs");
+    nb_pair = sizeof(pairs) / sizeof(pairs[0]);
+    return pairs;
+}
+
 
 
 /////////////////////////// RAM / ROM MANIPULATION //////////////////////////////////////////////////////
@@ -89,32 +138,11 @@ void SM510::load_rom(const uint8_t* file_hex, size_t){
             }
         }
     }
+    clear_block_cache();
 }
 
 
 // Read / write data -> from rom or ram
-uint8_t SM510::read_rom_value(){
-    return rom[program_counter.col][program_counter.line][program_counter.word];
-}
-
-
-uint8_t SM510::read_ram_value(){
-    uint8_t col = ram_address.col;
-    if(alternativ_col_ram != 0x00){ col = alternativ_col_ram;} // x[1] bit are upper -> active
-
-    col = min(col, SM510_RAM_COL-1); // copy of max value if col and line too big
-    uint8_t line = min(ram_address.line, SM510_RAM_LINE-1);
-    return ram[col][line];
-}
-
-void SM510::write_ram_value(uint8_t value){
-    uint8_t col = ram_address.col;
-    if(alternativ_col_ram != 0x00){ col = alternativ_col_ram;} // x[1] bit are upper -> active
-    
-    col = min(col, SM510_RAM_COL-1); // copy of max value if col and line too big
-    uint8_t line = min(ram_address.line, SM510_RAM_LINE-1);
-    ram[col][line] = value & 0x0F; // 4 bit RAM
-}
 
 void SM510::set_ram_value(uint8_t col, uint8_t line, uint8_t value) {
     if (col >= SM510_RAM_COL || line >= SM510_RAM_LINE) 
@@ -132,19 +160,23 @@ void SM510::wake_up(){
 }
 
 
-/////////////////////////// Segment / screen //////////////////////////////////////////////////////
+/////////////////////////// Busy-wait loop //////////////////////////////////////////////////////
 
-bool SM510::condition_to_update_segment(){
-    uint16_t value = ((f_clock_divider >> 9) & 0x01);
-    if( value != flag_time_update_screen)
-    { // simplify version for perf
-        flag_time_update_screen = value;
-        return true;
-    }
-    return false;
+void SM510::add_busy_loop_state(Busy_Loop_State& state){
+    state.add(ram);
+    state.add(r_buffer_program_counter);
+    state.add(w_shift_register);
+    state.add(r_buzzer_control);
+    state.add(r_buzzer_output);
+    state.add(bc_lcd_stop);
+    state.add(l_bs);
+    state.add(y_bs);
+    state.add(alternativ_col_ram);
 }
 
 
+/////////////////////////// Segment / screen //////////////////////////////////////////////////////
+
 bool SM510::screen_is_on() { return (!bc_lcd_stop) && bp_lcd_blackplate; }
 
 void SM510::update_segment(){
@@ -167,6 +199,7 @@ void SM510::update_segment(){
             else { segment_on[col][line] = ram[ram_col][line];} 
         }
     }
+    pack_segments();
     segments_state_are_update  = true;
 }
 
@@ -195,15 +228,6 @@ void SM510::update_sound(){
     }*/
 }
 
-bool SM510::get_active_sound(){
-    //return (r_buzzer_control & 0x01) | ((r_buzzer_control >> 1) & 0x01);
-    //return (r_buzzer_output & 0x01) | ((r_buzzer_output >> 1) & 0x01);
-    //if( ((f_clock_divider>>3)& 0x01) == 0x01){ return (r_buzzer_control & 0x01); }
-    if( ((f_clock_divider>>2)& 0x01) == 0x01){ return (r_buzzer_control & 0x01); }
-    return 0x00/*((r_buzzer_control >> 1) & 0x01)*/;
-}
-
-
 /////////////////////////// Debug //////////////////////////////////////////////////////
 uint8_t SM510::debug_get_elem_ram(int col, int line) { 
     uint8_t col_ = min(col, SM510_RAM_COL-1); // copy of max value if col and line too big
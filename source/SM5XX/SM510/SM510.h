@@ -2,7 +2,7 @@
 //#include <vector> declared in SM5xx.h
 #include <cstdint>
 #include <string>
-#include "SM5XX/SM5XX.h"
+#include "SM5XX/SM5XX_core.h"
 
 
 constexpr uint8_t SM510_RAM_COL = 8;
@@ -19,10 +19,14 @@ constexpr uint8_t SM510_ROM_MAME_WORD = 63 + 1; // per each line : 63 standars w
 //  constexpr int FREQUENCY_CPU = 32768; declared in SM5xx.h
 
 
-class SM510: public SM5XX {
+class SM510 final : public SM5XXCore<SM510> {
+    friend class SM5XXCore<SM510>; // loop of cpu call function of SM510 without virtual
+    template <class, uint32_t> friend struct Translated_Rom; // rom translated in C++ call instructions
+    template <class, class> friend class SM5XX_Lockstep; // lanes of lockstep copy variables of cpu
+    friend class SM510_Lockstep;
 public : 
     SM510() : 
-        SM5XX("SM510\0") // +1 for bs output
+        SM5XXCore<SM510>("SM510\0") // +1 for bs output
         {}
 
 public:
@@ -31,12 +35,19 @@ public:
 
     bool screen_is_on() override;
     bool get_segments_state(uint8_t col, uint8_t line, uint8_t word) override;
-    bool get_active_sound() override;
+    bool get_active_sound() override {
+        //return (r_buzzer_control & 0x01) | ((r_buzzer_control >> 1) & 0x01);
+        //return (r_buzzer_output & 0x01) | ((r_buzzer_output >> 1) & 0x01);
+        //if( ((f_clock_divider>>3)& 0x01) == 0x01){ return (r_buzzer_control & 0x01); }
+        if( ((f_clock_divider>>2)& 0x01) == 0x01){ return (r_buzzer_control & 0x01); }
+        return 0x00/*((r_buzzer_control >> 1) & 0x01)*/;
+    }
 
     // Save/Load state
     bool save_state(FILE* file) override;
     bool load_state(FILE* file) override;
     uint8_t get_cpu_type_id() override { return 1; } // CPU_TYPE_SM510
+    static constexpr Segment_Layout SEGMENT_LAYOUT = { SM510_RAM_VIDEO_COL+1, SM510_RAM_LINE, 4 }; // segment_bits
 
 private:
     /// Variables / register /// 
@@ -65,23 +76,69 @@ private:
     void update_segment() override;
     void update_sound() override;
 
-    bool no_pc_increase(uint8_t opcode) override;
-    bool is_on_double_octet(uint8_t opcode) override;
-
     void execute_curr_opcode() override;
-
-    bool condition_to_update_segment() override;
+    template <class Instruction> // handler of decode table, or instruction known at compile time (translated rom)
+    void execute_opcode(Instruction instruction){
+        (this->*instruction)();
+
+        // 0x02 = SBM instruction use for temporaly change col ram (only for next instruction)
+        if( (alternativ_col_ram != 0x00) && (curr_opcode != 0x02) ){ 
+            alternativ_col_ram = 0x00;
+        }
+    }
+
+    bool condition_to_update_segment() override {
+        uint16_t value = ((f_clock_divider >> 9) & 0x01);
+        if( value != flag_time_update_screen)
+        { // simplify version for perf
+            flag_time_update_screen = value;
+            return true;
+        }
+        return false;
+    }
 
     void wake_up() override;
-
-    uint8_t read_rom_value() override;
-    uint8_t read_ram_value() override;
-    void write_ram_value(uint8_t value) override;
+    void add_busy_loop_state(Busy_Loop_State& state); // all variables can change in a loop
+    static constexpr auto state_members(){ // snapshot / restore (rom not included)
+        return std::make_tuple(&SM510::ram, &SM510::segment_on, &SM510::r_buffer_program_counter, &SM510::w_shift_register
+                                , &SM510::r_buzzer_control, &SM510::r_buzzer_output, &SM510::bc_lcd_stop
+                                , &SM510::l_bs, &SM510::y_bs, &SM510::alternativ_col_ram);
+    }
+
+    bool sound_is_static(){ return (r_buzzer_control & 0x01) == 0x00; } // else buzzer follow clock divider
+
+    uint8_t read_rom_value() override {
+        return rom[program_counter.col][program_counter.line][program_counter.word];
+    }
+    uint8_t read_ram_value() override {
+        uint8_t col = ram_address.col;
+        if(alternativ_col_ram != 0x00){ col = alternativ_col_ram;} // x[1] bit are upper -> active
+
+        col = min(col, SM510_RAM_COL-1); // copy of max value if col and line too big
+        uint8_t line = min(ram_address.line, SM510_RAM_LINE-1);
+        return ram[col][line];
+    }
+    void write_ram_value(uint8_t value) override {
+        uint8_t col = ram_address.col;
+        if(alternativ_col_ram != 0x00){ col = alternativ_col_ram;} // x[1] bit are upper -> active
+
+        col = min(col, SM510_RAM_COL-1); // copy of max value if col and line too big
+        uint8_t line = min(ram_address.line, SM510_RAM_LINE-1);
+        ram[col][line] = value & 0x0F; // 4 bit RAM
+    }
     void set_ram_value(uint8_t col, uint8_t line, uint8_t value) override;
 
 private:
     uint8_t segment_on_value_sp_bs(int curr_line);
 
+    // decode table -> built one time, shared by each SM510
+    static const Opcode_Decode* get_decode_table();
+    static Opcode_Handler decode_opcode(uint8_t opcode); // switch case op_code function with hexa op_code value
+    static bool no_pc_increase(uint8_t opcode); // say opcode with not increase PC
+    static bool is_on_double_octet(uint8_t opcode); // need for instruction on 2 octet -> skip 2 octet
+    static uint8_t block_kind(uint8_t opcode); // opcode can skip next one or never in basic block (block cache)
+    static const Fused_Pair<SM510>* get_fused_pairs(uint8_t& nb_pair); // opcodes often together (block cache)
+
     // -- from SM510_instruction.cpp ------------------------------ //
     // Opcode -> instruction of processor
     
@@ -136,3 +193,5 @@ public : // debug
 
     uint8_t debug_multiplexage() override { return w_shift_register; }
 };
+
+extern template class SM5XXCore<SM510>; // instantiate in SM510_instruction.cpp
@@ -0,0 +1,309 @@
+#include "SM5XX/SM510/SM510_lockstep.h"
+
+
+template class SM5XX_Lockstep<SM510_Lockstep, SM510>;
+
+
+const Lane_Instruction<SM510_Lockstep>* SM510_Lockstep::get_lane_instructions(uint8_t& nb_instruction){
+    // handler of SM510 decode table -> same instruction on lanes
+    static const Lane_Instruction<SM510_Lockstep> instructions[] = {
+        { opcode_handler(&SM510::g_op_lax), &SM510_Lockstep::g_op_lax },
+        { opcode_handler(&SM510::g_op_adx), &SM510_Lockstep::g_op_adx },
+        { opcode_handler(&SM510::op_lb), &SM510_Lockstep::op_lb },
+        { opcode_handler(&SM510::op_t), &SM510_Lockstep::op_t },
+        { opcode_handler(&SM510::op_tm), &SM510_Lockstep::op_tm },
+        { opcode_handler(&SM510::g_op_rm), &SM510_Lockstep::g_op_rm },
+        { opcode_handler(&SM510::g_op_sm), &SM510_Lockstep::g_op_sm },
+        { opcode_handler(&SM510::g_op_exc), &SM510_Lockstep::g_op_exc },
+        { opcode_handler(&SM510::op_exci), &SM510_Lockstep::op_exci },
+        { opcode_handler(&SM510::g_op_lda), &SM510_Lockstep::g_op_lda },
+        { opcode_handler(&SM510::op_excd), &SM510_Lockstep::op_excd },
+        { opcode_handler(&SM510::g_op_tmi), &SM510_Lockstep::g_op_tmi },
+        { opcode_handler(&SM510::op_tl), &SM510_Lockstep::op_tl },
+        { opcode_handler(&SM510::op_tml), &SM510_Lockstep::op_tml },
+        { opcode_handler(&SM510::op_skip), &SM510_Lockstep::op_skip },
+        { opcode_handler(&SM510::op_atbp), &SM510_Lockstep::op_atbp },
+        { opcode_handler(&SM510::op_sbm), &SM510_Lockstep::op_sbm },
+        { opcode_handler(&SM510::op_atpl), &SM510_Lockstep::op_atpl },
+        { opcode_handler(&SM510::g_op_add), &SM510_Lockstep::g_op_add },
+        { opcode_handler(&SM510::g_op_add11), &SM510_Lockstep::g_op_add11 },
+        { opcode_handler(&SM510::g_op_coma), &SM510_Lockstep::g_op_coma },
+        { opcode_handler(&SM510::g_op_exbla), &SM510_Lockstep::g_op_exbla },
+        { opcode_handler(&SM510::g_op_tb), &SM510_Lockstep::g_op_tb },
+        { opcode_handler(&SM510::g_op_tc), &SM510_Lockstep::g_op_tc },
+        { opcode_handler(&SM510::g_op_tam), &SM510_Lockstep::g_op_tam },
+        { opcode_handler(&SM510::g_op_tis), &SM510_Lockstep::g_op_tis },
+        { opcode_handler(&SM510::op_atl), &SM510_Lockstep::op_atl },
+        { opcode_handler(&SM510::g_op_ta0), &SM510_Lockstep::g_op_ta0 },
+        { opcode_handler(&SM510::g_op_tabl), &SM510_Lockstep::g_op_tabl },
+        { opcode_handler(&SM510::g_op_cend), &SM510_Lockstep::g_op_cend },
+        { opcode_handler(&SM510::g_op_ta), &SM510_Lockstep::g_op_ta },
+        { opcode_handler(&SM510::g_op_lbl), &SM510_Lockstep::g_op_lbl },
+        { opcode_handler(&SM510::op_atfc), &SM510_Lockstep::op_atfc },
+        { opcode_handler(&SM510::op_atr), &SM510_Lockstep::op_atr },
+        { opcode_handler(&SM510::op_wr), &SM510_Lockstep::op_wr },
+        { opcode_handler(&SM510::op_ws), &SM510_Lockstep::op_ws },
+        { opcode_handler(&SM510::op_incb), &SM510_Lockstep::op_incb },
+        { opcode_handler(&SM510::g_op_idiv), &SM510_Lockstep::g_op_idiv },
+        { opcode_handler(&SM510::g_op_rc), &SM510_Lockstep::g_op_rc },
+        { opcode_handler(&SM510::g_op_sc), &SM510_Lockstep::g_op_sc },
+        { opcode_handler(&SM510::op_tf1), &SM510_Lockstep::op_tf1 },
+        { opcode_handler(&SM510::op_tf4), &SM510_Lockstep::op_tf4 },
+        { opcode_handler(&SM510::op_kta), &SM510_Lockstep::op_kta },
+        { opcode_handler(&SM510::op_rot), &SM510_Lockstep::op_rot },
+        { opcode_handler(&SM510::op_decb), &SM510_Lockstep::op_decb },
+        { opcode_handler(&SM510::op_bdc), &SM510_Lockstep::op_bdc },
+        { opcode_handler(&SM510::op_rtn0), &SM510_Lockstep::op_rtn0 },
+        { opcode_handler(&SM510::op_rtn1), &SM510_Lockstep::op_rtn1 },
+        { opcode_handler(&SM510::g_op_illegal), &SM510_Lockstep::g_op_illegal },
+    };
+    nb_instruction = sizeof(instructions) / sizeof(instructions[0]);
+    return instructions;
+}
+
+
+
+/////////////////////////// Lanes <-> SM510 //////////////////////////////////////////////////////
+
+void SM510_Lockstep::load_lane(uint8_t lane, const SM510& cpu){
+    for(int col = 0; col < SM510_RAM_COL; col++){
+        for(int line = 0; line < SM510_RAM_LINE; line++){ ram[col * SM510_RAM_LINE + line][lane] = cpu.ram[col][line]; }
+    }
+    for(int col = 0; col < SM510_RAM_VIDEO_COL+1; col++){
+        for(int line = 0; line < SM510_RAM_LINE; line++){ segment_on[col][line][lane] = cpu.segment_on[col][line]; }
+    }
+    r_col[lane] = cpu.r_buffer_program_counter.col;
+    r_line[lane] = cpu.r_buffer_program_counter.line;
+    r_word[lane] = cpu.r_buffer_program_counter.word;
+    w_shift_register[lane] = cpu.w_shift_register;
+    r_buzzer_control[lane] = cpu.r_buzzer_control;
+    r_buzzer_output[lane] = cpu.r_buzzer_output;
+    bc_lcd_stop[lane] = cpu.bc_lcd_stop;
+    l_bs[lane] = cpu.l_bs;
+    y_bs[lane] = cpu.y_bs;
+    alternativ_col_ram[lane] = cpu.alternativ_col_ram;
+}
+
+void SM510_Lockstep::store_lane_cpu(uint8_t lane, SM510& cpu){
+    for(int col = 0; col < SM510_RAM_COL; col++){
+        for(int line = 0; line < SM510_RAM_LINE; line++){ cpu.ram[col][line] = ram[col * SM510_RAM_LINE + line][lane]; }
+    }
+    for(int col = 0; col < SM510_RAM_VIDEO_COL+1; col++){
+        for(int line = 0; line < SM510_RAM_LINE; line++){ cpu.segment_on[col][line] = segment_on[col][line][lane]; }
+    }
+    cpu.pack_segments();
+    cpu.r_buffer_program_counter = { r_col[lane], r_line[lane], r_word[lane] };
+    cpu.w_shift_register = w_shift_register[lane];
+    cpu.r_buzzer_control = r_buzzer_control[lane];
+    cpu.r_buzzer_output = r_buzzer_output[lane];
+    cpu.bc_lcd_stop = bc_lcd_stop[lane];
+    cpu.l_bs = l_bs[lane];
+    cpu.y_bs = y_bs[lane];
+    cpu.alternativ_col_ram = alternativ_col_ram[lane];
+}
+
+
+
+/////////////////////////// Wake up / Segment //////////////////////////////////////////////////////
+
+void SM510_Lockstep::wake_up(uint8_t lane){
+    is_sleep[lane] = false;
+    pc_col[lane] = 1; pc_line[lane] = 0; pc_word[lane] = 0; // Doc Sharp
+    bp_lcd_blackplate[lane] = true;
+    bc_lcd_stop[lane] = false;
+}
+
+void SM510_Lockstep::update_segment(uint8_t lane){
+    // same as SM510::update_segment : col 0 / 1 -> ram 6 / 7, col 2 -> bs (line 0 only)
+    for(int line = 0; line < SM510_RAM_LINE; line++){
+        segment_on[0][line][lane] = ram[(SM510_RAM_COL-2) * SM510_RAM_LINE + line][lane];
+        segment_on[1][line][lane] = ram[(SM510_RAM_COL-1) * SM510_RAM_LINE + line][lane];
+        segment_on[2][line][lane] = 0x00;
+    }
+    uint8_t blink = 0xFF;
+    if(((f_clock_divider[lane] >> 14) & 0x01) == 0x01){ blink = ~y_bs[lane]; }
+    segment_on[2][0][lane] = l_bs[lane] & blink;
+    segments_state_are_update[lane] = true;
+}
+
+bool SM510_Lockstep::get_segments_state_lane(uint8_t lane, uint8_t col, uint8_t line, uint8_t word){
+    if(col >= (SM510_RAM_VIDEO_COL+1) || line >= SM510_RAM_LINE || word >= 4){ return false; }
+    return (segment_on[col][line][lane] >> word) & 0x01;
+}
+
+
+
+// ############### Opcode -> instruction on lanes #############################################
+
+// ----- ROM adress
+void SM510_Lockstep::op_atpl(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        pc_word[i] = select(mask[i], (pc_word[i] & 0x30) | (accumulator[i] & 0x0F), pc_word[i]);
+    }
+};
+
+void SM510_Lockstep::op_rtn0(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        pc_col[i] = select(mask[i], s_col[i], pc_col[i]);
+        pc_line[i] = select(mask[i], s_line[i], pc_line[i]);
+        pc_word[i] = select(mask[i], s_word[i], pc_word[i]);
+        s_col[i] = select(mask[i], r_col[i], s_col[i]);
+        s_line[i] = select(mask[i], r_line[i], s_line[i]);
+        s_word[i] = select(mask[i], r_word[i], s_word[i]);
+    }
+};
+
+void SM510_Lockstep::op_rtn1(){
+    op_rtn0();
+    for(uint8_t i = 0; i < nb_lane; i++){ if(mask[i]){ skip_instruction_lane(i); } } // each lane at its return
+};
+
+void SM510_Lockstep::op_tl(){
+    uint8_t param = get_parameter_of_opcode(false);
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        pc_col[i] = select(mask[i], (param & 0xC0) >> 6, pc_col[i]);
+        pc_line[i] = select(mask[i], curr_opcode & 0x0F, pc_line[i]);
+        pc_word[i] = select(mask[i], param & 0x3F, pc_word[i]);
+    }
+};
+
+void SM510_Lockstep::op_tml(){
+    uint8_t param = get_parameter_of_opcode();
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        r_col[i] = select(mask[i], s_col[i], r_col[i]);
+        r_line[i] = select(mask[i], s_line[i], r_line[i]);
+        r_word[i] = select(mask[i], s_word[i], r_word[i]);
+        s_col[i] = select(mask[i], pc_col[i], s_col[i]);
+        s_line[i] = select(mask[i], pc_line[i], s_line[i]);
+        s_word[i] = select(mask[i], pc_word[i], s_word[i]);
+        pc_col[i] = select(mask[i], (param & 0xC0) >> 6, pc_col[i]);
+        pc_line[i] = select(mask[i], curr_opcode & 0x03, pc_line[i]);
+        pc_word[i] = select(mask[i], param & 0x3F, pc_word[i]);
+    }
+};
+
+void SM510_Lockstep::op_tm(){
+    // address of """subroutine""" at begin of rom : same for all lanes
+    uint8_t param = read_rom(0x00, 0x00, curr_opcode & 0x3F);
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        r_col[i] = select(mask[i], s_col[i], r_col[i]);
+        r_line[i] = select(mask[i], s_line[i], r_line[i]);
+        r_word[i] = select(mask[i], s_word[i], r_word[i]);
+        s_col[i] = select(mask[i], pc_col[i], s_col[i]);
+        s_line[i] = select(mask[i], pc_line[i], s_line[i]);
+        s_word[i] = select(mask[i], pc_word[i], s_word[i]);
+        pc_col[i] = select(mask[i], (param & 0xC0) >> 6, pc_col[i]);
+        pc_line[i] = select(mask[i], 0x04, pc_line[i]);
+        pc_word[i] = select(mask[i], param & 0x3F, pc_word[i]);
+        cycle_curr_opcode[i] += mask[i] ? 2 : 0; // because read rom
+    }
+};
+
+void SM510_Lockstep::op_t(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ pc_word[i] = select(mask[i], curr_opcode & 0x3F, pc_word[i]); }
+};
+
+// ----- RAM adress
+void SM510_Lockstep::op_lb(){
+    uint8_t line = ((curr_opcode & 0x0C) >> 2);
+    if((curr_opcode & 0x0C) != 0x00){ line = 0x0C | line; }
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        ram_col[i] = select(mask[i], (ram_col[i] & 0x0C) | (curr_opcode & 0x03), ram_col[i]);
+        ram_line[i] = select(mask[i], line, ram_line[i]);
+    }
+};
+
+void SM510_Lockstep::op_sbm(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ alternativ_col_ram[i] = select(mask[i], ram_col[i] | 0x04, alternativ_col_ram[i]); }
+};
+
+void SM510_Lockstep::op_incb(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        bool last = (ram_line[i] == SM510_RAM_LINE-1);
+        skip[i] = mask[i] & (last ? LANE_ON : 0x00);
+        ram_line[i] = select(mask[i], last ? 0 : ram_line[i] + 1, ram_line[i]);
+    }
+    skip_instruction(skip);
+};
+
+void SM510_Lockstep::op_decb(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        bool first = (ram_line[i] == 0);
+        skip[i] = mask[i] & (first ? LANE_ON : 0x00);
+        ram_line[i] = select(mask[i], first ? SM510_RAM_LINE-1 : ram_line[i] - 1, ram_line[i]);
+    }
+    skip_instruction(skip);
+};
+
+// ----- Data transfert
+void SM510_Lockstep::op_bdc(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ bc_lcd_stop[i] = select(mask[i], carry[i], bc_lcd_stop[i]); }
+};
+
+void SM510_Lockstep::op_exci(){
+    g_op_exc();
+    op_incb();
+};
+
+void SM510_Lockstep::op_excd(){
+    g_op_exc();
+    op_decb();
+};
+
+void SM510_Lockstep::op_wr(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ w_shift_register[i] = select(mask[i], w_shift_register[i] << 1, w_shift_register[i]); }
+};
+void SM510_Lockstep::op_ws(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ w_shift_register[i] = select(mask[i], (w_shift_register[i] << 1) | 0x01, w_shift_register[i]); }
+};
+
+// ----- input - output instructions
+void SM510_Lockstep::op_kta(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t value = 0x00;
+        for(int k = 0; k < 8; k++){ // multiplexage by S
+            value |= k_input[k][i] & (((w_shift_register[i] >> k) & 0x01) ? 0xFF : 0x00);
+        }
+        accumulator[i] = select(mask[i], value, accumulator[i]);
+    }
+};
+
+void SM510_Lockstep::op_atbp(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ bp_lcd_blackplate[i] = select(mask[i], accumulator[i] & 0x01, bp_lcd_blackplate[i]); }
+};
+void SM510_Lockstep::op_atl(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ l_bs[i] = select(mask[i], accumulator[i], l_bs[i]); }
+};
+void SM510_Lockstep::op_atfc(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ y_bs[i] = select(mask[i], accumulator[i], y_bs[i]); }
+};
+void SM510_Lockstep::op_atr(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ r_buzzer_control[i] = select(mask[i], accumulator[i] & 0x03, r_buzzer_control[i]); }
+};
+
+// ----- Arithmetic
+void SM510_Lockstep::op_rot(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t tmp = accumulator[i] & 0x01;
+        accumulator[i] = select(mask[i], (accumulator[i] >> 1) | (carry[i] << 3), accumulator[i]);
+        carry[i] = select(mask[i], tmp, carry[i]);
+    }
+};
+
+// ----- Test -> if, ...
+void SM510_Lockstep::op_tf1(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ skip[i] = mask[i] & (((f_clock_divider[i] >> 14) & 0x01) ? LANE_ON : 0x00); }
+    skip_instruction(skip);
+};
+
+void SM510_Lockstep::op_tf4(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ skip[i] = mask[i] & (((f_clock_divider[i] >> 11) & 0x01) ? LANE_ON : 0x00); }
+    skip_instruction(skip);
+};
+
+// ----- other
+void SM510_Lockstep::op_skip(){};
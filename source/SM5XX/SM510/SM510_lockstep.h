@@ -0,0 +1,98 @@
+#pragma once
+#include "SM5XX/SM510/SM510.h"
+#include "SM5XX/SM5XX_lockstep.h"
+
+
+// Lanes of SM510 in lockstep (see SM5XX_lockstep.h) : variables of SM510.h, 1 per lane
+
+class SM510_Lockstep final : public SM5XX_Lockstep<SM510_Lockstep, SM510> {
+    friend class SM5XX_Lockstep<SM510_Lockstep, SM510>; // loop call function of SM510_Lockstep without virtual
+
+private :
+    uint8_t r_col[LOCKSTEP_NB_LANE], r_line[LOCKSTEP_NB_LANE], r_word[LOCKSTEP_NB_LANE]; // second buffer of program counter
+    uint8_t w_shift_register[LOCKSTEP_NB_LANE];
+    uint8_t r_buzzer_control[LOCKSTEP_NB_LANE];
+    uint8_t r_buzzer_output[LOCKSTEP_NB_LANE];
+    uint8_t bc_lcd_stop[LOCKSTEP_NB_LANE];
+    uint8_t l_bs[LOCKSTEP_NB_LANE];
+    uint8_t y_bs[LOCKSTEP_NB_LANE];
+    uint8_t alternativ_col_ram[LOCKSTEP_NB_LANE];
+    uint8_t segment_on[SM510_RAM_VIDEO_COL+1][SM510_RAM_LINE][LOCKSTEP_NB_LANE];
+
+/// ##### FUNCTION ################################################# ///
+private :
+    void load_lane(uint8_t lane, const SM510& cpu);
+    void store_lane_cpu(uint8_t lane, SM510& cpu);
+    bool get_segments_state_lane(uint8_t lane, uint8_t col, uint8_t line, uint8_t word);
+
+    void execute_opcode(Lane_Handler instruction){
+        (this->*instruction)();
+
+        // 0x02 = SBM : col ram changed only for next instruction
+        if(curr_opcode != 0x02){
+            for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ alternativ_col_ram[i] = select(mask[i], 0x00, alternativ_col_ram[i]); }
+        }
+    }
+
+    bool condition_to_update_segment(uint8_t lane){
+        uint8_t value = ((f_clock_divider[lane] >> 9) & 0x01);
+        if(value != flag_time_update_screen[lane]){
+            flag_time_update_screen[lane] = value;
+            return true;
+        }
+        return false;
+    }
+    void update_segment(uint8_t lane);
+    void wake_up(uint8_t lane);
+
+    uint8_t ram_cell(uint8_t lane){ // same as read_ram_value of SM510
+        uint8_t col = (alternativ_col_ram[lane] != 0x00) ? alternativ_col_ram[lane] : ram_col[lane];
+        col = min(col, SM510_RAM_COL-1);
+        uint8_t line = min(ram_line[lane], SM510_RAM_LINE-1);
+        return col * SM510_RAM_LINE + line;
+    }
+
+    static const Lane_Instruction<SM510_Lockstep>* get_lane_instructions(uint8_t& nb_instruction);
+
+    // -- from SM510_lockstep.cpp ------------------------------ //
+    // same as SM510_instruction.cpp
+
+    // ROM adress
+    void op_atpl();
+    void op_rtn0();
+    void op_rtn1();
+    void op_tl();
+    void op_tml();
+    void op_tm();
+    void op_t();
+
+    // RAM adress
+    void op_lb();
+    void op_sbm();
+    void op_incb();
+    void op_decb();
+
+    // Data transfert
+    void op_bdc();
+    void op_exci();
+    void op_excd();
+    void op_wr();
+    void op_ws();
+
+    // input - output instructions
+    void op_kta();
+    void op_atbp();
+    void op_atl();
+    void op_atfc();
+    void op_atr();
+
+    // Arithmetic
+    void op_rot();
+
+    // Test -> if, ...
+    void op_tf1();
+    void op_tf4();
+
+    // other
+    void op_skip();
+};
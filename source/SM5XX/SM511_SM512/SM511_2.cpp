@@ -1,5 +1,4 @@
 #include "SM5XX/SM511_SM512/SM511_2.h"
-#include "SM5XX/SM511_SM512/sm511_2.h"
 #include "std/timer.h"
 #include <cstring>
 
@@ -7,6 +6,8 @@
 
 void SM511_2::init()
 {
+    decode_table = get_decode_table();
+
     program_counter = {3, 7, 0}; // Doc Sharp
     s_buffer_program_counter = {0, 0, 0};
     r_buffer_program_counter = {0, 0, 0};
@@ -17,6 +18,7 @@ void SM511_2::init()
 
     for(int i = 0; i < 8; i++){ k_input[i] = 0x00; }
     w_shift_register = 0;
+    s_pin = 0;
 
     beta_input = true;
     alpha_input = true;
@@ -37,6 +39,7 @@ void SM511_2::init()
     bc_lcd_stop = false;
 
     l_bs = 0x00;
+    x_bs = 0x00;
     y_bs = 0x00; 
 
     is_sleep = false;
@@ -44,10 +47,12 @@ void SM511_2::init()
     segments_state_are_update = false;
     alternativ_col_ram = 0x00; // used for sbm -> change temporaly value of ram col adresse
     cycle_curr_opcode = 0;
+    cycle_count = 0;
 
     for(int line = 0; line < SM511_2_RAM_LINE;line++){
         for(int col = 0; col < SM511_2_RAM_VIDEO_COL+1; col++){ segment_on[col][line] = 0x00; }
     }
+    pack_segments();
     flag_time_update_screen = 0x00;
 
     cpu_frequency_divider = 2; //4*8.192kHz = 2*16.384kHz -> 32.768kHz (true frequency of CPU)
@@ -81,6 +86,50 @@ bool SM511_2::is_on_double_octet(uint8_t opcode){
     ;
 }
 
+uint8_t SM511_2::block_kind(uint8_t opcode){
+    // T, ATPL, RTN, TL, TML, LBL and PRE are already end of block (build_decode_table)
+    if( (opcode == 0x5D) // CEND -> sleep
+        | (opcode == 0x60) // extended -> melody, frequency of cpu, ...
+        | (opcode == 0x65) // IDIV -> clock divider
+    ){ return BLOCK_BARRIER; }
+
+    if( ((opcode & 0xC0) == 0xC0) // TM
+        | ((opcode & 0xE0) == 0x20) // LAX (skip next LAX), ADX
+        | ((opcode & 0xF4) == 0x14) // EXCI, EXCD
+        | ((opcode & 0xFC) == 0x54) // TMI
+        | (opcode == 0x09) // ADD11
+        | ((opcode & 0xFC) == 0x50) // KTA, TB, TC, TAM
+        | (opcode == 0x58) | (opcode == 0x5A) | (opcode == 0x5B) | (opcode == 0x5E) // TIS, TA0, TABL, TA
+        | ((opcode & 0xF7) == 0x64) // INCB, DECB
+    ){ return BLOCK_END; }
+    return BLOCK_NEXT;
+}
+
+const Opcode_Decode* SM511_2::get_decode_table(){
+    static const Decode_Table table = build_decode_table(decode_opcode, no_pc_increase, is_on_double_octet, block_kind);
+    return table.entry;
+}
+
+const Fused_Pair<SM511_2>* SM511_2::get_fused_pairs(uint8_t& nb_pair){
+    // set ram adress then use it, test then jump (see CONVERT_ROM/utils/fused_pair_report.py)
+    static const Fused_Pair<SM511_2> pairs[] = {
+        { opcode_handler(&SM511_2::op_lb), opcode_handler(&SM511_2::g_op_exc), &run_fused_pair<&SM511_2::op_lb, &SM511_2::g_op_exc>, "LB+EXC" },
+        { opcode_handler(&SM511_2::op_lb), opcode_handler(&SM511_2::op_exci), &run_fused_pair<&SM511_2::op_lb, &SM511_2::op_exci>, "LB+EXCI" },
+        { opcode_handler(&SM511_2::op_lb), opcode_handler(&SM511_2::op_excd), &run_fused_pair<&SM511_2::op_lb, &SM511_2::op_excd>, "LB+EXCD" },
+        { opcode_handler(&SM511_2::op_lb), opcode_handler(&SM511_2::g_op_lda), &run_fused_pair<&SM511_2::op_lb, &SM511_2::g_op_lda>, "LB+LDA" },
+        { opcode_handler(&SM511_2::g_op_lbl), opcode_handler(&SM511_2::g_op_exc), &run_fused_pair<&SM511_2::g_op_lbl, &SM511_2::g_op_exc>, "LBL+EXC" },
+        { opcode_handler(&SM511_2::g_op_lbl), opcode_handler(&SM511_2::op_exci), &run_fused_pair<&SM511_2::g_op_lbl, &SM511_2::op_exci>, "LBL+EXCI" },
+        { opcode_handler(&SM511_2::g_op_lbl), opcode_handler(&SM511_2::g_op_lda), &run_fused_pair<&SM511_2::g_op_lbl, &SM511_2::g_op_lda>, "LBL+LDA" },
+        { opcode_handler(&SM511_2::g_op_tam), opcode_handler(&SM511_2::op_t), &run_fused_pair<&SM511_2::g_op_tam, &SM511_2::op_t>, "TAM+T" },
+        { opcode_handler(&SM511_2::g_op_tc), opcode_handler(&SM511_2::op_t), &run_fused_pair<&SM511_2::g_op_tc, &SM511_2::op_t>, "TC+T" },
+        { opcode_handler(&SM511_2::g_op_ta0), opcode_handler(&SM511_2::op_t), &run_fused_pair<&SM511_2::g_op_ta0, &SM511_2::op_t>, "TA0+T" },
+        { opcode_handler(&SM511_2::g_op_tis), opcode_handler(&SM511_2::op_t), &run_fused_pair<&SM511_2::g_op_tis, &SM511_2::op_t>, "TIS+T" },
+    };
+    static_assert(sizeof(pairs) / sizeof(pairs[0]) <= MAX_FUSED_PAIR, "too many fused pairs");
+    nb_pair = sizeof(pairs) / sizeof(pairs[0]);
+    return pairs;
+}
+
 
 /////////////////////////// RAM / ROM MANIPULATION //////////////////////////////////////////////////////
 
@@ -94,6 +143,7 @@ void SM511_2::load_rom(const uint8_t* file_hex, size_t){
             }
         }
     }
+    clear_block_cache();
 }
 
 void SM511_2::load_rom_melody(const uint8_t* file_hex, size_t){
@@ -101,31 +151,11 @@ void SM511_2::load_rom_melody(const uint8_t* file_hex, size_t){
 }
 
 // Read / write data -> from rom or ram
-uint8_t SM511_2::read_rom_value(){
-    return rom[program_counter.col][program_counter.line][program_counter.word];
-}
+
 uint8_t SM511_2::read_rom_melody_value(){
     return rom_melody[rom_melody_address];
 }
 
-uint8_t SM511_2::read_ram_value(){
-    uint8_t col = ram_address.col;
-    if(alternativ_col_ram != 0x00){ col = alternativ_col_ram;} // x[1] bit are upper -> active
-
-    col = min(col, SM511_2_RAM_COL-1); // copy of max value if col and line too big
-    uint8_t line = min(ram_address.line, SM511_2_RAM_LINE-1);
-    return ram[col][line];
-}
-
-void SM511_2::write_ram_value(uint8_t value){
-    uint8_t col = ram_address.col;
-    if(alternativ_col_ram != 0x00){ col = alternativ_col_ram;} // x[1] bit are upper -> active
-
-    col = min(col, SM511_2_RAM_COL-1); // copy of max value if col and line too big
-    uint8_t line = min(ram_address.line, SM511_2_RAM_LINE-1);
-    ram[col][line] = value & 0x0F; // 4 bit RAM
-}
-
 void SM511_2::set_ram_value(uint8_t col, uint8_t line, uint8_t value) {
     if (col >= SM511_2_RAM_COL || line >= SM511_2_RAM_LINE) 
         return;
@@ -142,18 +172,31 @@ void SM511_2::wake_up(){
 }
 
 
-/////////////////////////// Segment / screen //////////////////////////////////////////////////////
-
-bool SM511_2::condition_to_update_segment(){
-    uint16_t value = ((f_clock_divider >> 9) & 0x01);
-    if( value != flag_time_update_screen)
-    { // simplify version for perf
-        flag_time_update_screen = value;
-        return true;
-    }
-    return false;
+/////////////////////////// Busy-wait loop //////////////////////////////////////////////////////
+
+void SM511_2::add_busy_loop_state(Busy_Loop_State& state){
+    state.add(ram);
+    state.add(r_buffer_program_counter);
+    state.add(rom_melody_address);
+    state.add(w_shift_register);
+    state.add(s_pin);
+    state.add(bc_lcd_stop);
+    state.add(l_bs);
+    state.add(x_bs);
+    state.add(y_bs);
+    state.add(alternativ_col_ram);
+    state.add(me_melody_activate);
+    state.add(mes_melody_finish);
+    state.add(melody_cycle_count);
+    state.add(nb_cycle_need_for_change_note);
+    state.add(curr_note_melody);
+    state.add(curr_phase);
+    state.add(cycle_in_curr_phase);
 }
 
+
+/////////////////////////// Segment / screen //////////////////////////////////////////////////////
+
 bool SM511_2::screen_is_on() { return (!bc_lcd_stop) && bp_lcd_blackplate; }
 
 void SM511_2::update_segment(){
@@ -176,6 +219,7 @@ void SM511_2::update_segment(){
             else { segment_on[col][line] = ram[ram_col][line];} 
         }
     }
+    pack_segments();
     segments_state_are_update  = true;
 }
 
@@ -213,24 +257,27 @@ void SM511_2::load_new_note(uint8_t* update_melody_adress){
 }
 
 
+// cycles of each phase of note : constant shared by all instances (no state in update_sound)
+constexpr uint8_t NOTE_FREQUENCY_CONTROL[4*12]{ // Doc Sharp SM511 + MAME
+    7,  8,  8,  8 // do
+    , 8,  8,  8,  8 // si
+    , 8,  9,  9,  9 // la #
+    , 9,  9,  9, 10 // la
+    , 9, 10, 10, 10 // so #
+    ,10, 11, 10, 11 // so
+    ,11, 11, 11, 11 // fa #
+    ,11, 12, 12, 12 // fa
+    ,12, 13, 12, 13 // mi
+    ,13, 13, 13, 14 // re #
+    ,14, 14, 14, 14 // re
+    ,14, 15, 15, 15 // do #
+};
+
+
 void SM511_2::update_sound(){ // NOT FINISH
     if(!me_melody_activate){ return; }
     
     // execute of each cyle
-    static const uint8_t note_frequency_control[4*12]{ // Doc Sharp SM511 + MAME
-            7,  8,  8,  8 // do
-            , 8,  8,  8,  8 // si
-            , 8,  9,  9,  9 // la #
-            , 9,  9,  9, 10 // la
-            , 9, 10, 10, 10 // so #
-            ,10, 11, 10, 11 // so
-            ,11, 11, 11, 11 // fa #
-            ,11, 12, 12, 12 // fa
-            ,12, 13, 12, 13 // mi
-            ,13, 13, 13, 14 // re #
-            ,14, 14, 14, 14 // re
-            ,14, 15, 15, 15 // do #
-        };
 /*
     static const uint32_t output_sound_frequency[4*12]{
             2114, 1986, 1872, 1771, 1680, 1560, 1490, 1394, 1311, 1236, 1170, 1111 };
@@ -251,7 +298,7 @@ void SM511_2::update_sound(){ // NOT FINISH
     { 
         //sound_frequency = output_sound_frequency[curr_note_melody.note-2];
         int ind_note_freq = (curr_note_melody.note-2)*4 + curr_phase;
-        if( cycle_in_curr_phase >= (note_frequency_control[ind_note_freq] * (curr_note_melody.octave? 2: 1))){
+        if( cycle_in_curr_phase >= (NOTE_FREQUENCY_CONTROL[ind_note_freq] * (curr_note_melody.octave? 2: 1))){
             cycle_in_curr_phase = 0;
             curr_phase = (curr_phase+1) & 0x03;
         }
@@ -268,12 +315,6 @@ void SM511_2::update_sound(){ // NOT FINISH
     }
 }
 
-
-bool SM511_2::get_active_sound(){
-    return me_melody_activate && ((curr_phase&0x01) == 0x01); // phase impair -> Activate buzzer
-}
-
-
 /////////////////////////// Debug //////////////////////////////////////////////////////
 uint8_t SM511_2::debug_get_elem_ram(int col, int line) { 
     uint8_t col_ = min(col, SM511_2_RAM_COL-1); // copy of max value if col and line too big
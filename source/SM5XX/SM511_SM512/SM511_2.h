@@ -2,7 +2,7 @@
 //#include <vector> declared in SM5xx.h
 #include <cstdint>
 #include <string>
-#include "SM5XX/SM5XX.h"
+#include "SM5XX/SM5XX_core.h"
 
 
 constexpr uint8_t SM511_2_RAM_COL = 8;
@@ -30,10 +30,12 @@ struct Note_Melody {
 };
 
 
-class SM511_2: public SM5XX 
+class SM511_2 final : public SM5XXCore<SM511_2>
 {
+    friend class SM5XXCore<SM511_2>; // loop of cpu call function of SM511_2 without virtual
+    template <class, uint32_t> friend struct Translated_Rom; // rom translated in C++ call instructions
 public : 
-    SM511_2() : SM5XX("SM511_SM512\0") {}
+    SM511_2() : SM5XXCore<SM511_2>("SM511_SM512\0") {}
 
 public:
     void init() override;
@@ -42,12 +44,15 @@ public:
 
     bool screen_is_on() override;
     bool get_segments_state(uint8_t col, uint8_t line, uint8_t word) override;
-    bool get_active_sound() override;
+    bool get_active_sound() override {
+        return me_melody_activate && ((curr_phase&0x01) == 0x01); // phase impair -> Activate buzzer
+    }
 
     // Save/Load state
     bool save_state(FILE* file) override;
     bool load_state(FILE* file) override;
     uint8_t get_cpu_type_id() override { return 2; } // CPU_TYPE_SM511_2
+    static constexpr Segment_Layout SEGMENT_LAYOUT = { SM511_2_RAM_VIDEO_COL+1, SM511_2_RAM_LINE, 4 }; // segment_bits
 
 private:
     /// Variables / register /// 
@@ -58,7 +63,7 @@ private:
 
     ProgramCounter r_buffer_program_counter;  // second buffer of program counter (buffer of S buffer)
     
-    uint8_t rom_melody[256];
+    uint8_t rom_melody[256] = {}; // read by init() (first note) before load_rom_melody
     uint8_t rom_melody_address; 
 
     // input
@@ -88,18 +93,59 @@ private:
     void update_segment() override;
     void update_sound() override;
 
-    bool no_pc_increase(uint8_t opcode) override;
-    bool is_on_double_octet(uint8_t opcode) override;
-
     void execute_curr_opcode() override;
-
-    bool condition_to_update_segment() override;
+    template <class Instruction> // handler of decode table, or instruction known at compile time (translated rom)
+    void execute_opcode(Instruction instruction){
+        (this->*instruction)();
+
+        // 0x02 = SBM instruction use for temporaly change col ram (only for next instruction)
+        if( (alternativ_col_ram != 0x00) && (curr_opcode != 0x02) ){ 
+            alternativ_col_ram = 0x00;
+        }
+    }
+
+    bool condition_to_update_segment() override {
+        uint16_t value = ((f_clock_divider >> 9) & 0x01);
+        if( value != flag_time_update_screen)
+        { // simplify version for perf
+            flag_time_update_screen = value;
+            return true;
+        }
+        return false;
+    }
 
     void wake_up() override;
-
-    uint8_t read_rom_value() override;
-    uint8_t read_ram_value() override;
-    void write_ram_value(uint8_t value) override;
+    void add_busy_loop_state(Busy_Loop_State& state); // all variables can change in a loop
+    static constexpr auto state_members(){ // snapshot / restore (rom and melody rom not included)
+        return std::make_tuple(&SM511_2::ram, &SM511_2::segment_on, &SM511_2::r_buffer_program_counter
+                                , &SM511_2::rom_melody_address, &SM511_2::w_shift_register, &SM511_2::s_pin, &SM511_2::bc_lcd_stop
+                                , &SM511_2::l_bs, &SM511_2::x_bs, &SM511_2::y_bs, &SM511_2::alternativ_col_ram
+                                , &SM511_2::me_melody_activate, &SM511_2::mes_melody_finish, &SM511_2::melody_cycle_count
+                                , &SM511_2::nb_cycle_need_for_change_note, &SM511_2::curr_note_melody
+                                , &SM511_2::curr_phase, &SM511_2::cycle_in_curr_phase);
+    }
+
+    bool sound_is_static(){ return !me_melody_activate; } // melody run each cycle
+
+    uint8_t read_rom_value() override {
+        return rom[program_counter.col][program_counter.line][program_counter.word];
+    }
+    uint8_t read_ram_value() override {
+        uint8_t col = ram_address.col;
+        if(alternativ_col_ram != 0x00){ col = alternativ_col_ram;} // x[1] bit are upper -> active
+
+        col = min(col, SM511_2_RAM_COL-1); // copy of max value if col and line too big
+        uint8_t line = min(ram_address.line, SM511_2_RAM_LINE-1);
+        return ram[col][line];
+    }
+    void write_ram_value(uint8_t value) override {
+        uint8_t col = ram_address.col;
+        if(alternativ_col_ram != 0x00){ col = alternativ_col_ram;} // x[1] bit are upper -> active
+
+        col = min(col, SM511_2_RAM_COL-1); // copy of max value if col and line too big
+        uint8_t line = min(ram_address.line, SM511_2_RAM_LINE-1);
+        ram[col][line] = value & 0x0F; // 4 bit RAM
+    }
     void set_ram_value(uint8_t col, uint8_t line, uint8_t value) override;
 
 private:
@@ -108,6 +154,14 @@ private:
     uint8_t read_rom_melody_value();
     void load_new_note(uint8_t* update_melody_adress = nullptr);
 
+    // decode table -> built one time, shared by each SM511/SM512
+    static const Opcode_Decode* get_decode_table();
+    static Opcode_Handler decode_opcode(uint8_t opcode); // switch case op_code function with hexa op_code value
+    static bool no_pc_increase(uint8_t opcode); // say opcode with not increase PC
+    static bool is_on_double_octet(uint8_t opcode); // need for instruction on 2 octet -> skip 2 octet
+    static uint8_t block_kind(uint8_t opcode); // opcode can skip next one or never in basic block (block cache)
+    static const Fused_Pair<SM511_2>* get_fused_pairs(uint8_t& nb_pair); // opcodes often together (block cache)
+
     // -- from SM511_2_instruction.cpp ------------------------------ //
     // Opcode -> instruction of processor
 
@@ -155,6 +209,7 @@ private:
     // other
     void op_clklo(); // change frequency of cpu -> low = 8.192kHz
     void op_clkhi(); // change frequency of cpu -> medium = 16.384kHz
+    void op_extended(); // 0x60 -> melody, lcd and clock instructions with parameter
 
 
 
@@ -170,3 +225,5 @@ public : // debug
     uint8_t debug_multiplexage() { return w_shift_register; }
 
 };
+
+extern template class SM5XXCore<SM511_2>; // instantiate in SM511_2_instruction.cpp
@@ -1,95 +1,98 @@
-#include "SM5XX/SM511_SM512/sm511_2.h"
+#include "SM5XX/SM511_SM512/SM511_2.h"
 
-void SM511_2::execute_curr_opcode() {
-	switch (curr_opcode & 0xf0)
+// loop of cpu and g_op_xxx for SM511_2 (see SM5XX_core.h) -> compiled here with op_xxx
+template class SM5XXCore<SM511_2>;
+
+Opcode_Handler SM511_2::decode_opcode(uint8_t opcode) {
+	switch (opcode & 0xf0)
 	{
-		case 0x20: g_op_lax(); break;
-		case 0x30: g_op_adx(); break;
-		case 0x40: op_lb(); break;
-		case 0x70: op_tl(); break;
+		case 0x20: return opcode_handler(&SM511_2::g_op_lax);
+		case 0x30: return opcode_handler(&SM511_2::g_op_adx);
+		case 0x40: return opcode_handler(&SM511_2::op_lb);
+		case 0x70: return opcode_handler(&SM511_2::op_tl);
 
 		case 0x80: case 0x90: case 0xa0: case 0xb0: // 10xx xxxx
-			op_t(); break;
+			return opcode_handler(&SM511_2::op_t);
 		case 0xc0: case 0xd0: case 0xe0: case 0xf0: // 11xx xxxx
-			op_tm(); break;
+			return opcode_handler(&SM511_2::op_tm);
 
 		default:
-			switch (curr_opcode & 0xfc)
+			switch (opcode & 0xfc)
 			{
-                case 0x04: g_op_rm(); break;
-                case 0x0c: g_op_sm(); break;
-                case 0x10: g_op_exc(); break;
-                case 0x14: op_exci(); break;
-                case 0x18: g_op_lda(); break;
-                case 0x1c: op_excd(); break;
-                case 0x54:  g_op_tmi(); break;
-                case 0x68: op_tml(); break;
+                case 0x04: return opcode_handler(&SM511_2::g_op_rm);
+                case 0x0c: return opcode_handler(&SM511_2::g_op_sm);
+                case 0x10: return opcode_handler(&SM511_2::g_op_exc);
+                case 0x14: return opcode_handler(&SM511_2::op_exci);
+                case 0x18: return opcode_handler(&SM511_2::g_op_lda);
+                case 0x1c: return opcode_handler(&SM511_2::op_excd);
+                case 0x54: return opcode_handler(&SM511_2::g_op_tmi);
+                case 0x68: return opcode_handler(&SM511_2::op_tml);
 
                 default:
-                    switch (curr_opcode)
+                    switch (opcode)
                     {
-                        case 0x00: op_rot(); break;
-                        case 0x01: op_dta(); break;
-                        case 0x02: op_sbm(); break;
-                        case 0x03: op_atpl(); break;
-                        case 0x08: g_op_add(); break;
-                        case 0x09: g_op_add11(); break;
-                        case 0x0a: g_op_coma(); break;
-                        case 0x0b: g_op_exbla(); break;
-
-                        case 0x50: op_kta(); break;
-                        case 0x51: g_op_tb(); break;
-                        case 0x52: g_op_tc(); break;
-                        case 0x53: g_op_tam(); break;
-                        case 0x58: g_op_tis(); break;
-                        case 0x59: op_atl(); break;
-                        case 0x5a: g_op_ta0(); break;
-                        case 0x5b: g_op_tabl(); break;
-                        case 0x5c: op_atx(); break;
-                        case 0x5d: g_op_cend(); break;
-                        case 0x5e: g_op_ta(); break;
-                        case 0x5f: g_op_lbl(); break;
-
-                        case 0x61: op_pre(); break;
-                        case 0x62: op_wr(); break;
-                        case 0x63: op_ws(); break;
-                        case 0x64: op_incb(); break;
-                        case 0x65: g_op_idiv(); break;
-                        case 0x66: g_op_rc(); break;
-                        case 0x67: g_op_sc(); break;
-                        case 0x6c: op_decb(); break;
-                        case 0x6d: op_ptw(); break;
-                        case 0x6e: op_rtn0(); break;
-                        case 0x6f: op_rtn1(); break;
-
-                        // extended opcodes
-                        case 0x60:
-                            curr_opcode = get_parameter_of_opcode();
-                            debug_curr_opcode = (debug_curr_opcode<<8) | curr_opcode;
-                            switch (curr_opcode)
-                            {
-                                case 0x30: op_rme(); break;
-                                case 0x31: op_sme(); break;
-                                case 0x32: op_tmel(); break;
-                                case 0x33: op_atfc(); break;
-                                case 0x34: op_bdc(); break;
-                                case 0x35: op_atbp(); break;
-                                case 0x36: op_clkhi(); break;
-                                case 0x37: op_clklo(); break;
-
-                                default: g_op_illegal(); break;
-                            }
-                            break; // 0x60
-                        default: g_op_illegal(); break;
+                        case 0x00: return opcode_handler(&SM511_2::op_rot);
+                        case 0x01: return opcode_handler(&SM511_2::op_dta);
+                        case 0x02: return opcode_handler(&SM511_2::op_sbm);
+                        case 0x03: return opcode_handler(&SM511_2::op_atpl);
+                        case 0x08: return opcode_handler(&SM511_2::g_op_add);
+                        case 0x09: return opcode_handler(&SM511_2::g_op_add11);
+                        case 0x0a: return opcode_handler(&SM511_2::g_op_coma);
+                        case 0x0b: return opcode_handler(&SM511_2::g_op_exbla);
+
+                        case 0x50: return opcode_handler(&SM511_2::op_kta);
+                        case 0x51: return opcode_handler(&SM511_2::g_op_tb);
+                        case 0x52: return opcode_handler(&SM511_2::g_op_tc);
+                        case 0x53: return opcode_handler(&SM511_2::g_op_tam);
+                        case 0x58: return opcode_handler(&SM511_2::g_op_tis);
+                        case 0x59: return opcode_handler(&SM511_2::op_atl);
+                        case 0x5a: return opcode_handler(&SM511_2::g_op_ta0);
+                        case 0x5b: return opcode_handler(&SM511_2::g_op_tabl);
+                        case 0x5c: return opcode_handler(&SM511_2::op_atx);
+                        case 0x5d: return opcode_handler(&SM511_2::g_op_cend);
+                        case 0x5e: return opcode_handler(&SM511_2::g_op_ta);
+                        case 0x5f: return opcode_handler(&SM511_2::g_op_lbl);
+
+                        case 0x60: return opcode_handler(&SM511_2::op_extended); // extended opcodes
+                        case 0x61: return opcode_handler(&SM511_2::op_pre);
+                        case 0x62: return opcode_handler(&SM511_2::op_wr);
+                        case 0x63: return opcode_handler(&SM511_2::op_ws);
+                        case 0x64: return opcode_handler(&SM511_2::op_incb);
+                        case 0x65: return opcode_handler(&SM511_2::g_op_idiv);
+                        case 0x66: return opcode_handler(&SM511_2::g_op_rc);
+                        case 0x67: return opcode_handler(&SM511_2::g_op_sc);
+                        case 0x6c: return opcode_handler(&SM511_2::op_decb);
+                        case 0x6d: return opcode_handler(&SM511_2::op_ptw);
+                        case 0x6e: return opcode_handler(&SM511_2::op_rtn0);
+                        case 0x6f: return opcode_handler(&SM511_2::op_rtn1);
+
+                        default: return opcode_handler(&SM511_2::g_op_illegal);
                     }
-                    break; // 0xff
             }
-            break; // 0xfc
-	} // 0xf0
+	}
+}
+
+
+void SM511_2::execute_curr_opcode() {
+    execute_opcode(decode_table[curr_opcode].handler);
+}
+
 
-    // 0x02 = SBM instruction use for temporaly change col ram (only for next instruction)
-    if( (alternativ_col_ram != 0x00) && (curr_opcode != 0x02) ){ 
-        alternativ_col_ram = 0x00;
+void SM511_2::op_extended(){ // 0x60 + parameter
+    curr_opcode = get_parameter_of_opcode();
+    debug_curr_opcode = (debug_curr_opcode<<8) | curr_opcode;
+    switch (curr_opcode)
+    {
+        case 0x30: op_rme(); break;
+        case 0x31: op_sme(); break;
+        case 0x32: op_tmel(); break;
+        case 0x33: op_atfc(); break;
+        case 0x34: op_bdc(); break;
+        case 0x35: op_atbp(); break;
+        case 0x36: op_clkhi(); break;
+        case 0x37: op_clklo(); break;
+
+        default: g_op_illegal(); break;
     }
 }
 
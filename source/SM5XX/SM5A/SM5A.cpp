@@ -1,11 +1,12 @@
 #include "SM5XX/SM5A/SM5A.h"
-#include "SM5XX/SM5A/sm5A.h"
 #include "std/timer.h"
 #include <cstring>
 
 
 void SM5A::init()
 {
+    decode_table = get_decode_table();
+
     program_counter = {0, 0x0F, 0}; // Doc Sharp
     s_buffer_program_counter = {0, 0, 0};
     cb_debordement_rom_program_counter = 0x00;
@@ -42,10 +43,12 @@ void SM5A::init()
 
     segments_state_are_update = false;
     cycle_curr_opcode = 0;
+    cycle_count = 0;
 
     for(int col = 0; col < SM5A_SEGMENT_COL; col++){
         for(int line = 0; line < SM5A_SEGMENT_LINE; line++){ segment_on[col][line] = 0x00; }
     }
+    pack_segments();
     flag_time_update_screen = 0x00;
     last_w_update = 0x00;
 
@@ -79,6 +82,52 @@ bool SM5A::is_on_double_octet(uint8_t opcode){
 }
 
 
+uint8_t SM5A::block_kind(uint8_t opcode){
+    // TR, RTN and 2 octets opcode are already end of block (build_decode_table)
+    if( (opcode == 0x01) // ATR -> sound
+        | (opcode == 0x5E) // extended -> cend, ...
+        | (opcode == 0x65) // IDIV -> clock divider
+    ){ return BLOCK_BARRIER; }
+
+    if( ((opcode & 0xC0) == 0xC0) // TRS
+        | ((opcode & 0xE0) == 0x20) // LAX (skip next LAX), ADX
+        | ((opcode & 0xF4) == 0x14) // EXCI, EXCD
+        | ((opcode & 0xFC) == 0x54) // TMI
+        | (opcode == 0x09) // ADD11
+        | ((opcode & 0xFC) == 0x50) // TA, TB, TC, TAM
+        | (opcode == 0x58) | (opcode == 0x5A) | (opcode == 0x5B) // TIS, TA0, TABL
+        | ((opcode & 0xF7) == 0x64) // INCB, DECB
+    ){ return BLOCK_END; }
+    return BLOCK_NEXT;
+}
+
+
+const Opcode_Decode* SM5A::get_decode_table(){
+    static const Decode_Table table = build_decode_table(decode_opcode, no_pc_increase, is_on_double_octet, block_kind);
+    return table.entry;
+}
+
+const Fused_Pair<SM5A>* SM5A::get_fused_pairs(uint8_t& nb_pair){
+    // set ram adress then use it, test then jump (see CONVERT_ROM/utils/fused_pair_report.py)
+    static const Fused_Pair<SM5A> pairs[] = {
+        { opcode_handler(&SM5A::op_lb), opcode_handler(&SM5A::g_op_exc), &run_fused_pair<&SM5A::op_lb, &SM5A::g_op_exc>, "LB+EXC" },
+        { opcode_handler(&SM5A::op_lb), opcode_handler(&SM5A::op_exci), &run_fused_pair<&SM5A::op_lb, &SM5A::op_exci>, "LB+EXCI" },
+        { opcode_handler(&SM5A::op_lb), opcode_handler(&SM5A::op_excd), &run_fused_pair<&SM5A::op_lb, &SM5A::op_excd>, "LB+EXCD" },
+        { opcode_handler(&SM5A::op_lb), opcode_handler(&SM5A::g_op_lda), &run_fused_pair<&SM5A::op_lb, &SM5A::g_op_lda>, "LB+LDA" },
+        { opcode_handler(&SM5A::g_op_lbl), opcode_handler(&SM5A::g_op_exc), &run_fused_pair<&SM5A::g_op_lbl, &SM5A::g_op_exc>, "LBL+EXC" },
+        { opcode_handler(&SM5A::g_op_lbl), opcode_handler(&SM5A::op_exci), &run_fused_pair<&SM5A::g_op_lbl, &SM5A::op_exci>, "LBL+EXCI" },
+        { opcode_handler(&SM5A::g_op_lbl), opcode_handler(&SM5A::g_op_lda), &run_fused_pair<&SM5A::g_op_lbl, &SM5A::g_op_lda>, "LBL+LDA" },
+        { opcode_handler(&SM5A::g_op_tam), opcode_handler(&SM5A::op_tr), &run_fused_pair<&SM5A::g_op_tam, &SM5A::op_tr>, "TAM+TR" },
+        { opcode_handler(&SM5A::g_op_tc), opcode_handler(&SM5A::op_tr), &run_fused_pair<&SM5A::g_op_tc, &SM5A::op_tr>, "TC+TR" },
+        { opcode_handler(&SM5A::g_op_ta0), opcode_handler(&SM5A::op_tr), &run_fused_pair<&SM5A::g_op_ta0, &SM5A::op_tr>, "TA0+TR" },
+        { opcode_handler(&SM5A::g_op_tis), opcode_handler(&SM5A::op_tr), &run_fused_pair<&SM5A::g_op_tis, &SM5A::op_tr>, "TIS+TR" },
+    };
+    static_assert(sizeof(pairs) / sizeof(pairs[0]) <= MAX_FUSED_PAIR, "too many fused pairs");
+    nb_pair = sizeof(pairs) / sizeof(pairs[0]);
+    return pairs;
+}
+
+
 /////////////////////////// RAM / ROM MANIPULATION //////////////////////////////////////////////////////
 
 void SM5A::load_rom(const uint8_t* file_hex, size_t size_hex){
@@ -91,25 +140,11 @@ void SM5A::load_rom(const uint8_t* file_hex, size_t size_hex){
             }
         }
     }
+    clear_block_cache();
 }
 
 
 // Read / write data -> from rom or ram
-uint8_t SM5A::read_rom_value(){
-    return rom[program_counter.col][program_counter.line][program_counter.word];
-}
-
-uint8_t SM5A::read_ram_value(){
-    uint8_t col = min(ram_address.col, SM5A_RAM_COL-1); // copy of max value if col and line too big
-    uint8_t line = min(ram_address.line, SM5A_RAM_LINE-1);
-    return ram[col][line];
-}
-
-void SM5A::write_ram_value(uint8_t value){
-    uint8_t col = min(ram_address.col, SM5A_RAM_COL-1); // copy of max value if col and line too big
-    uint8_t line = min(ram_address.line, SM5A_RAM_LINE-1);
-    ram[col][line] = (value & 0x0F);
-}
 
 void SM5A::set_ram_value(uint8_t col, uint8_t line, uint8_t value) {
     if (col >= SM5A_RAM_COL || line >= SM5A_RAM_LINE) 
@@ -129,20 +164,25 @@ void SM5A::wake_up(){
 }
 
 
-/////////////////////////// Segment / screen //////////////////////////////////////////////////////
-
-bool SM5A::condition_to_update_segment(){
-    if(last_w_update != 0){ last_w_update -= 1; } // not during maj w -> prevention of glitch
-    
-    uint16_t value = ((f_clock_divider >> 9) & 0x01);
-    if( (value != flag_time_update_screen) && last_w_update == 0)
-    { // simplify version for perf
-        flag_time_update_screen = value;
-        return true;
-    }
-    return false;
+/////////////////////////// Busy-wait loop //////////////////////////////////////////////////////
+
+void SM5A::add_busy_loop_state(Busy_Loop_State& state){
+    state.add(ram);
+    state.add(cb_debordement_rom_program_counter);
+    state.add(w_screen_control);
+    state.add(w_prime_screen_control);
+    state.add(w_size);
+    state.add(last_w_update);
+    state.add(cn_flag);
+    state.add(r_subroutine_flag);
+    state.add(e_temporar_flag);
+    state.add(r_output_control);
+    state.add(m_flag_segment_decoder);
 }
 
+
+/////////////////////////// Segment / screen //////////////////////////////////////////////////////
+
 bool SM5A::screen_is_on() { return bp_lcd_blackplate; }
 
 
@@ -156,6 +196,7 @@ void SM5A::update_segment(){
                                     | (((w_prime_screen_control[col]>>line)&0x01) << 1);
         }
     }
+    pack_segments();
     segments_state_are_update  = true;
 }
 
@@ -167,11 +208,6 @@ bool SM5A::get_segments_state(uint8_t col, uint8_t line, uint8_t word) {
 
 /////////////////////////// Sound //////////////////////////////////////////////////////
 
-bool SM5A::get_active_sound(){
-    return (r_output_control & 0x01) == 0x00;
-}
-
-
 /////////////////////////// Debug //////////////////////////////////////////////////////
 uint8_t SM5A::debug_get_elem_ram(int col, int line) { 
     uint8_t col_ = min(col, SM5A_RAM_COL-1); // copy of max value if col and line too big
@@ -2,7 +2,7 @@
 //#include <vector> declared in SM5xx.h
 #include <cstdint>
 #include <string>
-#include "SM5XX/SM5XX.h"
+#include "SM5XX/SM5XX_core.h"
 
 
 // protect glitching when screen update during population of W and W_prime register
@@ -24,14 +24,24 @@ constexpr uint8_t SM5A_SEGMENT_LINE = 4;
 constexpr uint8_t SM5A_SEGMENT_WORD = 2;
 // 2 word -> w or w' register == multiplex
 
+constexpr uint8_t SM5A_LUT_DIGITS[0x20] = // default digit segments PLA (PDTW, DTW)
+{
+	0xe, 0x0, 0xc, 0x8, 0x2, 0xa, 0xe, 0x2, 0xe, 0xa, 0x0, 0x0, 0x2, 0xa, 0x2, 0x2,
+	0xb, 0x9, 0x7, 0xf, 0xd, 0xe, 0xe, 0xb, 0xf, 0xf, 0x4, 0x0, 0xd, 0xe, 0x4, 0x0
+};
+
 //  constexpr int FREQUENCY_CPU = 32768; declared in SM5xx.h
 
 
-class SM5A: public SM5XX
+class SM5A final : public SM5XXCore<SM5A>
 {
+    friend class SM5XXCore<SM5A>; // loop of cpu call function of SM5A without virtual
+    template <class, uint32_t> friend struct Translated_Rom; // rom translated in C++ call instructions
+    template <class, class> friend class SM5XX_Lockstep; // lanes of lockstep copy variables of cpu
+    friend class SM5A_Lockstep;
 public : 
     SM5A() : 
-        SM5XX("SM5A\0") // +1 for bs output
+        SM5XXCore<SM5A>("SM5A\0") // +1 for bs output
         {}
 
 public:
@@ -40,12 +50,15 @@ public:
 
     bool screen_is_on() override;
     bool get_segments_state(uint8_t col, uint8_t line, uint8_t word) override;
-    bool get_active_sound() override;
+    bool get_active_sound() override {
+        return (r_output_control & 0x01) == 0x00;
+    }
     
     // Save/Load state
     bool save_state(FILE* file) override;
     bool load_state(FILE* file) override;
     uint8_t get_cpu_type_id() override { return 0; } // CPU_TYPE_SM5A
+    static constexpr Segment_Layout SEGMENT_LAYOUT = { SM5A_SEGMENT_COL, SM5A_SEGMENT_LINE, SM5A_SEGMENT_WORD }; // segment_bits
 
 private:
     /// Variables / register /// 
@@ -76,21 +89,69 @@ private:
 private:
     void update_segment() override;
 
-    bool no_pc_increase(uint8_t opcode) override;
-    bool is_on_double_octet(uint8_t opcode) override;
-
     void execute_curr_opcode() override;
-
-    bool condition_to_update_segment() override;
+    template <class Instruction> // handler of decode table, or instruction known at compile time (translated rom)
+    void execute_opcode(Instruction instruction){
+        bool ssr_exec = ((curr_opcode & 0xf0) == 0x70);
+
+        (this->*instruction)();
+
+        // 0x70-0x7F = SSRx instruction use for temporaly change e_flag (only for next instruction)
+        if( e_temporar_flag && (!ssr_exec) ){
+            e_temporar_flag = false;
+        }
+    }
+
+    bool condition_to_update_segment() override {
+        if(last_w_update != 0){ last_w_update -= 1; } // not during maj w -> prevention of glitch
+
+        uint16_t value = ((f_clock_divider >> 9) & 0x01);
+        if( (value != flag_time_update_screen) && last_w_update == 0)
+        { // simplify version for perf
+            flag_time_update_screen = value;
+            return true;
+        }
+        return false;
+    }
 
     void wake_up() override;
-
-    uint8_t read_rom_value() override;
-    uint8_t read_ram_value() override;
-    void write_ram_value(uint8_t value) override;
+    void add_busy_loop_state(Busy_Loop_State& state); // all variables can change in a loop
+    static constexpr auto state_members(){ // snapshot / restore (rom not included)
+        return std::make_tuple(&SM5A::ram, &SM5A::segment_on, &SM5A::cb_debordement_rom_program_counter
+                                , &SM5A::w_screen_control, &SM5A::w_prime_screen_control, &SM5A::last_w_update
+                                , &SM5A::cn_flag, &SM5A::r_subroutine_flag, &SM5A::e_temporar_flag
+                                , &SM5A::r_output_control, &SM5A::m_flag_segment_decoder);
+    }
+
+    void fast_forward_clock(uint32_t nb_cycle){ // no segments update before clock event, only wait end of glitch protection
+        f_clock_divider += nb_cycle;
+        last_w_update = (last_w_update > nb_cycle) ? (last_w_update - nb_cycle) : 0;
+    }
+
+    uint8_t read_rom_value() override {
+        return rom[program_counter.col][program_counter.line][program_counter.word];
+    }
+    uint8_t read_ram_value() override {
+        uint8_t col = min(ram_address.col, SM5A_RAM_COL-1); // copy of max value if col and line too big
+        uint8_t line = min(ram_address.line, SM5A_RAM_LINE-1);
+        return ram[col][line];
+    }
+    void write_ram_value(uint8_t value) override {
+        uint8_t col = min(ram_address.col, SM5A_RAM_COL-1); // copy of max value if col and line too big
+        uint8_t line = min(ram_address.line, SM5A_RAM_LINE-1);
+        ram[col][line] = (value & 0x0F);
+    }
     void set_ram_value(uint8_t col, uint8_t line, uint8_t value) override;
 
 private:
+    // decode table -> built one time, shared by each SM5A
+    static const Opcode_Decode* get_decode_table();
+    static Opcode_Handler decode_opcode(uint8_t opcode); // switch case op_code function with hexa op_code value
+    static bool no_pc_increase(uint8_t opcode); // say opcode with not increase PC
+    static bool is_on_double_octet(uint8_t opcode); // need for instruction on 2 octet -> skip 2 octet
+    static uint8_t block_kind(uint8_t opcode); // opcode can skip next one or never in basic block (block cache)
+    static const Fused_Pair<SM5A>* get_fused_pairs(uint8_t& nb_pair); // opcodes often together (block cache)
+
     // -- from SM5A_instruction.cpp ------------------------------ //
     // Opcode -> instruction of processor
 
@@ -134,6 +195,7 @@ private:
 
     // other
     void op_skip(); 
+    void op_extended(); // 0x5e -> cend or dta with parameter
 
 
 
@@ -158,3 +220,5 @@ public : // debug
     
     std::string debug_opcode_trad() override;
 };
+
+extern template class SM5XXCore<SM5A>; // instantiate in SM5A_instruction.cpp
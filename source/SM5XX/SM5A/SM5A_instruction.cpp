@@ -1,101 +1,96 @@
-#include "SM5XX/SM5A/sm5A.h"
+#include "SM5XX/SM5A/SM5A.h"
 
-static const uint8_t lut_digits[0x20] = // default digit segments PLA
-{
-	0xe, 0x0, 0xc, 0x8, 0x2, 0xa, 0xe, 0x2, 0xe, 0xa, 0x0, 0x0, 0x2, 0xa, 0x2, 0x2,
-	0xb, 0x9, 0x7, 0xf, 0xd, 0xe, 0xe, 0xb, 0xf, 0xf, 0x4, 0x0, 0xd, 0xe, 0x4, 0x0
-};
-
-void SM5A::execute_curr_opcode() {
-	bool ssr_exec = false;
+// loop of cpu and g_op_xxx for SM5A (see SM5XX_core.h) -> compiled here with op_xxx
+template class SM5XXCore<SM5A>;
 
-    switch (curr_opcode & 0xf0)
+Opcode_Handler SM5A::decode_opcode(uint8_t opcode) {
+    switch (opcode & 0xf0)
 	{
-		case 0x20: g_op_lax(); break;
-		case 0x30: g_op_adx(); break;
-		case 0x40: op_lb(); break;
-		case 0x70: op_ssr(); ssr_exec = true; break;
+		case 0x20: return opcode_handler(&SM5A::g_op_lax);
+		case 0x30: return opcode_handler(&SM5A::g_op_adx);
+		case 0x40: return opcode_handler(&SM5A::op_lb);
+		case 0x70: return opcode_handler(&SM5A::op_ssr);
 
 		case 0x80: case 0x90: case 0xa0: case 0xb0:
-			op_tr(); break;
+			return opcode_handler(&SM5A::op_tr);
 		case 0xc0: case 0xd0: case 0xe0: case 0xf0:
-			op_trs(); break;
+			return opcode_handler(&SM5A::op_trs);
 
 		default:
-			switch (curr_opcode & 0xfc)
+			switch (opcode & 0xfc)
 			{
-				case 0x04: g_op_rm(); break;
-				case 0x0c: g_op_sm(); break;
-				case 0x10: g_op_exc(); break;
-				case 0x14: op_exci(); break;
-				case 0x18: g_op_lda(); break;
-				case 0x1c: op_excd(); break;
-				case 0x54: g_op_tmi(); break;
+				case 0x04: return opcode_handler(&SM5A::g_op_rm);
+				case 0x0c: return opcode_handler(&SM5A::g_op_sm);
+				case 0x10: return opcode_handler(&SM5A::g_op_exc);
+				case 0x14: return opcode_handler(&SM5A::op_exci);
+				case 0x18: return opcode_handler(&SM5A::g_op_lda);
+				case 0x1c: return opcode_handler(&SM5A::op_excd);
+				case 0x54: return opcode_handler(&SM5A::g_op_tmi);
 
 				default:
-					switch (curr_opcode)
+					switch (opcode)
 					{
-						case 0x00: op_skip(); break;
-						case 0x01: op_atr(); break;
-						case 0x02: op_sbm(); break;
-						case 0x03: op_atbp(); break;
-						case 0x08: g_op_add(); break;
-						case 0x09: g_op_add11(); break;
-						case 0x0a: g_op_coma(); break;
-						case 0x0b: g_op_exbla(); break;
-
-						case 0x50: g_op_ta(); break;
-						case 0x51: g_op_tb(); break;
-						case 0x52: g_op_tc(); break;
-						case 0x53: g_op_tam(); break;
-						case 0x58: g_op_tis(); break;
-						case 0x59: op_ptw(); break;
-						case 0x5a: g_op_ta0(); break;
-						case 0x5b: g_op_tabl(); break;
-						case 0x5c: op_tw(); break;
-						case 0x5d: op_dtw(); break;
-						case 0x5f: g_op_lbl(); break;
-
-						case 0x60: op_comcn(); break;
-						case 0x61: op_pdtw(); break;
-						case 0x62: op_wr(); break;
-						case 0x63: op_ws(); break;
-						case 0x64: op_incb(); break;
-						case 0x65: g_op_idiv(); break;
-						case 0x66: g_op_rc(); break;
-						case 0x67: g_op_sc(); break;
-						case 0x68: op_rmf(); break;
-						case 0x69: op_smf(); break;
-						case 0x6a: op_kta(); break;
-						case 0x6b: op_rbm(); break;
-						case 0x6c: op_decb(); break;
-						case 0x6d: op_comcb(); break;
-						case 0x6e: op_rtn(); break;
-						case 0x6f: op_rtns(); break;
-
-						// extended opcodes
-						case 0x5e:
-                            curr_opcode = get_parameter_of_opcode();
-                            debug_curr_opcode = (debug_curr_opcode<<8) | curr_opcode;
-                            switch (curr_opcode)
-							{
-								case 0x00: g_op_cend(); break;
-								case 0x04: op_dta(); break;
-
-								default: g_op_illegal(); break;
-							}
-							break; // 0x5e
-							default: g_op_illegal(); break;
-						}
-					break; // 0xff
+						case 0x00: return opcode_handler(&SM5A::op_skip);
+						case 0x01: return opcode_handler(&SM5A::op_atr);
+						case 0x02: return opcode_handler(&SM5A::op_sbm);
+						case 0x03: return opcode_handler(&SM5A::op_atbp);
+						case 0x08: return opcode_handler(&SM5A::g_op_add);
+						case 0x09: return opcode_handler(&SM5A::g_op_add11);
+						case 0x0a: return opcode_handler(&SM5A::g_op_coma);
+						case 0x0b: return opcode_handler(&SM5A::g_op_exbla);
+
+						case 0x50: return opcode_handler(&SM5A::g_op_ta);
+						case 0x51: return opcode_handler(&SM5A::g_op_tb);
+						case 0x52: return opcode_handler(&SM5A::g_op_tc);
+						case 0x53: return opcode_handler(&SM5A::g_op_tam);
+						case 0x58: return opcode_handler(&SM5A::g_op_tis);
+						case 0x59: return opcode_handler(&SM5A::op_ptw);
+						case 0x5a: return opcode_handler(&SM5A::g_op_ta0);
+						case 0x5b: return opcode_handler(&SM5A::g_op_tabl);
+						case 0x5c: return opcode_handler(&SM5A::op_tw);
+						case 0x5d: return opcode_handler(&SM5A::op_dtw);
+						case 0x5e: return opcode_handler(&SM5A::op_extended); // extended opcodes
+						case 0x5f: return opcode_handler(&SM5A::g_op_lbl);
+
+						case 0x60: return opcode_handler(&SM5A::op_comcn);
+						case 0x61: return opcode_handler(&SM5A::op_pdtw);
+						case 0x62: return opcode_handler(&SM5A::op_wr);
+						case 0x63: return opcode_handler(&SM5A::op_ws);
+						case 0x64: return opcode_handler(&SM5A::op_incb);
+						case 0x65: return opcode_handler(&SM5A::g_op_idiv);
+						case 0x66: return opcode_handler(&SM5A::g_op_rc);
+						case 0x67: return opcode_handler(&SM5A::g_op_sc);
+						case 0x68: return opcode_handler(&SM5A::op_rmf);
+						case 0x69: return opcode_handler(&SM5A::op_smf);
+						case 0x6a: return opcode_handler(&SM5A::op_kta);
+						case 0x6b: return opcode_handler(&SM5A::op_rbm);
+						case 0x6c: return opcode_handler(&SM5A::op_decb);
+						case 0x6d: return opcode_handler(&SM5A::op_comcb);
+						case 0x6e: return opcode_handler(&SM5A::op_rtn);
+						case 0x6f: return opcode_handler(&SM5A::op_rtns);
+
+						default: return opcode_handler(&SM5A::g_op_illegal);
+					}
 			}
-			break; // 0xfc
-	} // 0xf0
+	}
+}
 
-	// 0x70-0x7F = SSRx instruction use for temporaly change e_flag (only for next instruction)
-    if( e_temporar_flag && (!ssr_exec) ){
-        e_temporar_flag = false;
-    }
+
+void SM5A::execute_curr_opcode() {
+    execute_opcode(decode_table[curr_opcode].handler);
+}
+
+
+void SM5A::op_extended(){ // 0x5e + parameter
+	curr_opcode = get_parameter_of_opcode();
+	debug_curr_opcode = (debug_curr_opcode<<8) | curr_opcode;
+	switch (curr_opcode)
+	{
+		case 0x00: g_op_cend(); break;
+		case 0x04: op_dta(); break;
+
+		default: g_op_illegal(); break;
+	}
 }
 
 
@@ -210,7 +205,7 @@ void SM5A::op_ptw(){
 
 void SM5A::op_pdtw(){ 
 	w_prime_screen_control[w_size-2] = w_prime_screen_control[w_size-1];
-	w_prime_screen_control[w_size-1] = lut_digits[(cn_flag << 4) |accumulator];
+	w_prime_screen_control[w_size-1] = SM5A_LUT_DIGITS[(cn_flag << 4) |accumulator];
 	w_prime_screen_control[w_size-1] |= static_cast<uint8_t>((!cn_flag) && m_flag_segment_decoder);
 	last_w_update = THRESHOLD_CYCLE_UPDATE_W;
 	cycle_curr_opcode += 2;
@@ -223,7 +218,7 @@ void SM5A::op_tw(){
 
 void SM5A::op_dtw(){ 
 	for (int i = 0; i < w_size-1; i++) { w_prime_screen_control[i] = w_prime_screen_control[i + 1]; };
-	w_prime_screen_control[w_size-1] = lut_digits[(cn_flag << 4) | accumulator];
+	w_prime_screen_control[w_size-1] = SM5A_LUT_DIGITS[(cn_flag << 4) | accumulator];
 	w_prime_screen_control[w_size-1] |= static_cast<uint8_t>((!cn_flag) && m_flag_segment_decoder);
 	last_w_update = THRESHOLD_CYCLE_UPDATE_W;
 	cycle_curr_opcode += 2;
@@ -0,0 +1,362 @@
+#include "SM5XX/SM5A/SM5A_lockstep.h"
+
+
+template class SM5XX_Lockstep<SM5A_Lockstep, SM5A>;
+
+
+const Lane_Instruction<SM5A_Lockstep>* SM5A_Lockstep::get_lane_instructions(uint8_t& nb_instruction){
+    // handler of SM5A decode table -> same instruction on lanes
+    static const Lane_Instruction<SM5A_Lockstep> instructions[] = {
+        { opcode_handler(&SM5A::g_op_lax), &SM5A_Lockstep::g_op_lax },
+        { opcode_handler(&SM5A::g_op_adx), &SM5A_Lockstep::g_op_adx },
+        { opcode_handler(&SM5A::op_lb), &SM5A_Lockstep::op_lb },
+        { opcode_handler(&SM5A::op_ssr), &SM5A_Lockstep::op_ssr },
+        { opcode_handler(&SM5A::op_tr), &SM5A_Lockstep::op_tr },
+        { opcode_handler(&SM5A::op_trs), &SM5A_Lockstep::op_trs },
+        { opcode_handler(&SM5A::g_op_rm), &SM5A_Lockstep::g_op_rm },
+        { opcode_handler(&SM5A::g_op_sm), &SM5A_Lockstep::g_op_sm },
+        { opcode_handler(&SM5A::g_op_exc), &SM5A_Lockstep::g_op_exc },
+        { opcode_handler(&SM5A::op_exci), &SM5A_Lockstep::op_exci },
+        { opcode_handler(&SM5A::g_op_lda), &SM5A_Lockstep::g_op_lda },
+        { opcode_handler(&SM5A::op_excd), &SM5A_Lockstep::op_excd },
+        { opcode_handler(&SM5A::g_op_tmi), &SM5A_Lockstep::g_op_tmi },
+        { opcode_handler(&SM5A::op_skip), &SM5A_Lockstep::op_skip },
+        { opcode_handler(&SM5A::op_atr), &SM5A_Lockstep::op_atr },
+        { opcode_handler(&SM5A::op_sbm), &SM5A_Lockstep::op_sbm },
+        { opcode_handler(&SM5A::op_atbp), &SM5A_Lockstep::op_atbp },
+        { opcode_handler(&SM5A::g_op_add), &SM5A_Lockstep::g_op_add },
+        { opcode_handler(&SM5A::g_op_add11), &SM5A_Lockstep::g_op_add11 },
+        { opcode_handler(&SM5A::g_op_coma), &SM5A_Lockstep::g_op_coma },
+        { opcode_handler(&SM5A::g_op_exbla), &SM5A_Lockstep::g_op_exbla },
+        { opcode_handler(&SM5A::g_op_ta), &SM5A_Lockstep::g_op_ta },
+        { opcode_handler(&SM5A::g_op_tb), &SM5A_Lockstep::g_op_tb },
+        { opcode_handler(&SM5A::g_op_tc), &SM5A_Lockstep::g_op_tc },
+        { opcode_handler(&SM5A::g_op_tam), &SM5A_Lockstep::g_op_tam },
+        { opcode_handler(&SM5A::g_op_tis), &SM5A_Lockstep::g_op_tis },
+        { opcode_handler(&SM5A::op_ptw), &SM5A_Lockstep::op_ptw },
+        { opcode_handler(&SM5A::g_op_ta0), &SM5A_Lockstep::g_op_ta0 },
+        { opcode_handler(&SM5A::g_op_tabl), &SM5A_Lockstep::g_op_tabl },
+        { opcode_handler(&SM5A::op_tw), &SM5A_Lockstep::op_tw },
+        { opcode_handler(&SM5A::op_dtw), &SM5A_Lockstep::op_dtw },
+        { opcode_handler(&SM5A::op_extended), &SM5A_Lockstep::op_extended },
+        { opcode_handler(&SM5A::g_op_lbl), &SM5A_Lockstep::g_op_lbl },
+        { opcode_handler(&SM5A::op_comcn), &SM5A_Lockstep::op_comcn },
+        { opcode_handler(&SM5A::op_pdtw), &SM5A_Lockstep::op_pdtw },
+        { opcode_handler(&SM5A::op_wr), &SM5A_Lockstep::op_wr },
+        { opcode_handler(&SM5A::op_ws), &SM5A_Lockstep::op_ws },
+        { opcode_handler(&SM5A::op_incb), &SM5A_Lockstep::op_incb },
+        { opcode_handler(&SM5A::g_op_idiv), &SM5A_Lockstep::g_op_idiv },
+        { opcode_handler(&SM5A::g_op_rc), &SM5A_Lockstep::g_op_rc },
+        { opcode_handler(&SM5A::g_op_sc), &SM5A_Lockstep::g_op_sc },
+        { opcode_handler(&SM5A::op_rmf), &SM5A_Lockstep::op_rmf },
+        { opcode_handler(&SM5A::op_smf), &SM5A_Lockstep::op_smf },
+        { opcode_handler(&SM5A::op_kta), &SM5A_Lockstep::op_kta },
+        { opcode_handler(&SM5A::op_rbm), &SM5A_Lockstep::op_rbm },
+        { opcode_handler(&SM5A::op_decb), &SM5A_Lockstep::op_decb },
+        { opcode_handler(&SM5A::op_comcb), &SM5A_Lockstep::op_comcb },
+        { opcode_handler(&SM5A::op_rtn), &SM5A_Lockstep::op_rtn },
+        { opcode_handler(&SM5A::op_rtns), &SM5A_Lockstep::op_rtns },
+        { opcode_handler(&SM5A::g_op_illegal), &SM5A_Lockstep::g_op_illegal },
+    };
+    nb_instruction = sizeof(instructions) / sizeof(instructions[0]);
+    return instructions;
+}
+
+
+
+/////////////////////////// Lanes <-> SM5A //////////////////////////////////////////////////////
+
+void SM5A_Lockstep::load_lane(uint8_t lane, const SM5A& cpu){
+    for(int col = 0; col < SM5A_RAM_COL; col++){
+        for(int line = 0; line < SM5A_RAM_LINE; line++){ ram[col * SM5A_RAM_LINE + line][lane] = cpu.ram[col][line]; }
+    }
+    for(int col = 0; col < SM5A_SEGMENT_COL; col++){
+        for(int line = 0; line < SM5A_SEGMENT_LINE; line++){ segment_on[col][line][lane] = cpu.segment_on[col][line]; }
+    }
+    for(int i = 0; i < 9; i++){
+        w_screen_control[i][lane] = cpu.w_screen_control[i];
+        w_prime_screen_control[i][lane] = cpu.w_prime_screen_control[i];
+    }
+    cb_debordement_rom_program_counter[lane] = cpu.cb_debordement_rom_program_counter;
+    last_w_update[lane] = cpu.last_w_update;
+    cn_flag[lane] = cpu.cn_flag;
+    r_subroutine_flag[lane] = cpu.r_subroutine_flag;
+    e_temporar_flag[lane] = cpu.e_temporar_flag;
+    r_output_control[lane] = cpu.r_output_control;
+    m_flag_segment_decoder[lane] = cpu.m_flag_segment_decoder;
+}
+
+void SM5A_Lockstep::store_lane_cpu(uint8_t lane, SM5A& cpu){
+    for(int col = 0; col < SM5A_RAM_COL; col++){
+        for(int line = 0; line < SM5A_RAM_LINE; line++){ cpu.ram[col][line] = ram[col * SM5A_RAM_LINE + line][lane]; }
+    }
+    for(int col = 0; col < SM5A_SEGMENT_COL; col++){
+        for(int line = 0; line < SM5A_SEGMENT_LINE; line++){ cpu.segment_on[col][line] = segment_on[col][line][lane]; }
+    }
+    cpu.pack_segments();
+    for(int i = 0; i < 9; i++){
+        cpu.w_screen_control[i] = w_screen_control[i][lane];
+        cpu.w_prime_screen_control[i] = w_prime_screen_control[i][lane];
+    }
+    cpu.cb_debordement_rom_program_counter = cb_debordement_rom_program_counter[lane];
+    cpu.last_w_update = last_w_update[lane];
+    cpu.cn_flag = cn_flag[lane];
+    cpu.r_subroutine_flag = r_subroutine_flag[lane];
+    cpu.e_temporar_flag = e_temporar_flag[lane];
+    cpu.r_output_control = r_output_control[lane];
+    cpu.m_flag_segment_decoder = m_flag_segment_decoder[lane];
+}
+
+
+
+/////////////////////////// Wake up / Segment //////////////////////////////////////////////////////
+
+void SM5A_Lockstep::wake_up(uint8_t lane){
+    is_sleep[lane] = false;
+    pc_col[lane] = 0; pc_line[lane] = 0; pc_word[lane] = 0; // Doc Sharp
+    bp_lcd_blackplate[lane] = true;
+    cb_debordement_rom_program_counter[lane] = 0;
+}
+
+void SM5A_Lockstep::update_segment(uint8_t lane){
+    // same as SM5A::update_segment : col = index of w / w', line = bit, word = w or w'
+    for(int col = 0; col < SM5A_SEGMENT_COL; col++){
+        for(int line = 0; line < SM5A_SEGMENT_LINE; line++){
+            segment_on[col][line][lane] = ((w_screen_control[col][lane] >> line) & 0x01)
+                                            | (((w_prime_screen_control[col][lane] >> line) & 0x01) << 1);
+        }
+    }
+    segments_state_are_update[lane] = true;
+}
+
+bool SM5A_Lockstep::get_segments_state_lane(uint8_t lane, uint8_t col, uint8_t line, uint8_t word){
+    if(col >= SM5A_SEGMENT_COL || line >= SM5A_SEGMENT_LINE || word >= SM5A_SEGMENT_WORD){ return false; }
+    return (segment_on[col][line][lane] >> word) & 0x01;
+}
+
+
+
+// ############### Opcode -> instruction on lanes #############################################
+
+void SM5A_Lockstep::op_extended(){ // 0x5e + parameter, same for all lanes
+    uint8_t param = get_parameter_of_opcode();
+    switch(param){
+        case 0x00: g_op_cend(); break;
+        case 0x04: op_dta(); break;
+
+        default: g_op_illegal(); break;
+    }
+}
+
+uint8_t SM5A_Lockstep::digit_of_lane(uint8_t lane){
+    uint8_t digit = SM5A_LUT_DIGITS[((cn_flag[lane] << 4) | accumulator[lane]) & 0x1F];
+    return digit | static_cast<uint8_t>((!cn_flag[lane]) && m_flag_segment_decoder[lane]);
+}
+
+// ROM adress
+void SM5A_Lockstep::op_rtn(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        pc_col[i] = select(mask[i], s_col[i], pc_col[i]);
+        pc_line[i] = select(mask[i], s_line[i], pc_line[i]);
+        pc_word[i] = select(mask[i], s_word[i], pc_word[i]);
+        r_subroutine_flag[i] = select(mask[i], 0, r_subroutine_flag[i]);
+    }
+};
+
+void SM5A_Lockstep::op_rtns(){
+    op_rtn();
+    for(uint8_t i = 0; i < nb_lane; i++){ if(mask[i]){ skip_instruction_lane(i); } } // each lane at its return
+};
+
+void SM5A_Lockstep::op_ssr(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        e_temporar_flag[i] = select(mask[i], 1, e_temporar_flag[i]);
+        s_line[i] = select(mask[i], curr_opcode & 0x0F, s_line[i]);
+    }
+};
+
+void SM5A_Lockstep::op_tr(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t in_sub = r_subroutine_flag[i] ? 0xFF : 0x00;
+        uint8_t far = mask[i] & ~in_sub;
+        pc_word[i] = select(mask[i], curr_opcode & 0x3F, pc_word[i]);
+        pc_line[i] = select(far, s_line[i], pc_line[i]);
+        pc_col[i] = select(far, cb_debordement_rom_program_counter[i], pc_col[i]);
+    }
+};
+
+void SM5A_Lockstep::op_trs(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t in_sub = r_subroutine_flag[i] ? 0xFF : 0x00;
+        uint8_t call = mask[i] & ~in_sub; // call of subroutine -> program counter in buffer
+        uint8_t call_e = call & (e_temporar_flag[i] ? 0xFF : 0x00); // page of SSR
+        uint8_t sub = mask[i] & in_sub; // already in subroutine -> short jump
+
+        uint8_t tmp_line = s_line[i];
+        s_col[i] = select(call, pc_col[i], s_col[i]);
+        s_line[i] = select(call, pc_line[i], s_line[i]);
+        s_word[i] = select(call, pc_word[i], s_word[i]);
+
+        uint8_t col = select(call_e, cb_debordement_rom_program_counter[i], 1);
+        uint8_t line = select(call_e, tmp_line, 0);
+        pc_col[i] = select(call, col, pc_col[i]);
+        pc_line[i] = select(call, line, pc_line[i]);
+        pc_word[i] = select(call, curr_opcode & 0x3F, pc_word[i]);
+
+        pc_line[i] = select(sub, (pc_line[i] & 0x0C) | ((curr_opcode & 0x30) >> 4), pc_line[i]);
+        pc_word[i] = select(sub, curr_opcode & 0x0F, pc_word[i]);
+        r_subroutine_flag[i] = select(call, 1, r_subroutine_flag[i]);
+    }
+};
+
+// RAM adress
+void SM5A_Lockstep::op_lb(){
+    uint8_t line = ((curr_opcode & 0x0C) >> 2);
+    if((curr_opcode & 0x0C) != 0x00){ line = 0x08 | line; }
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        ram_col[i] = select(mask[i], curr_opcode & 0x03, ram_col[i]);
+        ram_line[i] = select(mask[i], line, ram_line[i]);
+    }
+};
+
+void SM5A_Lockstep::op_incb(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t line = (ram_line[i] == 16-1) ? 0 : ram_line[i] + 1; // not overflow
+        ram_line[i] = select(mask[i], line, ram_line[i]);
+        skip[i] = mask[i] & ((line == 8) ? LANE_ON : 0x00); // strange... error of mame ???
+    }
+    skip_instruction(skip);
+};
+
+void SM5A_Lockstep::op_decb(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        bool first = (ram_line[i] == 0);
+        skip[i] = mask[i] & (first ? LANE_ON : 0x00);
+        ram_line[i] = select(mask[i], first ? 16-1 : ram_line[i] - 1, ram_line[i]);
+    }
+    skip_instruction(skip);
+};
+
+void SM5A_Lockstep::op_sbm(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ ram_col[i] = select(mask[i], ram_col[i] | 0x04, ram_col[i]); }
+};
+void SM5A_Lockstep::op_rbm(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ ram_col[i] = select(mask[i], ram_col[i] & (~0x04), ram_col[i]); }
+};
+
+// Data transfert
+void SM5A_Lockstep::op_exci(){
+    g_op_exc();
+    op_incb();
+};
+
+void SM5A_Lockstep::op_excd(){
+    g_op_exc();
+    op_decb();
+};
+
+void SM5A_Lockstep::op_atbp(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        bp_lcd_blackplate[i] = select(mask[i], accumulator[i] & 0x01, bp_lcd_blackplate[i]);
+        cn_flag[i] = select(mask[i], (accumulator[i] & 0x08) >> 3, cn_flag[i]);
+    }
+};
+
+void SM5A_Lockstep::op_ptw(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        w_screen_control[7][i] = select(mask[i], w_prime_screen_control[7][i], w_screen_control[7][i]);
+        w_screen_control[8][i] = select(mask[i], w_prime_screen_control[8][i], w_screen_control[8][i]);
+        last_w_update[i] = select(mask[i], THRESHOLD_CYCLE_UPDATE_W, last_w_update[i]);
+    }
+};
+
+void SM5A_Lockstep::op_pdtw(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t digit = digit_of_lane(i);
+        w_prime_screen_control[7][i] = select(mask[i], w_prime_screen_control[8][i], w_prime_screen_control[7][i]);
+        w_prime_screen_control[8][i] = select(mask[i], digit, w_prime_screen_control[8][i]);
+        last_w_update[i] = select(mask[i], THRESHOLD_CYCLE_UPDATE_W, last_w_update[i]);
+        cycle_curr_opcode[i] += mask[i] ? 2 : 0;
+    }
+};
+
+void SM5A_Lockstep::op_tw(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        for(int w = 0; w < 9; w++){ w_screen_control[w][i] = select(mask[i], w_prime_screen_control[w][i], w_screen_control[w][i]); }
+        last_w_update[i] = select(mask[i], THRESHOLD_CYCLE_UPDATE_W, last_w_update[i]);
+    }
+};
+
+void SM5A_Lockstep::op_dtw(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t digit = digit_of_lane(i);
+        for(int w = 0; w < 9-1; w++){ w_prime_screen_control[w][i] = select(mask[i], w_prime_screen_control[w+1][i], w_prime_screen_control[w][i]); }
+        w_prime_screen_control[8][i] = select(mask[i], digit, w_prime_screen_control[8][i]);
+        last_w_update[i] = select(mask[i], THRESHOLD_CYCLE_UPDATE_W, last_w_update[i]);
+        cycle_curr_opcode[i] += mask[i] ? 2 : 0;
+    }
+}
+
+void SM5A_Lockstep::op_wr(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        for(int w = 0; w < 9-1; w++){ w_prime_screen_control[w][i] = select(mask[i], w_prime_screen_control[w+1][i], w_prime_screen_control[w][i]); }
+        w_prime_screen_control[8][i] = select(mask[i], accumulator[i] & 0x07, w_prime_screen_control[8][i]);
+        last_w_update[i] = select(mask[i], THRESHOLD_CYCLE_UPDATE_W, last_w_update[i]);
+    }
+};
+
+void SM5A_Lockstep::op_ws(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        for(int w = 0; w < 9-1; w++){ w_prime_screen_control[w][i] = select(mask[i], w_prime_screen_control[w+1][i], w_prime_screen_control[w][i]); }
+        w_prime_screen_control[8][i] = select(mask[i], accumulator[i] | 8, w_prime_screen_control[8][i]);
+        last_w_update[i] = select(mask[i], THRESHOLD_CYCLE_UPDATE_W, last_w_update[i]);
+    }
+}
+
+// input - output instructions
+void SM5A_Lockstep::op_atr(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ r_output_control[i] = select(mask[i], accumulator[i] & 0x0F, r_output_control[i]); }
+};
+
+void SM5A_Lockstep::op_kta(){
+    // same as SM5A : 0 on R_i output -> K_i read (or all K if no multiplex)
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t pin_activate = (~r_output_control[i]) & 0x0F;
+        uint8_t value = 0x00;
+        for(int k = 0; k < 4; k++){
+            bool read = (((pin_activate >> k) & 0x01) == 0x01) || input_no_multiplex;
+            value |= k_input[k][i] & (read ? 0xFF : 0x00);
+        }
+        accumulator[i] = select(mask[i], value, accumulator[i]);
+    }
+};
+
+// Divider
+void SM5A_Lockstep::op_dta(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ accumulator[i] = select(mask[i], (f_clock_divider[i] >> 11) & 0xf, accumulator[i]); }
+};
+
+// BIT manipulation
+void SM5A_Lockstep::op_rmf(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        m_flag_segment_decoder[i] = select(mask[i], 0x00, m_flag_segment_decoder[i]);
+        accumulator[i] = select(mask[i], 0x00, accumulator[i]);
+    }
+};
+
+void SM5A_Lockstep::op_smf(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ m_flag_segment_decoder[i] = select(mask[i], 0x01, m_flag_segment_decoder[i]); }
+};
+
+void SM5A_Lockstep::op_comcb(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ cb_debordement_rom_program_counter[i] ^= mask[i] & 0x01; }
+};
+
+// other
+void SM5A_Lockstep::op_comcn(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ cn_flag[i] ^= mask[i] & 0x01; }
+};
+
+void SM5A_Lockstep::op_skip(){};
@@ -0,0 +1,112 @@
+#pragma once
+#include "SM5XX/SM5A/SM5A.h"
+#include "SM5XX/SM5XX_lockstep.h"
+
+
+// Lanes of SM5A in lockstep (see SM5XX_lockstep.h) : variables of SM5A.h, 1 per lane
+
+class SM5A_Lockstep final : public SM5XX_Lockstep<SM5A_Lockstep, SM5A> {
+    friend class SM5XX_Lockstep<SM5A_Lockstep, SM5A>; // loop call function of SM5A_Lockstep without virtual
+
+private :
+    uint8_t cb_debordement_rom_program_counter[LOCKSTEP_NB_LANE];
+    uint8_t w_screen_control[9][LOCKSTEP_NB_LANE];
+    uint8_t w_prime_screen_control[9][LOCKSTEP_NB_LANE];
+    uint8_t last_w_update[LOCKSTEP_NB_LANE];
+    uint8_t cn_flag[LOCKSTEP_NB_LANE];
+    uint8_t r_subroutine_flag[LOCKSTEP_NB_LANE];
+    uint8_t e_temporar_flag[LOCKSTEP_NB_LANE];
+    uint8_t r_output_control[LOCKSTEP_NB_LANE];
+    uint8_t m_flag_segment_decoder[LOCKSTEP_NB_LANE];
+    uint8_t segment_on[SM5A_SEGMENT_COL][SM5A_SEGMENT_LINE][LOCKSTEP_NB_LANE];
+
+/// ##### FUNCTION ################################################# ///
+private :
+    void load_lane(uint8_t lane, const SM5A& cpu);
+    void store_lane_cpu(uint8_t lane, SM5A& cpu);
+    bool get_segments_state_lane(uint8_t lane, uint8_t col, uint8_t line, uint8_t word);
+
+    void execute_opcode(Lane_Handler instruction){
+        bool ssr_exec = ((curr_opcode & 0xf0) == 0x70);
+
+        (this->*instruction)();
+
+        // 0x70-0x7F = SSRx : e_flag changed only for next instruction
+        if(!ssr_exec){
+            for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ e_temporar_flag[i] = select(mask[i], 0x00, e_temporar_flag[i]); }
+        }
+    }
+
+    bool condition_to_update_segment(uint8_t lane){
+        if(last_w_update[lane] != 0){ last_w_update[lane] -= 1; } // not during maj w -> prevention of glitch
+
+        uint8_t value = ((f_clock_divider[lane] >> 9) & 0x01);
+        if((value != flag_time_update_screen[lane]) && last_w_update[lane] == 0){
+            flag_time_update_screen[lane] = value;
+            return true;
+        }
+        return false;
+    }
+    void update_segment(uint8_t lane);
+    void wake_up(uint8_t lane);
+
+    void fast_forward_clock(uint8_t lane, uint32_t nb_cycle){ // same as SM5A
+        f_clock_divider[lane] += nb_cycle;
+        last_w_update[lane] = (last_w_update[lane] > nb_cycle) ? (last_w_update[lane] - nb_cycle) : 0;
+    }
+
+    uint8_t ram_cell(uint8_t lane){ // same as read_ram_value of SM5A
+        uint8_t col = min(ram_col[lane], SM5A_RAM_COL-1);
+        uint8_t line = min(ram_line[lane], SM5A_RAM_LINE-1);
+        return col * SM5A_RAM_LINE + line;
+    }
+
+    uint8_t digit_of_lane(uint8_t lane); // segment decoder (PDTW, DTW)
+
+    static const Lane_Instruction<SM5A_Lockstep>* get_lane_instructions(uint8_t& nb_instruction);
+
+    // -- from SM5A_lockstep.cpp ------------------------------ //
+    // same as SM5A_instruction.cpp
+
+    // ROM adress
+    void op_comcn();
+    void op_rtn();
+    void op_rtns();
+    void op_ssr();
+    void op_tr();
+    void op_trs();
+
+    // RAM adress
+    void op_lb();
+    void op_incb();
+    void op_decb();
+    void op_sbm();
+    void op_rbm();
+
+    // Data transfert
+    void op_exci();
+    void op_excd();
+    void op_atbp();
+    void op_ptw();
+    void op_pdtw();
+    void op_tw();
+    void op_dtw();
+    void op_wr();
+    void op_ws();
+
+    // input - output instructions
+    void op_atr();
+    void op_kta();
+
+    // Divider
+    void op_dta();
+
+    // BIT manipulation
+    void op_rmf();
+    void op_smf();
+    void op_comcb();
+
+    // other
+    void op_skip();
+    void op_extended(); // 0x5e -> cend or dta with parameter
+};
@@ -1,107 +1,75 @@
 #include "SM5XX/SM5XX.h"
 #include "std/timer.h"
+#include "std/movie.h"
 #include "virtual_i_o/time_addresses.h"
 #include <sys/stat.h>
+#include <string.h>
 #include <sstream>
 #include <iomanip>
 
-bool SM5XX::step(){ // loop of CPU
-    // output -> is opcode are executed or not
-    // execution of 1 cycle of cpu
-    bool execution_opcode = false;
-
-    if(cycle_curr_opcode <= 0){
-        debug_theorie_time = debug_cycle_curr_opcode * time_per_cycle_us; 
-        debug_cycle_previous_opcode = debug_cycle_curr_opcode;
-        
-        execution_opcode = true;
-        cycle_curr_opcode = 0x00; // safety -> never less than 0
-
-        if(is_sleep && condition_to_wake_up()){ wake_up(); }
-
-        if(!is_sleep){
-            curr_opcode = read_rom_value(); debug_curr_opcode = curr_opcode;
-            calculate_cycle(curr_opcode);
-            adding_program_counter(&curr_opcode);
-            execute_curr_opcode();
-            cycle_curr_opcode = cycle_curr_opcode * cpu_frequency_divider; // for increase time of execution 
-                        // -> low consumption divide frequency by 2 => 2x more cycles to execute opcode
-        }
-        else { // for run step_clock is sleep
-            cycle_curr_opcode = 1; 
-        } 
-        debug_cycle_curr_opcode = cycle_curr_opcode;
+Decode_Table SM5XX::build_decode_table(Opcode_Handler (*decode_opcode)(uint8_t)
+                                        , bool (*no_pc_increase)(uint8_t)
+                                        , bool (*is_on_double_octet)(uint8_t)
+                                        , uint8_t (*block_kind)(uint8_t)){
+    // Calculate nb cycle cpu need to execute a opcode 
+    // if opcode on 1 octet = 2 cycles (1 octet = 2*4bit. cpu is 4bit)
+    // if opcode on 2 octet = 4 cycles 
+    Decode_Table table;
+    for(int opcode = 0; opcode < 256; opcode++){
+        Opcode_Decode& decode = table.entry[opcode];
+        decode.handler = decode_opcode(opcode);
+        decode.nb_byte = is_on_double_octet(opcode) ? 2 : 1;
+        decode.nb_cycle = 2 * decode.nb_byte;
+        decode.no_pc_increase = no_pc_increase(opcode);
+        decode.block_kind = block_kind(opcode); // jump and 2 octets opcode end the block whatever the cpu say
+        if(decode.block_kind == BLOCK_NEXT && (decode.no_pc_increase || decode.nb_byte == 2)){ decode.block_kind = BLOCK_END; }
     }
-    execute_cycle();
-
-    return execution_opcode;
+    return table;
 }
 
 
 
-void SM5XX::execute_cycle(){
-    // each execution need during 1 cycle
-    step_clock_divider(); // in, there are update screen
-    cycle_curr_opcode--;
-    update_sound();
-}
-
-
 
-void SM5XX::adding_program_counter(const uint8_t* opcode){
-    if(opcode == nullptr || !no_pc_increase(*opcode)){
-        // swift bit word counter to right + adding new bit (w[0] == w[1]) (1 if equal, 0 if not)
-        bool tmp = (program_counter.word & 0x01) == ((program_counter.word & 0x02) >> 1);
-        program_counter.word = program_counter.word >> 1;
-        program_counter.word = (tmp << 5) | program_counter.word;
+//////////////////////////////////// Input ////////////////////////////////////
+void SM5XX::input_set(int group, int line, bool state){
+    if(movie_record != nullptr){
+        bool curr = (line == 8) ? alpha_input : (line == 9) ? beta_input : ((k_input[group] >> line) & 0x01);
+        if(curr != state){ movie_record->add_input(cycle_count, group, line, state); }
     }
-}
-
-
-
-void SM5XX::calculate_cycle(uint8_t opcode){
-    // Calculate nb cycle cpu need to execute a opcode 
-    // if opcode on 1 octet = 2 cycles (1 octet = 2*4bit. cpu is 4bit)
-    // if opcode on 2 octet = 4 cycles 
-    cycle_curr_opcode += 2;
-    if(is_on_double_octet(opcode)){ cycle_curr_opcode += 2; }
-}
-
 
+    // special input -> says by line >= 8 (not exist in true K input)
+    if(line == 8){ alpha_input = state; }
+    else if(line == 9){ beta_input = state; }
 
-void SM5XX::skip_instruction(){
-    // skip a instruction. This fonction is call on opcode function
-    // need to wait same nb cycle of instruction skiped
-    uint8_t opcode_to_skip = read_rom_value(); // PC already set on new opcode we skip
-    calculate_cycle(opcode_to_skip);
-    adding_program_counter(nullptr); // NO NEED OPCODE -> empty opcode
-    if(is_on_double_octet(opcode_to_skip)){ adding_program_counter(nullptr); }
+    else if(state){ k_input[group] = k_input[group] | (0x01 << line); }
+    else { k_input[group] = k_input[group] & ~(0x01 << line); }
 }
 
 
 
+//////////////////////////////////// Segments ////////////////////////////////////
+void SM5XX::pack_segment_bits(const uint8_t* segment_on, const Segment_Layout& layout){
+    segment_layout = layout;
 
-/////////////////////////////// Clock divider cpu -> segment calibrate with ///////////////////////////////
-
-void SM5XX::step_clock_divider(){
-    // each cycle, signal are divide (15 times) for obtain 1 seconds
-    f_clock_divider = (f_clock_divider + 1) & 0x7FFF; // on 15 bit
-    if(f_clock_divider == 0x00) {
-        gamma_flag_second = true; // reset by instruction, not automaticly
+    // nb_word = 2 or 4 -> value of a [col][line] never between 2 uint64_t
+    uint64_t bits[SEGMENT_BITS_WORD] = {};
+    uint8_t mask = uint8_t((1 << layout.nb_word) - 1);
+    uint16_t pos = 0;
+    for(uint16_t i = 0; i < uint16_t(layout.nb_col * layout.nb_line); i++, pos += layout.nb_word){
+        bits[pos >> 6] |= uint64_t(segment_on[i] & mask) << (pos & 63);
     }
-    if(condition_to_update_segment()) { update_segment(); } // depending to clock value
+    memcpy(segment_bits, bits, sizeof(bits));
+    segment_sequence += 1;
 }
 
-
-
-//////////////////////////////////// Input ////////////////////////////////////
-void SM5XX::input_set(int group, int line, bool state){
-    // special input -> says by line >= 8 (not exist in true K input)
-    if(line == 8){ alpha_input = state; }
-    else if(line == 9){ beta_input = state; }
-
-    else if(state){ k_input[group] = k_input[group] | (0x01 << line); }
-    else { k_input[group] = k_input[group] & ~(0x01 << line); }
+bool SM5XX::read_segment_changes(uint64_t changed[SEGMENT_BITS_WORD]){
+    uint64_t any = 0;
+    for(uint8_t i = 0; i < SEGMENT_BITS_WORD; i++){
+        changed[i] = segment_bits[i] ^ segment_bits_read[i];
+        segment_bits_read[i] = segment_bits[i];
+        any |= changed[i];
+    }
+    return any != 0;
 }
 
 
@@ -162,13 +130,6 @@ void SM5XX::set_time(uint8_t hour, uint8_t minute, uint8_t second) {
 
 //////////////////////////////////// Usefull function ////////////////////////////////////
 
-uint8_t SM5XX::get_parameter_of_opcode(bool add_pc){
-    uint8_t param = read_rom_value();
-    if(add_pc){ adding_program_counter(nullptr); } // move to next instruction because now we are on parameter value
-    return param;
-}
-
-
 void SM5XX::copy_buffer(const ProgramCounter& src, ProgramCounter& dst) {
     dst.col = src.col;
     dst.line = src.line;
@@ -227,11 +188,28 @@ std::string SM5XX::debug_var_cpu(){
     oss << " - " ;    
     oss << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << static_cast<int>(read_ram_value());
 
+    oss << "(" ;
+    oss << "(" << debug_block_cache();
+    oss << "(" << debug_fused_pair();
+
     return oss.str();
 }      
 
 
 
+std::string SM5XX::debug_block_cache(){
+    uint64_t nb_lookup = uint64_t(debug_block_cache_hit) + debug_block_cache_miss;
+    uint32_t hit_rate = (nb_lookup == 0) ? 0 : uint32_t(uint64_t(debug_block_cache_hit) * 1000 / nb_lookup);
+
+    std::ostringstream oss;
+    oss << std::dec << "Block cache: " << debug_block_cache_nb_block << " blocks - hit ";
+    oss << hit_rate / 10 << "." << hit_rate % 10 << "% - ";
+    oss << debug_block_cache_nb_opcode << " op";
+    return oss.str();
+}
+
+
+
 void SM5XX::debug_dump_ram_state(const char* filename) {
     // Dump the current RAM state to a file for debugging on the sd card here: "sdmc:/3ds/debug/"
     // check the folder exists
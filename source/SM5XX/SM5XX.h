@@ -1,16 +1,88 @@
 #pragma once
 #include <vector>
+#include <array>
 #include <stdint.h>
 #include <string>
-#include <SM5XX\Base_Structure.h>
+#include "SM5XX/Base_Structure.h"
 #include "virtual_i_o/time_addresses.h"
 
 
 constexpr uint8_t ROM_WORD = 63; // each SM5XX have 63 rom word -> it's why program counter is the same
 constexpr uint32_t FREQUENCY_CPU = 32768; // Hz = 32,768 kHZ => 30.517us 1 cycle => 61us for almost instruction
 
+// Word of program counter is a 6 bit polynomial counter :
+// swift bit to right + adding new bit (w[0] == w[1]) (1 if equal, 0 if not)
+// -> precomputed for the 64 values, move to next instruction = 1 load
+constexpr std::array<uint8_t, 64> build_next_word(){
+    std::array<uint8_t, 64> next{};
+    for(uint8_t word = 0; word < 64; word++){
+        bool tmp = (word & 0x01) == ((word & 0x02) >> 1);
+        next[word] = (tmp << 5) | (word >> 1);
+    }
+    return next;
+}
+inline constexpr std::array<uint8_t, 64> next_word = build_next_word();
+
+
+class SM5XX;
+typedef void (SM5XX::*Opcode_Handler)(); // instruction of cpu (g_op_xxx or op_xxx of each CPU)
+
+// Decoded information of one opcode value -> 1 lookup per instruction instead of switch cascade
+struct Opcode_Decode {
+    Opcode_Handler handler;
+    uint8_t nb_byte; // 1 octet, 2 octet if opcode need parameter
+    uint8_t nb_cycle; // cycles used (in theorie) -> 2 per octet
+    bool no_pc_increase; // jump opcode -> program counter set by instruction
+    uint8_t block_kind; // place of opcode in a basic block (block cache of run_cycles)
+};
+
+constexpr uint8_t MAX_FUSED_PAIR = 16; // opcodes fused by block cache, by cpu (SM5XX_core.h)
+
+// block_kind values
+constexpr uint8_t BLOCK_NEXT = 0; // block continue on next word
+constexpr uint8_t BLOCK_END = 1; // last opcode of block : jump, can skip next opcode, 2 octets
+constexpr uint8_t BLOCK_BARRIER = 2; // never in a block : sleep, clock divider, sound, frequency of cpu
+
+struct Decode_Table { Opcode_Decode entry[256]; };
+
+// used by each CPU for put its instruction in decode table
+template <class CPU>
+inline Opcode_Handler opcode_handler(void (CPU::*instruction)()){ return static_cast<Opcode_Handler>(instruction); }
+
+
+// LCD output of cpu bit-packed (segment_on of each cpu) : 1 bit by segment, bit = (col * nb_line + line) * nb_word + word
+// SM5A 9 * 4 * 2, SM510 3 * 16 * 4, SM511/2 4 * 16 * 4 -> 256 bits max
+constexpr uint16_t SEGMENT_BITS_MAX = 256;
+constexpr uint8_t SEGMENT_BITS_WORD = SEGMENT_BITS_MAX / 64;
+constexpr uint16_t SEGMENT_BIT_NONE = 0xFFFF; // segment not on this cpu
+
+struct Segment_Layout { uint8_t nb_col; uint8_t nb_line; uint8_t nb_word; }; // of segment_on of a cpu
+
+constexpr uint16_t segment_bit_index(const Segment_Layout& layout, uint8_t col, uint8_t line, uint8_t word){
+    if(col >= layout.nb_col || line >= layout.nb_line || word >= layout.nb_word){ return SEGMENT_BIT_NONE; }
+    return (uint16_t(col) * layout.nb_line + line) * layout.nb_word + word;
+}
+
+// no branch (loop on all segments of a game can be vectorized), SEGMENT_BIT_NONE -> false
+inline bool segment_bit_value(const uint64_t bits[SEGMENT_BITS_WORD], uint16_t index){
+    return ((bits[(index >> 6) & (SEGMENT_BITS_WORD - 1)] >> (index & 63)) & 0x01) & (index < SEGMENT_BITS_MAX);
+}
 
 
+// Events of a batch of cycles (run_cycles) -> read by frontend after the batch, no callback each cycle
+constexpr uint16_t MAX_SOUND_EDGE = 256; // batch stop if full
+struct Cycle_Events {
+    uint32_t nb_opcode = 0; // opcodes executed during the batch
+    bool segments_updated = false; // batch stop just after the cycle which update segments
+    bool sound_start = false; // value of get_active_sound() before the first cycle
+    uint16_t nb_sound_edge = 0;
+    uint32_t sound_edge[MAX_SOUND_EDGE]; // cycle (from start of batch) where sound value toggle (batch can be > 65535 cycles)
+};
+
+
+
+class Movie;
+
 class SM5XX {
 public : 
     SM5XX(const std::string& name) :
@@ -18,6 +90,7 @@ public :
         frequency(FREQUENCY_CPU),
         time_per_cycle_us(1'000'000.0 / FREQUENCY_CPU)
         {}
+    virtual ~SM5XX() = default; // cpu deleted by SM5XX* (get_cpu)
 
 public:
     std::string name_cpu;
@@ -25,11 +98,17 @@ public:
     bool segments_state_are_update = false;
     bool input_no_multiplex = false;
     uint32_t frequency;
+    uint64_t cycle_count = 0; // nb cycles executed since init (absolute time of cpu)
     uint32_t sound_divide_frequency = 1; 
+    bool busy_loop_skip = true; // jump wait loop of rom in run_cycles (false -> accuracy test)
+    bool translated_rom = true; // use rom translated in C++ in run_cycles if linked (false -> accuracy test)
+    bool block_cache = true; // run_cycles execute basic blocks decoded at first passage (false -> accuracy test)
+    Movie* movie_record = nullptr; // changes of input given to movie with their cycle (std/movie.h), not in snapshot
 
 protected:
     // cpu logic
     uint8_t curr_opcode;
+    const Opcode_Decode* decode_table = nullptr; // 256 entries, shared by all cpu of same type (set by init)
     int cycle_curr_opcode; // cycles used (in theorie) for perform current opcode
 
     // move in ram and rom
@@ -67,8 +146,9 @@ protected:
     const TimeAddress *time_addresses;
 
 public:
-    bool step();
-    void execute_cycle();
+    // loop of cpu -> implemented by SM5XXCore<CPU> (SM5XX_core.h), with no virtual call inside
+    virtual bool step() = 0;
+    virtual uint32_t run_cycles(uint32_t nb_cycle, Cycle_Events& events) = 0; // return nb cycles really executed
     void input_set(int group, int line, bool state);
 
     void load_rom_time_addresses(const std::string& ref_game);
@@ -76,22 +156,37 @@ public:
     bool is_time_set(){ return time_set_state; }
     void set_time(uint8_t hour, uint8_t minute, uint8_t second);
     void set_input_multiplexage(bool use_multiplexage = true){ input_no_multiplex = !use_multiplexage; };
+    void set_busy_loop_skip(bool enable = true){ busy_loop_skip = enable; }
+    void set_translated_rom(bool enable = true){ translated_rom = enable; }
+    void set_block_cache(bool enable = true){ block_cache = enable; }
+
+    // segments bit-packed : copy of segment_on at each update (and restore), 1 load for a segment, XOR for all screen
+    uint64_t segment_bits[SEGMENT_BITS_WORD] = {};
+    uint32_t segment_sequence = 0; // +1 at each update of segments (even with same value), not in snapshot
+    uint16_t segment_bit_index(uint8_t col, uint8_t line, uint8_t word) const { return ::segment_bit_index(segment_layout, col, line, word); }
+    bool get_segment_bit(uint16_t index) const { return segment_bit_value(segment_bits, index); }
+    // bits changed since previous call (1 reader by cpu : frontend or run-ahead future), false if nothing changed
+    bool read_segment_changes(uint64_t changed[SEGMENT_BITS_WORD]);
 
 private : 
-    void adding_program_counter(const uint8_t* opcode);
-    void calculate_cycle(uint8_t opcode);
-    void step_clock_divider();
-
     void wait_timing_cpu(int cycle);
     uint64_t get_target_time_cpu(int cycle);
 
+protected : 
+    void adding_program_counter(){ program_counter.word = next_word[program_counter.word & ROM_WORD]; }
     bool condition_to_wake_up();
     bool check_button_pressed();
-
-protected : 
-    uint8_t get_parameter_of_opcode(bool add_pc = true);
-    void skip_instruction();
     void copy_buffer(const ProgramCounter& src, ProgramCounter& dst); // usefull for some SM5XX CPU
+    void pack_segment_bits(const uint8_t* segment_on, const Segment_Layout& layout); // segment_on[col][line]
+
+    Segment_Layout segment_layout = { 0, 0, 0 };
+    uint64_t segment_bits_read[SEGMENT_BITS_WORD] = {}; // value of last read_segment_changes
+
+    // build the 256 entries of a cpu from its decode function (called once per cpu type)
+    static Decode_Table build_decode_table(Opcode_Handler (*decode_opcode)(uint8_t)
+                                            , bool (*no_pc_increase)(uint8_t)
+                                            , bool (*is_on_double_octet)(uint8_t)
+                                            , uint8_t (*block_kind)(uint8_t));
 
 
 
@@ -108,6 +203,7 @@ public :
     virtual void init() = 0;
     virtual void load_rom(const uint8_t* file_hex, size_t size_hex) = 0;
     virtual void load_rom_melody(const uint8_t*, size_t) { }; // empty for SM5A and SM510. Used only by SM511/2
+    virtual bool load_translated_rom(const uint8_t* file_hex, size_t size_hex) = 0; // false -> rom not translated, interpreter only
 
     virtual bool get_segments_state(uint8_t col, uint8_t line, uint8_t word) = 0;
     virtual bool screen_is_on() = 0;
@@ -117,15 +213,19 @@ public :
     // Save/Load state for save states
     virtual bool save_state(FILE* file) = 0;
     virtual bool load_state(FILE* file) = 0;
+
+    // Complete state in memory (rewind, run-ahead, search) -> buffer of get_state_size() octets, no allocation.
+    // Only for same cpu with same rom. Input included, rom / config (multiplexage, time addresses) not
+    virtual size_t get_state_size() = 0;
+    virtual void snapshot(void* buffer) = 0;
+    virtual void restore(const void* buffer) = 0;
     virtual uint8_t get_cpu_type_id() = 0; // Return CPU type identifier
 
-private :
-    virtual void execute_curr_opcode() = 0; // switch case op_code function with curr hexa op_code value
+// Called by SM5XXCore<CPU> on the final cpu class -> resolved at compile time
+protected :
+    virtual void execute_curr_opcode() = 0; // call handler of decode table with curr hexa op_code value
 
     virtual void update_sound(){}; // SM511/2 need update sound logic (melody). Other no need (in theorie need but simplification work great)
-
-    virtual bool no_pc_increase(uint8_t opcode) = 0; // need for adding_program_counter -> say opcode with not increase PC
-    virtual bool is_on_double_octet(uint8_t opcode) = 0; // need for instruction on 2 octet -> skip 2 octet
     
     virtual void update_segment() = 0; // maj of segment -> depend of structure of """RAM video""" of each CPU (SM5A are w register, SM510 and SM511/2 RAM)
     virtual bool condition_to_update_segment() = 0;
@@ -142,57 +242,6 @@ protected:
 
 
 
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// Opcode -> instruction of processor //////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-// -- from SM5XX_instruction.cpp ------------------------------ //
-// All here are the same between SM5A, SM510, SM511 and SM512
-
-protected: 
-
-    // RAM adress
-    void g_op_lbl(); // move ram
-    void g_op_exbla(); // ram_line <-> acc
-
-    // Data transfert
-    void g_op_lax(); // acc = op_code
-    void g_op_lda(); // acc = ram / move ram columns
-    
-    // Arithmetic
-    void g_op_add(); // acc = acc+ram
-    void g_op_add11(); // acc = acc+ram+carry / set carry
-    void g_op_adx(); // acc = acc+op_code
-    void g_op_coma(); // acc = ~acc
-    void g_op_rc(); // carry = 0
-    void g_op_sc(); // carry = 1
-
-    // Data transfert
-    void g_op_exc(); // acc <-> ram / move ram columns
-    
-    // Test -> if, ...
-    void g_op_ta(); // alpha_Pin == 1 -> skip
-    void g_op_tb(); // beta_Pin == 1 -> skip
-    void g_op_tc(); // carry == 0 -> skip
-    void g_op_tam(); // acc == ram -> skip 
-    void g_op_tis(); // 1sec is past (gamma) -> skip 
-    void g_op_tmi(); // bit x of ram == 1 -> skip
-    void g_op_ta0(); // acc == 0x00 -> skip 
-    void g_op_tabl(); // acc == ram_line -> skip 
-
-    // BIT manipulation
-    void g_op_rm(); // change ram bit x per 0
-    void g_op_sm(); // change ram bit x per 1
-
-    // other
-    void g_op_cend(); // stop clock
-    void g_op_idiv(); // reset clock divider
-    void g_op_illegal(); // op code not exit -> Stop CPU
-
-
-
-
-
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// Debug ///////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -213,6 +262,15 @@ public :
     uint8_t debug_multiplexage_activate;
     uint8_t debug_value_read_input;
 
+    uint64_t debug_busy_loop_cycles_skipped = 0; // cycles not executed thanks to busy loop skip (this game)
+    uint32_t debug_busy_loop_nb_skip = 0;
+
+    uint32_t debug_block_cache_hit = 0; // block found in cache
+    uint32_t debug_block_cache_miss = 0; // block decoded (first passage)
+    uint32_t debug_block_cache_nb_block = 0; // blocks in cache (reset by load_rom)
+    uint64_t debug_block_cache_nb_opcode = 0; // opcodes executed by blocks
+    uint64_t debug_fused_pair_count[MAX_FUSED_PAIR] = {}; // executions of each fused pair of cpu (block cache)
+
 
     int debug_program_counter_col() { return program_counter.col; }
     int debug_program_counter_line() { return program_counter.line; }
@@ -227,6 +285,7 @@ public :
 
     void debug_dump_ram_state(const char* filename);
     std::string debug_var_cpu();
+    std::string debug_block_cache(); // hit rate and nb blocks of block cache
 
     virtual uint8_t debug_get_elem_rom(int, int, int) { return 0x00; }
     virtual int debug_rom_adress_size_col(){ return 0; }
@@ -242,4 +301,5 @@ public :
     virtual uint8_t debug_CN_Flag(){ return 0x00; }
 
     virtual std::string debug_opcode_trad(){ return ""; }
+    virtual std::string debug_fused_pair(){ return ""; } // name and executions of each fused pair
 };
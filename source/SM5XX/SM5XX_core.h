@@ -0,0 +1,737 @@
+#pragma once
+#include "SM5XX/SM5XX.h"
+#include "SM5XX/SM5XX_translated.h"
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+
+// Static dispatch version of SM5XX (CRTP) :
+// each cpu (SM5A, SM510, SM511_2) inherit of SM5XXCore<itself> and is final,
+// so loop of cpu and g_op_xxx call read_rom_value(), update_segment(), ... without virtual call (can be inlined)
+// SM5XX stay the virtual interface used by frontend (get_cpu(), screen, sound, ...)
+
+constexpr uint16_t BUSY_LOOP_STATE_SIZE = 256;
+constexpr uint32_t BUSY_LOOP_MAX_CYCLE = 64; // more -> not a wait loop
+
+// Copy of all cpu variables except clock divider -> compare 2 passages in a loop
+struct Busy_Loop_State {
+    uint16_t size = 0;
+    uint8_t data[BUSY_LOOP_STATE_SIZE];
+
+    template <class T>
+    void add(const T& value){ memcpy(&data[size], &value, sizeof(T)); size += sizeof(T); }
+    bool operator==(const Busy_Loop_State& other) const { return size == other.size && memcmp(data, other.data, size) == 0; }
+};
+
+
+// Snapshot / restore : each cpu give the list of its variables (pointer to member) -> size known at compile time
+template <class C, class T>
+constexpr size_t member_size(T C::*){ return sizeof(T); }
+
+
+constexpr uint16_t PC_INDEX_SIZE = 4 * 16 * 64; // col * line * word of program counter (max of all cpu)
+
+// Basic block of a translated rom (SM5XX_translated.h) : run all its opcodes, return nb cycles used
+
+template <class CPU>
+struct Translated_Block {
+    uint16_t index; // col * 16 * 64 + line * 64 + word of first opcode
+    uint16_t max_cycle; // worst case (skip, ...) without cpu_frequency_divider
+    bool end_by_jump;
+    uint32_t (*run)(CPU& cpu, uint32_t& nb_opcode); // stop before end if an opcode skip the next one
+};
+
+
+// Basic block decoded by the cpu at first passage (block cache of run_cycles) -> same idea without generator.
+// Rom never change during run : block stay valid until next load_rom()
+constexpr uint16_t MAX_OPCODE_PER_BLOCK = 24;
+constexpr uint16_t MAX_CYCLE_PER_BLOCK = 128; // without cpu_frequency_divider
+constexpr uint16_t BLOCK_NOT_DECODED = 0xFFFF; // index of block_cache_index
+constexpr uint16_t BLOCK_NONE = 0xFFFE; // first opcode is a barrier -> interpreter
+
+template <class CPU>
+struct Cached_Opcode {
+    Opcode_Handler handler;
+    uint32_t (*fused)(CPU& cpu, const Cached_Opcode* opcode); // not nullptr -> run this opcode and next one
+    uint8_t opcode;
+    uint8_t nb_cycle;
+    uint8_t word; // program counter of opcode
+    uint8_t word_exec; // program counter during instruction (already increased if needed)
+    uint8_t fused_id; // in fused pair list of cpu
+};
+
+// Fusion of 2 opcodes often together (LB + EXC, TAM + T, ...) : 1 dispatch and direct call of both instructions.
+// Each opcode keep its cycles and clock update -> same result as 2 opcodes. If first skip the second, stop.
+// A pair can end a block (first can skip, 2 octets) -> block can be longer than its end opcode
+template <class CPU>
+struct Fused_Pair {
+    Opcode_Handler first;
+    Opcode_Handler second;
+    uint32_t (*run)(CPU& cpu, const Cached_Opcode<CPU>* opcode);
+    const char* name;
+};
+
+struct Cached_Block {
+    uint32_t first_opcode; // in block_cache_opcode
+    uint16_t nb_opcode;
+    uint16_t max_cycle; // worst case (skip, extra cycles) without cpu_frequency_divider
+    bool end_by_jump;
+};
+
+
+
+template <class CPU>
+class SM5XXCore : public SM5XX {
+public :
+    SM5XXCore(const std::string& name) : SM5XX(name) {}
+
+public :
+    bool step() override;
+    uint32_t run_cycles(uint32_t nb_cycle, Cycle_Events& events) override;
+    bool load_translated_rom(const uint8_t* file_hex, size_t size_hex) override;
+
+    static constexpr size_t state_size(){
+        return std::apply([](auto... member){ return (size_t(0) + ... + member_size(member)); }, state_members());
+    }
+    size_t get_state_size() override { return state_size(); }
+    void snapshot(void* buffer) override;
+    void restore(const void* buffer) override;
+
+private :
+    CPU& self(){ return static_cast<CPU&>(*this); }
+
+    // variables of all cpu + CPU::state_members() (variables of each cpu)
+    static constexpr auto state_members(){
+        return std::tuple_cat(std::make_tuple(&SM5XXCore::curr_opcode, &SM5XXCore::cycle_curr_opcode
+                                                , &SM5XXCore::program_counter, &SM5XXCore::s_buffer_program_counter, &SM5XXCore::ram_address
+                                                , &SM5XXCore::carry, &SM5XXCore::accumulator
+                                                , &SM5XXCore::f_clock_divider, &SM5XXCore::gamma_flag_second
+                                                , &SM5XXCore::k_input, &SM5XXCore::beta_input, &SM5XXCore::alpha_input
+                                                , &SM5XXCore::bp_lcd_blackplate, &SM5XXCore::cpu_frequency_divider
+                                                , &SM5XXCore::is_sleep, &SM5XXCore::flag_time_update_screen
+                                                , &SM5XXCore::stop_cpu, &SM5XXCore::cycle_count)
+                              , CPU::state_members());
+    }
+
+protected :
+    void pack_segments(); // segment_on of cpu -> segment_bits, at end of update_segment()
+
+private :
+    bool execute_next_opcode();
+    bool execute_cycle();
+    void add_sound_edge(bool& sound, uint32_t i_cycle, Cycle_Events& events);
+    bool step_clock_divider();
+
+    uint32_t cycles_before_clock_event();
+    void fast_forward_sleep(uint32_t nb_cycle);
+
+    // busy-wait loop detector (run_cycles)
+    uint32_t skip_busy_loop(uint32_t i_cycle, uint32_t nb_cycle, Cycle_Events& events);
+    void get_busy_loop_state(Busy_Loop_State& state);
+
+    bool loop_active = false; // a passage is recorded
+    ProgramCounter loop_pc;
+    uint32_t loop_cycle;
+    uint32_t loop_nb_opcode;
+    uint16_t loop_divider;
+    Busy_Loop_State loop_state;
+
+    // translated rom (run_cycles) -> block by program counter, empty if rom not translated
+    std::vector<const Translated_Block<CPU>*> translated_block;
+    uint32_t run_translated_block(uint32_t i_cycle, uint32_t nb_cycle, Cycle_Events& events, bool& after_jump);
+
+    // block cache (run_cycles) -> block by program counter, decoded at first passage
+    std::vector<uint16_t> block_cache_index; // PC_INDEX_SIZE entries when used, BLOCK_NOT_DECODED or block
+    std::vector<Cached_Block> cached_block;
+    std::vector<Cached_Opcode<CPU>> block_cache_opcode; // opcodes of all blocks, one after the other
+    bool fused_second_skipped; // last pair executed stop after first opcode
+    uint16_t decode_block();
+    bool add_block_opcode(uint8_t& nb_cycle, bool& no_pc_increase); // false -> barrier
+    const Fused_Pair<CPU>* find_fused_pair(Opcode_Handler first, Opcode_Handler second);
+    uint32_t run_cached_block(uint32_t i_cycle, uint32_t nb_cycle, Cycle_Events& events, bool& after_jump);
+
+protected :
+    uint8_t get_parameter_of_opcode(bool add_pc = true);
+    void skip_instruction();
+    void clear_block_cache(); // new rom -> all blocks decoded are wrong
+
+    // used for jump many cycles when only clock divider run (cpu sleep)
+    // -> each cpu can hide it if its sound / screen logic need more
+    bool sound_is_static(){ return true; } // sound can not change if only clock divider run
+    void fast_forward_clock(uint32_t nb_cycle){ f_clock_divider += nb_cycle; } // never pass next clock event
+
+    // one opcode of a translated block : decode done by generator -> instruction is a direct call
+    template <auto instruction>
+    uint32_t execute_translated_opcode(uint8_t opcode, uint8_t nb_cycle, uint8_t word_exec){
+        return execute_block_opcode(instruction, opcode, nb_cycle, word_exec);
+    }
+
+    // one opcode of a block : same as execute_next_opcode() + cycles in block (no clock event during it)
+    template <class Instruction>
+    uint32_t execute_block_opcode(Instruction instruction, uint8_t opcode, uint8_t nb_cycle, uint8_t word_exec){
+        curr_opcode = opcode; debug_curr_opcode = opcode;
+        cycle_curr_opcode = nb_cycle;
+        program_counter.word = word_exec; // program counter already increased (parameter of 2 octets opcode read by instruction)
+        self().execute_opcode(instruction);
+        uint32_t nb_cycle_used = cycle_curr_opcode * cpu_frequency_divider;
+        self().fast_forward_clock(nb_cycle_used);
+        cycle_count += nb_cycle_used;
+        cycle_curr_opcode = 0;
+        return nb_cycle_used;
+    }
+
+    // used by fused pair list of each cpu (Fused_Pair)
+    template <auto first, auto second>
+    static uint32_t run_fused_pair(CPU& cpu, const Cached_Opcode<CPU>* opcode){
+        cpu.debug_fused_pair_count[opcode[0].fused_id] += 1;
+        uint32_t nb_cycle_used = cpu.execute_block_opcode(first, opcode[0].opcode, opcode[0].nb_cycle, opcode[0].word_exec);
+        cpu.fused_second_skipped = (cpu.program_counter.word != opcode[1].word);
+        if(cpu.fused_second_skipped){ return nb_cycle_used; }
+        return nb_cycle_used + cpu.execute_block_opcode(second, opcode[1].opcode, opcode[1].nb_cycle, opcode[1].word_exec);
+    }
+
+public :
+    std::string debug_fused_pair() override;
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Opcode -> instruction of processor //////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// -- from SM5XX_core_instruction.h ------------------------------ //
+// All here are the same between SM5A, SM510, SM511 and SM512
+
+protected:
+
+    // RAM adress
+    void g_op_lbl(); // move ram
+    void g_op_exbla(); // ram_line <-> acc
+
+    // Data transfert
+    void g_op_lax(); // acc = op_code
+    void g_op_lda(); // acc = ram / move ram columns
+
+    // Arithmetic
+    void g_op_add(); // acc = acc+ram
+    void g_op_add11(); // acc = acc+ram+carry / set carry
+    void g_op_adx(); // acc = acc+op_code
+    void g_op_coma(); // acc = ~acc
+    void g_op_rc(); // carry = 0
+    void g_op_sc(); // carry = 1
+
+    // Data transfert
+    void g_op_exc(); // acc <-> ram / move ram columns
+
+    // Test -> if, ...
+    void g_op_ta(); // alpha_Pin == 1 -> skip
+    void g_op_tb(); // beta_Pin == 1 -> skip
+    void g_op_tc(); // carry == 0 -> skip
+    void g_op_tam(); // acc == ram -> skip
+    void g_op_tis(); // 1sec is past (gamma) -> skip
+    void g_op_tmi(); // bit x of ram == 1 -> skip
+    void g_op_ta0(); // acc == 0x00 -> skip
+    void g_op_tabl(); // acc == ram_line -> skip
+
+    // BIT manipulation
+    void g_op_rm(); // change ram bit x per 0
+    void g_op_sm(); // change ram bit x per 1
+
+    // other
+    void g_op_cend(); // stop clock
+    void g_op_idiv(); // reset clock divider
+    void g_op_illegal(); // op code not exit -> Stop CPU
+};
+
+
+
+template <class CPU>
+bool SM5XXCore<CPU>::step(){ // loop of CPU
+    // output -> is opcode are executed or not
+    // execution of 1 cycle of cpu
+    bool execution_opcode = false;
+
+    if(cycle_curr_opcode <= 0){
+        execution_opcode = true;
+        execute_next_opcode();
+    }
+    execute_cycle();
+
+    return execution_opcode;
+}
+
+
+
+template <class CPU>
+uint32_t SM5XXCore<CPU>::run_cycles(uint32_t nb_cycle, Cycle_Events& events){
+    // same as nb_cycle call of step(), but frontend work only after the batch
+    // stop before end if segments are update (frontend need to read it) or if sound edge buffer is full
+    bool sound = self().get_active_sound();
+    events.nb_opcode = 0;
+    events.segments_updated = false;
+    events.sound_start = sound;
+    events.nb_sound_edge = 0;
+
+    loop_active = false; // input can change between 2 batches
+    bool after_jump = false;
+
+    uint32_t i_cycle = 0;
+    while(i_cycle < nb_cycle){
+        if(cycle_curr_opcode <= 0){
+            if(after_jump && busy_loop_skip){
+                uint32_t nb_skip = skip_busy_loop(i_cycle, nb_cycle, events);
+                i_cycle += nb_skip;
+                if(i_cycle >= nb_cycle){ break; }
+            }
+            if(is_sleep && !condition_to_wake_up() && self().sound_is_static()){
+                // cpu sleep -> nothing except clock until next event (segments update, gamma 1s) : jump to it
+                uint32_t nb_skip = cycles_before_clock_event();
+                if(nb_skip > nb_cycle - i_cycle){ nb_skip = nb_cycle - i_cycle; }
+                if(nb_skip >= 2){
+                    fast_forward_sleep(nb_skip);
+                    events.nb_opcode += nb_skip; // same count as 1 cycle per wake up check
+                    i_cycle += nb_skip;
+                    continue;
+                }
+            }
+            if(!translated_block.empty() && translated_rom && !is_sleep){
+                uint32_t nb_cycle_block = run_translated_block(i_cycle, nb_cycle, events, after_jump);
+                if(nb_cycle_block > 0){
+                    i_cycle += nb_cycle_block;
+                    continue;
+                }
+            }
+            if(block_cache && !is_sleep){
+                uint32_t nb_cycle_block = run_cached_block(i_cycle, nb_cycle, events, after_jump);
+                if(nb_cycle_block > 0){
+                    i_cycle += nb_cycle_block;
+                    continue;
+                }
+            }
+            after_jump = execute_next_opcode();
+            events.nb_opcode += 1;
+        }
+
+        // cycles of opcode : clock divider move in one time if nothing happen during them
+        // (next clock event -> bit 9 toggle for segments, wrap for gamma, bit 14 blink are on it)
+        uint32_t nb_block = cycle_curr_opcode;
+        if(nb_block > nb_cycle - i_cycle){ nb_block = nb_cycle - i_cycle; }
+        if(nb_block <= cycles_before_clock_event() && self().sound_is_static()){
+            self().fast_forward_clock(nb_block);
+            cycle_curr_opcode -= nb_block;
+            cycle_count += nb_block;
+
+            add_sound_edge(sound, i_cycle, events); // sound can change only by opcode -> on first cycle
+            i_cycle += nb_block;
+
+            if(events.nb_sound_edge == MAX_SOUND_EDGE){ break; }
+            continue;
+        }
+
+        // else cycle per cycle
+        bool segments_update = execute_cycle();
+
+        add_sound_edge(sound, i_cycle, events);
+        i_cycle += 1;
+
+        if(segments_update){ events.segments_updated = true; break; }
+        if(events.nb_sound_edge == MAX_SOUND_EDGE){ break; }
+    }
+    // never more than asked (all callers do step -= run_cycles) even if a translated block was wrong
+    return (i_cycle < nb_cycle) ? i_cycle : nb_cycle;
+}
+
+
+
+template <class CPU>
+void SM5XXCore<CPU>::add_sound_edge(bool& sound, uint32_t i_cycle, Cycle_Events& events){
+    bool new_sound = self().get_active_sound();
+    if(new_sound != sound){
+        sound = new_sound;
+        events.sound_edge[events.nb_sound_edge] = i_cycle;
+        events.nb_sound_edge += 1;
+    }
+}
+
+
+
+template <class CPU>
+bool SM5XXCore<CPU>::execute_next_opcode(){
+    // output -> opcode executed is a jump (program counter set by instruction)
+    bool is_jump = false;
+    debug_theorie_time = debug_cycle_curr_opcode * time_per_cycle_us;
+    debug_cycle_previous_opcode = debug_cycle_curr_opcode;
+
+    cycle_curr_opcode = 0x00; // safety -> never less than 0
+
+    if(is_sleep && condition_to_wake_up()){ self().wake_up(); }
+
+    if(!is_sleep){
+        curr_opcode = self().read_rom_value(); debug_curr_opcode = curr_opcode;
+        const Opcode_Decode& decode = decode_table[curr_opcode];
+        cycle_curr_opcode += decode.nb_cycle;
+        if(!decode.no_pc_increase){ adding_program_counter(); }
+        is_jump = decode.no_pc_increase;
+        self().execute_curr_opcode();
+        cycle_curr_opcode = cycle_curr_opcode * cpu_frequency_divider; // for increase time of execution
+                    // -> low consumption divide frequency by 2 => 2x more cycles to execute opcode
+    }
+    else { // for run step_clock is sleep
+        cycle_curr_opcode = 1;
+    }
+    debug_cycle_curr_opcode = cycle_curr_opcode;
+    return is_jump;
+}
+
+
+
+template <class CPU>
+bool SM5XXCore<CPU>::execute_cycle(){
+    // each execution need during 1 cycle
+    // output -> segments are update during this cycle
+    bool segments_update = step_clock_divider(); // in, there are update screen
+    cycle_curr_opcode--;
+    cycle_count++;
+    self().update_sound();
+    return segments_update;
+}
+
+
+
+template <class CPU>
+void SM5XXCore<CPU>::skip_instruction(){
+    // skip a instruction. This fonction is call on opcode function
+    // need to wait same nb cycle of instruction skiped
+    const Opcode_Decode& decode = decode_table[self().read_rom_value()]; // PC already set on new opcode we skip
+    cycle_curr_opcode += decode.nb_cycle;
+    uint8_t word = next_word[program_counter.word & ROM_WORD];
+    if(decode.nb_byte == 2){ word = next_word[word]; }
+    program_counter.word = word;
+}
+
+
+
+/////////////////////////////// Clock divider cpu -> segment calibrate with ///////////////////////////////
+
+template <class CPU>
+bool SM5XXCore<CPU>::step_clock_divider(){
+    // each cycle, signal are divide (15 times) for obtain 1 seconds
+    f_clock_divider = (f_clock_divider + 1) & 0x7FFF; // on 15 bit
+    if(f_clock_divider == 0x00) {
+        gamma_flag_second = true; // reset by instruction, not automaticly
+    }
+    if(self().condition_to_update_segment()) { self().update_segment(); return true; } // depending to clock value
+    return false;
+}
+
+
+
+template <class CPU>
+uint32_t SM5XXCore<CPU>::cycles_before_clock_event(){
+    // scheduler of clock divider : nb cycles before next clock event, where divider can only +1
+    // next event = bit 9 toggle (segments update). Wrap (gamma) and bit 14 toggle (blink) are always on it
+    if(((f_clock_divider >> 9) & 0x01) != flag_time_update_screen){ return 0; } // update wait (idiv, SM5A w)
+    return 0x200 - (f_clock_divider & 0x1FF) - 1;
+}
+
+template <class CPU>
+void SM5XXCore<CPU>::fast_forward_sleep(uint32_t nb_cycle){
+    // same result as nb_cycle (>= 2) call of step() during sleep
+    self().fast_forward_clock(nb_cycle);
+    cycle_count += nb_cycle;
+    debug_theorie_time = 1 * time_per_cycle_us;
+    debug_cycle_previous_opcode = 1;
+    debug_cycle_curr_opcode = 1;
+}
+
+
+
+/////////////////////////////// Busy-wait loop ///////////////////////////////
+
+template <class CPU>
+uint32_t SM5XXCore<CPU>::skip_busy_loop(uint32_t i_cycle, uint32_t nb_cycle, Cycle_Events& events){
+    // called on opcode after a jump. If cpu come back at same place with same variables (except clock),
+    // the loop only wait clock or input -> each turn is the same until next clock event : jump these turns
+    // (opcodes read only bit >= 11 of clock divider, fixed until next bit 9 toggle)
+    // output -> nb cycles jumped
+    bool same_place = loop_active && program_counter.col == loop_pc.col
+                        && program_counter.line == loop_pc.line && program_counter.word == loop_pc.word;
+    uint32_t loop_length = i_cycle - loop_cycle;
+    if(loop_active && !same_place && loop_length <= BUSY_LOOP_MAX_CYCLE){ return 0; } // inside the loop studied
+
+    Busy_Loop_State state;
+    get_busy_loop_state(state);
+
+    uint32_t nb_skip = 0;
+    if(same_place && loop_length <= BUSY_LOOP_MAX_CYCLE && state == loop_state
+        && ((loop_divider + loop_length) & 0x7FFF) == f_clock_divider // no idiv in loop
+        && self().sound_is_static())
+    {
+        uint32_t nb_cycle_free = cycles_before_clock_event();
+        if(nb_cycle_free > nb_cycle - i_cycle){ nb_cycle_free = nb_cycle - i_cycle; }
+        uint32_t nb_turn = nb_cycle_free / loop_length;
+        nb_skip = nb_turn * loop_length;
+
+        f_clock_divider += nb_skip; // variables of cpu are the same at end of each turn
+        cycle_count += nb_skip;
+        events.nb_opcode += nb_turn * (events.nb_opcode - loop_nb_opcode);
+        if(nb_skip > 0){
+            debug_busy_loop_cycles_skipped += nb_skip;
+            debug_busy_loop_nb_skip += 1;
+        }
+    }
+
+    // new reference passage
+    loop_active = true;
+    loop_pc = program_counter;
+    loop_cycle = i_cycle + nb_skip;
+    loop_nb_opcode = events.nb_opcode;
+    loop_divider = f_clock_divider;
+    loop_state = state;
+    return nb_skip;
+}
+
+template <class CPU>
+void SM5XXCore<CPU>::get_busy_loop_state(Busy_Loop_State& state){
+    // input (k, alpha, beta) not needed : no change during a batch of cycles
+    state.size = 0;
+    state.add(program_counter);
+    state.add(s_buffer_program_counter);
+    state.add(ram_address);
+    state.add(carry);
+    state.add(accumulator);
+    state.add(gamma_flag_second);
+    state.add(bp_lcd_blackplate);
+    state.add(cpu_frequency_divider);
+    state.add(flag_time_update_screen);
+    state.add(stop_cpu);
+    self().add_busy_loop_state(state); // variables of each cpu
+}
+
+
+
+/////////////////////////////// Translated rom ///////////////////////////////
+
+template <class CPU>
+bool SM5XXCore<CPU>::load_translated_rom(const uint8_t* file_hex, size_t size_hex){
+    // called after creation of cpu (get_cpu) -> nothing linked for this rom = interpreter
+    translated_block.clear();
+    const Translated_Rom_Info* info = find_translated_rom(file_hex, size_hex, self().get_cpu_type_id());
+    if(info == nullptr){ return false; }
+
+    const Translated_Block<CPU>* blocks = static_cast<const Translated_Block<CPU>*>(info->blocks);
+    translated_block.assign(PC_INDEX_SIZE, nullptr);
+    for(uint16_t i = 0; i < info->nb_block; i++){ translated_block[blocks[i].index] = &blocks[i]; }
+    return true;
+}
+
+template <class CPU>
+uint32_t SM5XXCore<CPU>::run_translated_block(uint32_t i_cycle, uint32_t nb_cycle, Cycle_Events& events, bool& after_jump){
+    // block is used only if it can not pass next clock event, end of batch or change sound
+    // -> same result as opcode per opcode. Output -> nb cycles used (0 = no block)
+    uint32_t index = (program_counter.col * 16 + program_counter.line) * 64 + program_counter.word;
+    if(index >= PC_INDEX_SIZE){ return 0; }
+    const Translated_Block<CPU>* block = translated_block[index];
+    if(block == nullptr){ return 0; }
+
+    uint32_t max_cycle = block->max_cycle * cpu_frequency_divider;
+    if(max_cycle > nb_cycle - i_cycle || max_cycle > cycles_before_clock_event() || !self().sound_is_static()){ return 0; }
+
+    uint32_t nb_opcode = 0;
+    uint32_t nb_cycle_used = block->run(self(), nb_opcode);
+    if(nb_cycle_used > max_cycle){ translated_rom = false; } // max_cycle of generated file wrong (old generator) -> interpreter now
+    events.nb_opcode += nb_opcode;
+    after_jump = block->end_by_jump; // busy loop detector
+    return nb_cycle_used;
+}
+
+
+
+/////////////////////////////// Block cache ///////////////////////////////
+
+template <class CPU>
+void SM5XXCore<CPU>::clear_block_cache(){
+    block_cache_index.clear(); // allocated again at first block
+    cached_block.clear();
+    block_cache_opcode.clear();
+    debug_block_cache_nb_block = 0;
+    for(uint8_t i = 0; i < MAX_FUSED_PAIR; i++){ debug_fused_pair_count[i] = 0; }
+}
+
+template <class CPU>
+const Fused_Pair<CPU>* SM5XXCore<CPU>::find_fused_pair(Opcode_Handler first, Opcode_Handler second){
+    uint8_t nb_pair = 0;
+    const Fused_Pair<CPU>* pairs = CPU::get_fused_pairs(nb_pair);
+    for(uint8_t i = 0; i < nb_pair; i++){
+        if(pairs[i].first == first && pairs[i].second == second){ return &pairs[i]; }
+    }
+    return nullptr;
+}
+
+template <class CPU>
+uint16_t SM5XXCore<CPU>::decode_block(){
+    // block from program counter : opcodes until the first which can end it (jump, skip, 2 octets)
+    // + opcode after it if both are a fused pair. Rom read like execute_next_opcode() -> same opcodes as interpreter
+    // output -> index of block in cached_block, BLOCK_NONE if first opcode is a barrier
+    ProgramCounter start = program_counter;
+    Cached_Block block = { uint32_t(block_cache_opcode.size()), 0, 0, false };
+    bool first_of_pair = false; // previous opcode can be first of a pair
+    bool end_of_block = false; // previous opcode end the block, except if next one is fused with it
+
+    while(block.nb_opcode < MAX_OPCODE_PER_BLOCK && block.max_cycle + 16 <= MAX_CYCLE_PER_BLOCK){
+        uint8_t opcode = self().read_rom_value();
+        const Opcode_Decode& decode = decode_table[opcode];
+        if(decode.block_kind == BLOCK_BARRIER){ break; }
+
+        const Fused_Pair<CPU>* pair = nullptr;
+        if(first_of_pair){ pair = find_fused_pair(block_cache_opcode.back().handler, decode.handler); }
+        if(end_of_block && pair == nullptr){ break; }
+        if(pair != nullptr){
+            uint8_t nb_pair = 0;
+            block_cache_opcode.back().fused = pair->run;
+            block_cache_opcode.back().fused_id = uint8_t(pair - CPU::get_fused_pairs(nb_pair));
+        }
+
+        uint8_t word_exec = decode.no_pc_increase ? program_counter.word : next_word[program_counter.word & ROM_WORD];
+        block_cache_opcode.push_back({ decode.handler, nullptr, opcode, decode.nb_cycle, program_counter.word, word_exec, 0 });
+        block.nb_opcode += 1;
+        block.max_cycle += decode.nb_cycle + 2; // + extra cycles of some instructions (TM, DTW, ...)
+        block.end_by_jump = decode.no_pc_increase; // same as execute_next_opcode()
+        program_counter.word = word_exec;
+        if(end_of_block){ break; }
+
+        first_of_pair = (pair == nullptr) && ((opcode & 0xF0) != 0x20); // LAX : next opcode depend of LAX after it
+        if(decode.block_kind == BLOCK_END){
+            end_of_block = true;
+            first_of_pair = first_of_pair && !decode.no_pc_increase;
+            if(decode.nb_byte == 2){ adding_program_counter(); } // parameter
+        }
+    }
+
+    // worst case of last opcode : skip of next one
+    if(block.nb_opcode > 0){
+        const Cached_Opcode<CPU>& last = block_cache_opcode.back();
+        if(decode_table[last.opcode].block_kind == BLOCK_END && (last.opcode & 0xF0) == 0x20){ // LAX : all next LAX are skipped
+            program_counter.word = last.word_exec;
+            while((self().read_rom_value() & 0xF0) == 0x20 && block.max_cycle + 2 <= MAX_CYCLE_PER_BLOCK){
+                block.max_cycle += 2;
+                adding_program_counter();
+            }
+            if((self().read_rom_value() & 0xF0) == 0x20){ block.max_cycle = MAX_CYCLE_PER_BLOCK + 1; } // never used
+        }
+        else if(decode_table[last.opcode].block_kind == BLOCK_END){ block.max_cycle += 4; } // skip of an opcode on 2 octets
+    }
+    program_counter = start;
+
+    if(block.nb_opcode == 0){ return BLOCK_NONE; }
+    cached_block.push_back(block);
+    debug_block_cache_nb_block += 1;
+    return uint16_t(cached_block.size() - 1);
+}
+
+template <class CPU>
+uint32_t SM5XXCore<CPU>::run_cached_block(uint32_t i_cycle, uint32_t nb_cycle, Cycle_Events& events, bool& after_jump){
+    // same conditions as run_translated_block() -> same result as opcode per opcode
+    // output -> nb cycles used (0 = no block)
+    uint32_t index = (program_counter.col * 16 + program_counter.line) * 64 + program_counter.word;
+    if(index >= PC_INDEX_SIZE){ return 0; }
+    if(block_cache_index.empty()){ block_cache_index.assign(PC_INDEX_SIZE, BLOCK_NOT_DECODED); }
+
+    uint16_t i_block = block_cache_index[index];
+    if(i_block == BLOCK_NOT_DECODED){
+        i_block = decode_block();
+        block_cache_index[index] = i_block;
+        debug_block_cache_miss += 1;
+    }
+    else { debug_block_cache_hit += 1; }
+    if(i_block == BLOCK_NONE){ return 0; }
+
+    const Cached_Block& block = cached_block[i_block];
+    uint32_t max_cycle = block.max_cycle * cpu_frequency_divider;
+    if(max_cycle > nb_cycle - i_cycle || max_cycle > cycles_before_clock_event() || !self().sound_is_static()){ return 0; }
+
+    // only the last opcode (or pair) can skip the next one -> always all opcodes, except second of last pair
+    uint32_t nb_cycle_used = 0;
+    fused_second_skipped = false;
+    const Cached_Opcode<CPU>* opcode = &block_cache_opcode[block.first_opcode];
+    const Cached_Opcode<CPU>* end = opcode + block.nb_opcode;
+    while(opcode < end){
+        if(opcode->fused != nullptr){
+            nb_cycle_used += opcode->fused(self(), opcode);
+            opcode += 2;
+        }
+        else {
+            nb_cycle_used += execute_block_opcode(opcode->handler, opcode->opcode, opcode->nb_cycle, opcode->word_exec);
+            opcode += 1;
+        }
+    }
+    uint32_t nb_opcode = block.nb_opcode - (fused_second_skipped ? 1 : 0);
+    events.nb_opcode += nb_opcode;
+    debug_block_cache_nb_opcode += nb_opcode;
+    after_jump = block.end_by_jump && !fused_second_skipped; // busy loop detector
+    return nb_cycle_used;
+}
+
+template <class CPU>
+std::string SM5XXCore<CPU>::debug_fused_pair(){
+    // nb execution of each fused pair (this game)
+    uint8_t nb_pair = 0;
+    const Fused_Pair<CPU>* pairs = CPU::get_fused_pairs(nb_pair);
+    std::string result = "Fused:";
+    for(uint8_t i = 0; i < nb_pair; i++){
+        result += std::string(" ") + pairs[i].name + "=" + std::to_string(debug_fused_pair_count[i]);
+    }
+    return result;
+}
+
+
+
+/////////////////////////////// Snapshot ///////////////////////////////
+
+template <class CPU>
+void SM5XXCore<CPU>::snapshot(void* buffer){
+    // size of each copy known at compile time -> no loop, no call
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+    std::apply([&](auto... member){
+        ((memcpy(out, &(self().*member), member_size(member)), out += member_size(member)), ...);
+    }, state_members());
+}
+
+template <class CPU>
+void SM5XXCore<CPU>::restore(const void* buffer){
+    const uint8_t* in = static_cast<const uint8_t*>(buffer);
+    std::apply([&](auto... member){
+        ((memcpy(&(self().*member), in, member_size(member)), in += member_size(member)), ...);
+    }, state_members());
+
+    loop_active = false; // reference passage of busy loop is from another time
+    pack_segments();
+    segments_state_are_update = true; // segments restored -> redraw
+}
+
+
+template <class CPU>
+void SM5XXCore<CPU>::pack_segments(){
+    using Segment_On = decltype(CPU::segment_on);
+    constexpr Segment_Layout layout = CPU::SEGMENT_LAYOUT;
+    static_assert(layout.nb_col == std::extent_v<Segment_On, 0> && layout.nb_line == std::extent_v<Segment_On, 1>
+                    , "SEGMENT_LAYOUT not size of segment_on");
+    static_assert(layout.nb_col * layout.nb_line * layout.nb_word <= SEGMENT_BITS_MAX, "segments of cpu not in segment_bits");
+    pack_segment_bits(&self().segment_on[0][0], layout);
+}
+
+
+
+//////////////////////////////////// Usefull function ////////////////////////////////////
+
+template <class CPU>
+uint8_t SM5XXCore<CPU>::get_parameter_of_opcode(bool add_pc){
+    uint8_t param = self().read_rom_value();
+    if(add_pc){ adding_program_counter(); } // move to next instruction because now we are on parameter value
+    return param;
+}
+
+
+
+#include "SM5XX/SM5XX_core_instruction.h"
@@ -0,0 +1,559 @@
+#pragma once
+#include "SM5XX/SM5XX_core.h"
+#include <memory>
+#include <string>
+
+
+// Lockstep interpreter : many instances of the same rom (search of inputs, training of bot), one lane per instance.
+// Variables of all lanes are arrays (structure of arrays) : opcode is read and decoded one time,
+// then executed on all lanes at same program counter with a mask. Loops on lanes have a fixed size
+// without branch -> vectorized by compiler (SSE / AVX / NEON of host, nothing special on 3DS).
+// Lanes at another program counter wait next turn (divergence after a test or an input).
+//
+// A lane alone too long (other lanes elsewhere) is moved to a scalar cpu (run_cycles, block cache, ...)
+// and come back at start of a frame if it is again at program counter of lockstep lanes.
+// Result of each lane is the same as step() of scalar cpu. No sound logic -> SM5A and SM510 only.
+//
+// Each cpu : X_Lockstep final : public SM5XX_Lockstep<X_Lockstep, X> (same idea as SM5XXCore)
+
+constexpr uint8_t LOCKSTEP_NB_LANE = 16; // max lanes (16 x 8 bit = 1 vector register of 128 bit)
+constexpr uint32_t LOCKSTEP_MAX_ALONE = 512; // opcodes executed alone in a row -> lane moved to scalar cpu
+constexpr uint16_t LOCKSTEP_RAM_SIZE = 8 * 16; // cells of biggest ram (SM510)
+constexpr uint8_t LANE_ON = 0xFF; // value of mask
+
+
+template <class Lockstep>
+struct Lane_Instruction {
+    Opcode_Handler scalar; // handler of decode table of scalar cpu
+    void (Lockstep::*lane)(); // same instruction on lanes of mask
+};
+
+
+template <class Lockstep, class CPU>
+class SM5XX_Lockstep {
+public :
+    using Lane_Handler = void (Lockstep::*)();
+
+    // all lanes start as a copy of cpu (rom, variables, input). cpu not used after
+    void load(const CPU& reference, uint8_t nb_lane = LOCKSTEP_NB_LANE);
+    void run_frame(uint32_t nb_cycle); // same as nb_cycle call of step() on each lane
+
+    void input_set(uint8_t lane, int group, int line, bool state); // same as SM5XX::input_set
+    void copy_input(uint8_t lane, const CPU& cpu); // input of a cpu (Virtual_Input linked to it)
+    void store_lane(uint8_t lane, CPU& cpu); // variables of lane -> cpu of same rom
+
+    bool get_segments_state(uint8_t lane, uint8_t col, uint8_t line, uint8_t word);
+    uint8_t get_nb_lane() const { return nb_lane; }
+    uint64_t get_cycle_count(uint8_t lane) const;
+    bool lane_is_scalar(uint8_t lane) const { return lane_scalar[lane]; }
+
+    std::string debug_lockstep(); // lanes by opcode, lanes moved to scalar cpu
+
+    uint64_t debug_nb_turn = 0; // opcodes decoded by lockstep
+    uint64_t debug_nb_lane_opcode = 0; // opcodes executed by lanes in lockstep
+    uint64_t debug_nb_scalar_opcode = 0; // opcodes executed by lanes on scalar cpu
+    uint32_t debug_nb_eject = 0;
+    uint32_t debug_nb_join = 0;
+
+private :
+    Lockstep& self(){ return static_cast<Lockstep&>(*this); }
+
+    struct Lane_Table { Lane_Handler entry[256]; };
+    static Lane_Table build_lane_table();
+
+    void execute_turn(uint8_t leader);
+    void advance_clock(uint8_t lane, uint32_t nb_cycle);
+    bool sleep_lane(uint8_t lane); // true -> lane wake up, opcode to execute
+    bool step_clock_divider(uint8_t lane);
+    uint32_t cycles_before_clock_event(uint8_t lane){
+        if(((f_clock_divider[lane] >> 9) & 0x01) != flag_time_update_screen[lane]){ return 0; } // same as SM5XXCore
+        return 0x200 - (f_clock_divider[lane] & 0x1FF) - 1;
+    }
+    bool condition_to_wake_up(uint8_t lane);
+
+    void eject_lane(uint8_t lane); // -> scalar cpu
+    void join_scalar_lanes(); // scalar cpu at same place as lockstep -> back in lockstep
+    void run_scalar_lane(uint8_t lane, uint32_t nb_cycle);
+    void load_common(uint8_t lane, const CPU& cpu);
+    void store_common(uint8_t lane, CPU& cpu);
+
+    std::unique_ptr<CPU> scalar_cpu[LOCKSTEP_NB_LANE]; // allocated at first eject of lane, kept after join
+    bool lane_scalar[LOCKSTEP_NB_LANE] = {};
+    uint32_t nb_alone[LOCKSTEP_NB_LANE];
+    uint32_t remain_cycle[LOCKSTEP_NB_LANE]; // of current frame
+
+protected :
+    std::unique_ptr<CPU> model; // copy of reference : rom, decode table, time addresses (scalar cpu are copy of it)
+    const Opcode_Decode* decode_table = nullptr;
+    const uint8_t* rom = nullptr; // rom of model, [col][line][word] of scalar cpu
+    uint16_t rom_size = 0;
+    uint8_t rom_nb_line = 0;
+    uint8_t nb_lane = 0;
+
+    // turn -> opcode of leader on lanes of mask
+    uint8_t curr_opcode;
+    uint8_t leader;
+    uint8_t mask[LOCKSTEP_NB_LANE];
+
+    // variables of SM5XX, 1 per lane
+    uint8_t pc_col[LOCKSTEP_NB_LANE], pc_line[LOCKSTEP_NB_LANE], pc_word[LOCKSTEP_NB_LANE];
+    uint8_t s_col[LOCKSTEP_NB_LANE], s_line[LOCKSTEP_NB_LANE], s_word[LOCKSTEP_NB_LANE];
+    uint8_t ram_col[LOCKSTEP_NB_LANE], ram_line[LOCKSTEP_NB_LANE];
+    uint8_t ram[LOCKSTEP_RAM_SIZE][LOCKSTEP_NB_LANE]; // cell = col * line size of cpu + line
+    uint8_t carry[LOCKSTEP_NB_LANE];
+    uint8_t accumulator[LOCKSTEP_NB_LANE];
+    uint16_t f_clock_divider[LOCKSTEP_NB_LANE];
+    uint8_t gamma_flag_second[LOCKSTEP_NB_LANE];
+    uint8_t k_input[8][LOCKSTEP_NB_LANE];
+    uint8_t alpha_input[LOCKSTEP_NB_LANE], beta_input[LOCKSTEP_NB_LANE];
+    uint8_t bp_lcd_blackplate[LOCKSTEP_NB_LANE];
+    uint8_t is_sleep[LOCKSTEP_NB_LANE];
+    uint8_t flag_time_update_screen[LOCKSTEP_NB_LANE];
+    uint8_t stop_cpu[LOCKSTEP_NB_LANE];
+    uint8_t segments_state_are_update[LOCKSTEP_NB_LANE];
+    int32_t cycle_curr_opcode[LOCKSTEP_NB_LANE];
+    uint64_t cycle_count[LOCKSTEP_NB_LANE];
+    bool input_no_multiplex = false;
+
+    // rom of program counter of leader (all lanes of mask), 0x00 out of rom
+    uint8_t read_rom(uint8_t col, uint8_t line, uint8_t word){
+        uint32_t index = (uint32_t(col) * rom_nb_line + line) * ROM_WORD + word;
+        return (index < rom_size) ? rom[index] : 0x00;
+    }
+    uint8_t read_rom_leader(){ return read_rom(pc_col[leader], pc_line[leader], pc_word[leader]); }
+    uint8_t get_parameter_of_opcode(bool add_pc = true);
+    void skip_instruction(const uint8_t* skip); // lanes of skip are at program counter of leader
+    void skip_instruction_lane(uint8_t lane); // after a jump (RTN)
+
+    void fast_forward_clock(uint8_t lane, uint32_t nb_cycle){ f_clock_divider[lane] += nb_cycle; } // can be hidden by cpu
+
+    static uint8_t select(uint8_t mask, uint8_t value, uint8_t other){ return (value & mask) | (other & ~mask); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Opcode -> instruction on lanes (same as SM5XX_core_instruction.h) ///////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+protected :
+    void g_op_lbl();
+    void g_op_exbla();
+    void g_op_lax();
+    void g_op_lda();
+    void g_op_add();
+    void g_op_add11();
+    void g_op_adx();
+    void g_op_coma();
+    void g_op_rc();
+    void g_op_sc();
+    void g_op_exc();
+    void g_op_ta();
+    void g_op_tb();
+    void g_op_tc();
+    void g_op_tam();
+    void g_op_tis();
+    void g_op_tmi();
+    void g_op_ta0();
+    void g_op_tabl();
+    void g_op_rm();
+    void g_op_sm();
+    void g_op_cend();
+    void g_op_idiv();
+    void g_op_illegal();
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Lanes ///////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class Lockstep, class CPU>
+typename SM5XX_Lockstep<Lockstep, CPU>::Lane_Table SM5XX_Lockstep<Lockstep, CPU>::build_lane_table(){
+    // instruction of each opcode from decode table of scalar cpu -> same decode, no second switch
+    Lane_Table table;
+    const Opcode_Decode* decode = CPU::get_decode_table();
+    uint8_t nb_instruction = 0;
+    const Lane_Instruction<Lockstep>* instructions = Lockstep::get_lane_instructions(nb_instruction);
+    for(int opcode = 0; opcode < 256; opcode++){
+        table.entry[opcode] = &SM5XX_Lockstep::g_op_illegal;
+        for(uint8_t i = 0; i < nb_instruction; i++){
+            if(instructions[i].scalar == decode[opcode].handler){ table.entry[opcode] = instructions[i].lane; break; }
+        }
+    }
+    return table;
+}
+
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::load(const CPU& reference, uint8_t nb_lane_){
+    model = std::make_unique<CPU>(reference);
+    decode_table = CPU::get_decode_table();
+    rom = &model->rom[0][0][0];
+    rom_size = sizeof(model->rom);
+    rom_nb_line = sizeof(model->rom[0]) / sizeof(model->rom[0][0]);
+    input_no_multiplex = reference.input_no_multiplex;
+
+    nb_lane = (nb_lane_ > LOCKSTEP_NB_LANE) ? LOCKSTEP_NB_LANE : nb_lane_;
+    for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){
+        load_common(lane, reference); // lanes not used stay valid (never executed)
+        self().load_lane(lane, reference);
+        lane_scalar[lane] = false;
+        nb_alone[lane] = 0;
+        remain_cycle[lane] = 0;
+    }
+    debug_nb_turn = 0;
+    debug_nb_lane_opcode = 0;
+    debug_nb_scalar_opcode = 0;
+    debug_nb_eject = 0;
+    debug_nb_join = 0;
+}
+
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::load_common(uint8_t lane, const CPU& cpu){
+    pc_col[lane] = cpu.program_counter.col;
+    pc_line[lane] = cpu.program_counter.line;
+    pc_word[lane] = cpu.program_counter.word;
+    s_col[lane] = cpu.s_buffer_program_counter.col;
+    s_line[lane] = cpu.s_buffer_program_counter.line;
+    s_word[lane] = cpu.s_buffer_program_counter.word;
+    ram_col[lane] = cpu.ram_address.col;
+    ram_line[lane] = cpu.ram_address.line;
+    carry[lane] = cpu.carry;
+    accumulator[lane] = cpu.accumulator;
+    f_clock_divider[lane] = cpu.f_clock_divider;
+    gamma_flag_second[lane] = cpu.gamma_flag_second;
+    for(int i = 0; i < 8; i++){ k_input[i][lane] = cpu.k_input[i]; }
+    alpha_input[lane] = cpu.alpha_input;
+    beta_input[lane] = cpu.beta_input;
+    bp_lcd_blackplate[lane] = cpu.bp_lcd_blackplate;
+    is_sleep[lane] = cpu.is_sleep;
+    flag_time_update_screen[lane] = cpu.flag_time_update_screen;
+    stop_cpu[lane] = cpu.stop_cpu;
+    segments_state_are_update[lane] = cpu.segments_state_are_update;
+    cycle_curr_opcode[lane] = (cpu.cycle_curr_opcode > 0) ? cpu.cycle_curr_opcode : 0;
+    cycle_count[lane] = cpu.cycle_count;
+}
+
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::store_common(uint8_t lane, CPU& cpu){
+    cpu.program_counter = { pc_col[lane], pc_line[lane], pc_word[lane] };
+    cpu.s_buffer_program_counter = { s_col[lane], s_line[lane], s_word[lane] };
+    cpu.ram_address = { ram_col[lane], ram_line[lane] };
+    cpu.carry = carry[lane];
+    cpu.accumulator = accumulator[lane];
+    cpu.f_clock_divider = f_clock_divider[lane];
+    cpu.gamma_flag_second = gamma_flag_second[lane];
+    for(int i = 0; i < 8; i++){ cpu.k_input[i] = k_input[i][lane]; }
+    cpu.alpha_input = alpha_input[lane];
+    cpu.beta_input = beta_input[lane];
+    cpu.bp_lcd_blackplate = bp_lcd_blackplate[lane];
+    cpu.is_sleep = is_sleep[lane];
+    cpu.flag_time_update_screen = flag_time_update_screen[lane];
+    cpu.stop_cpu = stop_cpu[lane];
+    cpu.segments_state_are_update = segments_state_are_update[lane];
+    cpu.cycle_curr_opcode = cycle_curr_opcode[lane];
+    cpu.cycle_count = cycle_count[lane];
+}
+
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::input_set(uint8_t lane, int group, int line, bool state){
+    if(lane_scalar[lane]){ scalar_cpu[lane]->input_set(group, line, state); return; }
+    if(line == 8){ alpha_input[lane] = state; }
+    else if(line == 9){ beta_input[lane] = state; }
+    else if(state){ k_input[group][lane] = k_input[group][lane] | (0x01 << line); }
+    else { k_input[group][lane] = k_input[group][lane] & ~(0x01 << line); }
+}
+
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::copy_input(uint8_t lane, const CPU& cpu){
+    if(lane_scalar[lane]){
+        for(int i = 0; i < 8; i++){ scalar_cpu[lane]->k_input[i] = cpu.k_input[i]; }
+        scalar_cpu[lane]->alpha_input = cpu.alpha_input;
+        scalar_cpu[lane]->beta_input = cpu.beta_input;
+        return;
+    }
+    for(int i = 0; i < 8; i++){ k_input[i][lane] = cpu.k_input[i]; }
+    alpha_input[lane] = cpu.alpha_input;
+    beta_input[lane] = cpu.beta_input;
+}
+
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::store_lane(uint8_t lane, CPU& cpu){
+    if(lane_scalar[lane]){ cpu = *scalar_cpu[lane]; return; }
+    store_common(lane, cpu);
+    self().store_lane_cpu(lane, cpu);
+}
+
+
+template <class Lockstep, class CPU>
+bool SM5XX_Lockstep<Lockstep, CPU>::get_segments_state(uint8_t lane, uint8_t col, uint8_t line, uint8_t word){
+    if(lane_scalar[lane]){ return scalar_cpu[lane]->get_segments_state(col, line, word); }
+    return self().get_segments_state_lane(lane, col, line, word);
+}
+
+
+template <class Lockstep, class CPU>
+uint64_t SM5XX_Lockstep<Lockstep, CPU>::get_cycle_count(uint8_t lane) const {
+    if(lane_scalar[lane]){ return scalar_cpu[lane]->cycle_count; }
+    return cycle_count[lane];
+}
+
+
+template <class Lockstep, class CPU>
+std::string SM5XX_Lockstep<Lockstep, CPU>::debug_lockstep(){
+    char buffer[128];
+    double lanes = debug_nb_turn ? double(debug_nb_lane_opcode) / debug_nb_turn : 0;
+    snprintf(buffer, sizeof(buffer), "Lockstep: %.2f lanes/opcode, %llu opcodes scalar, eject %u, join %u", lanes,
+                (unsigned long long)debug_nb_scalar_opcode, debug_nb_eject, debug_nb_join);
+    return buffer;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Run /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::run_frame(uint32_t nb_cycle){
+    join_scalar_lanes();
+
+    for(uint8_t lane = 0; lane < nb_lane; lane++){
+        remain_cycle[lane] = nb_cycle;
+        if(lane_scalar[lane]){ continue; }
+        uint32_t nb_end = cycle_curr_opcode[lane]; // end of opcode of previous frame
+        advance_clock(lane, (nb_end < nb_cycle) ? nb_end : nb_cycle);
+    }
+
+    while(true){
+        // leader = first lane which need an opcode (sleep lanes wait here until wake up or end of frame)
+        int first = -1;
+        for(uint8_t lane = 0; lane < nb_lane; lane++){
+            if(lane_scalar[lane] || remain_cycle[lane] == 0){ continue; }
+            if(is_sleep[lane] && !sleep_lane(lane)){ continue; }
+            first = lane;
+            break;
+        }
+        if(first < 0){ break; }
+        execute_turn(uint8_t(first));
+    }
+
+    for(uint8_t lane = 0; lane < nb_lane; lane++){
+        if(lane_scalar[lane]){ run_scalar_lane(lane, remain_cycle[lane]); } // ejected during frame -> rest of it
+    }
+}
+
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::execute_turn(uint8_t leader_){
+    // opcode of leader on all lanes at same program counter
+    leader = leader_;
+    const uint8_t col = pc_col[leader], line = pc_line[leader], word = pc_word[leader];
+    uint8_t nb_mask = 0;
+    for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){
+        bool same = (lane < nb_lane) && !lane_scalar[lane] && remain_cycle[lane] > 0 && !is_sleep[lane]
+                    && pc_col[lane] == col && pc_line[lane] == line && pc_word[lane] == word;
+        mask[lane] = same ? LANE_ON : 0x00;
+        nb_mask += same;
+    }
+
+    uint32_t line_end = (uint32_t(col) * rom_nb_line + line) * ROM_WORD + 63;
+    if(line_end >= rom_size){ // out of rom (bug of rom) -> read of scalar cpu outside of its rom, not emulated here
+        for(uint8_t lane = 0; lane < nb_lane; lane++){ if(mask[lane]){ eject_lane(lane); } }
+        return;
+    }
+
+    curr_opcode = read_rom(col, line, word);
+    const Opcode_Decode& decode = decode_table[curr_opcode];
+    uint8_t word_next = decode.no_pc_increase ? word : next_word[word & ROM_WORD];
+    for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){
+        cycle_curr_opcode[lane] = mask[lane] ? decode.nb_cycle : cycle_curr_opcode[lane];
+        pc_word[lane] = select(mask[lane], word_next, pc_word[lane]);
+    }
+
+    static const Lane_Table table = build_lane_table();
+    self().execute_opcode(table.entry[curr_opcode]);
+    debug_nb_turn += 1;
+    debug_nb_lane_opcode += nb_mask;
+
+    // cycles of opcode : in one time if no clock event during them (same as run_cycles)
+    for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){
+        if(!mask[lane]){ continue; }
+        uint32_t nb_cycle = cycle_curr_opcode[lane];
+        if(nb_cycle > remain_cycle[lane]){ nb_cycle = remain_cycle[lane]; }
+        if(nb_cycle <= cycles_before_clock_event(lane)){
+            self().fast_forward_clock(lane, nb_cycle);
+            cycle_curr_opcode[lane] -= nb_cycle;
+            remain_cycle[lane] -= nb_cycle;
+            cycle_count[lane] += nb_cycle;
+        }
+        else { advance_clock(lane, nb_cycle); }
+    }
+
+    // lane alone too long -> scalar cpu (faster alone)
+    if(nb_mask == 1){
+        nb_alone[leader] += 1;
+        if(nb_alone[leader] > LOCKSTEP_MAX_ALONE){ eject_lane(leader); }
+    }
+    else {
+        for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){ if(mask[lane]){ nb_alone[lane] = 0; } }
+    }
+}
+
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::advance_clock(uint8_t lane, uint32_t nb_cycle){
+    // nb_cycle of lane : clock divider in one time until next clock event, cycle per cycle on it
+    cycle_curr_opcode[lane] -= nb_cycle;
+    remain_cycle[lane] -= nb_cycle;
+    cycle_count[lane] += nb_cycle;
+    while(nb_cycle > 0){
+        uint32_t nb_free = cycles_before_clock_event(lane);
+        if(nb_cycle <= nb_free){
+            self().fast_forward_clock(lane, nb_cycle);
+            return;
+        }
+        self().fast_forward_clock(lane, nb_free);
+        step_clock_divider(lane);
+        nb_cycle -= nb_free + 1;
+    }
+}
+
+
+template <class Lockstep, class CPU>
+bool SM5XX_Lockstep<Lockstep, CPU>::step_clock_divider(uint8_t lane){
+    // same as SM5XXCore::step_clock_divider
+    f_clock_divider[lane] = (f_clock_divider[lane] + 1) & 0x7FFF;
+    if(f_clock_divider[lane] == 0x00){ gamma_flag_second[lane] = true; }
+    if(self().condition_to_update_segment(lane)){ self().update_segment(lane); return true; }
+    return false;
+}
+
+
+template <class Lockstep, class CPU>
+bool SM5XX_Lockstep<Lockstep, CPU>::condition_to_wake_up(uint8_t lane){
+    uint8_t result = 0x00;
+    for(int i = 0; i < 8; i++){ result |= k_input[i][lane]; }
+    if(!alpha_input[lane] || !beta_input[lane]){ result |= 0x01; }
+    return gamma_flag_second[lane] || (result != 0x00);
+}
+
+
+template <class Lockstep, class CPU>
+bool SM5XX_Lockstep<Lockstep, CPU>::sleep_lane(uint8_t lane){
+    // lane sleep : only clock until wake up (gamma or button) or end of frame
+    while(remain_cycle[lane] > 0){
+        if(condition_to_wake_up(lane)){
+            self().wake_up(lane);
+            return true;
+        }
+        uint32_t nb_skip = cycles_before_clock_event(lane);
+        if(nb_skip > remain_cycle[lane]){ nb_skip = remain_cycle[lane]; }
+        if(nb_skip >= 2){
+            self().fast_forward_clock(lane, nb_skip);
+            remain_cycle[lane] -= nb_skip;
+            cycle_count[lane] += nb_skip;
+            continue;
+        }
+        cycle_curr_opcode[lane] = 1; // same as execute_next_opcode() in sleep
+        advance_clock(lane, 1);
+    }
+    return false;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Scalar fallback /////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::eject_lane(uint8_t lane){
+    if(!scalar_cpu[lane]){ scalar_cpu[lane] = std::make_unique<CPU>(*model); } // rom, block cache, translated rom
+    store_common(lane, *scalar_cpu[lane]);
+    self().store_lane_cpu(lane, *scalar_cpu[lane]);
+    lane_scalar[lane] = true;
+    debug_nb_eject += 1;
+}
+
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::join_scalar_lanes(){
+    // at start of frame : scalar cpu between 2 opcodes at program counter of a lockstep lane
+    for(uint8_t lane = 0; lane < nb_lane; lane++){
+        if(!lane_scalar[lane]){ continue; }
+        CPU& cpu = *scalar_cpu[lane];
+        if(cpu.cycle_curr_opcode > 0 || cpu.is_sleep){ continue; }
+
+        bool same_place = false;
+        for(uint8_t other = 0; other < nb_lane && !same_place; other++){
+            same_place = !lane_scalar[other] && !is_sleep[other] && pc_col[other] == cpu.program_counter.col
+                        && pc_line[other] == cpu.program_counter.line && pc_word[other] == cpu.program_counter.word;
+        }
+        if(!same_place){ continue; }
+
+        load_common(lane, cpu);
+        self().load_lane(lane, cpu);
+        lane_scalar[lane] = false;
+        nb_alone[lane] = 0;
+        debug_nb_join += 1;
+    }
+}
+
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::run_scalar_lane(uint8_t lane, uint32_t nb_cycle){
+    Cycle_Events cycle_events;
+    CPU& cpu = *scalar_cpu[lane];
+    while(nb_cycle > 0){
+        nb_cycle -= cpu.run_cycles(nb_cycle, cycle_events);
+        debug_nb_scalar_opcode += cycle_events.nb_opcode;
+    }
+    remain_cycle[lane] = 0;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Usefull function ////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class Lockstep, class CPU>
+uint8_t SM5XX_Lockstep<Lockstep, CPU>::get_parameter_of_opcode(bool add_pc){
+    uint8_t param = read_rom_leader();
+    if(add_pc){
+        uint8_t word = next_word[pc_word[leader] & ROM_WORD];
+        for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){ pc_word[lane] = select(mask[lane], word, pc_word[lane]); }
+    }
+    return param;
+}
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::skip_instruction(const uint8_t* skip){
+    // same as SM5XXCore::skip_instruction, opcode skipped is the same for all lanes
+    const Opcode_Decode& decode = decode_table[read_rom_leader()];
+    uint8_t word = next_word[pc_word[leader] & ROM_WORD];
+    if(decode.nb_byte == 2){ word = next_word[word]; }
+    for(uint8_t lane = 0; lane < LOCKSTEP_NB_LANE; lane++){
+        cycle_curr_opcode[lane] += skip[lane] ? decode.nb_cycle : 0;
+        pc_word[lane] = select(skip[lane], word, pc_word[lane]);
+    }
+}
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::skip_instruction_lane(uint8_t lane){
+    const Opcode_Decode& decode = decode_table[read_rom(pc_col[lane], pc_line[lane], pc_word[lane])];
+    uint8_t word = next_word[pc_word[lane] & ROM_WORD];
+    if(decode.nb_byte == 2){ word = next_word[word]; }
+    cycle_curr_opcode[lane] += decode.nb_cycle;
+    pc_word[lane] = word;
+}
+
+
+
+#include "SM5XX/SM5XX_lockstep_instruction.h"
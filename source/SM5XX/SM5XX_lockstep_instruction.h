@@ -0,0 +1,226 @@
+#pragma once
+#include "SM5XX/SM5XX_lockstep.h"
+
+
+// Instructions of SM5XX_core_instruction.h on lanes of mask (opcode of leader).
+// Lane not in mask keep its value (select) -> loops without branch.
+// template -> included at end of SM5XX_lockstep.h, instantiate by each cpu (X_lockstep.cpp)
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// RAM adress //////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_lbl(){
+    uint8_t param = get_parameter_of_opcode();
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        ram_col[i] = select(mask[i], (param & 0x70) >> 4, ram_col[i]);
+        ram_line[i] = select(mask[i], param & 0x0F, ram_line[i]);
+    }
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_exbla(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t tmp = ram_line[i];
+        ram_line[i] = select(mask[i], accumulator[i], ram_line[i]);
+        accumulator[i] = select(mask[i], tmp, accumulator[i]);
+    }
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Data transfert //////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_lax(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ accumulator[i] = select(mask[i], 0x0F & curr_opcode, accumulator[i]); }
+    while( (0xF0 & read_rom_leader()) == 0x20){ skip_instruction(mask); } // same rom for all lanes
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_lda(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        accumulator[i] = select(mask[i], ram[self().ram_cell(i)][i], accumulator[i]);
+        ram_col[i] = select(mask[i], (ram_col[i] ^ (curr_opcode & 0x03)) & 0x07, ram_col[i]);
+    }
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_exc(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t cell = self().ram_cell(i);
+        uint8_t tmp = ram[cell][i];
+        ram[cell][i] = select(mask[i], accumulator[i] & 0x0F, tmp);
+        accumulator[i] = select(mask[i], tmp, accumulator[i]);
+        ram_col[i] = select(mask[i], ram_col[i] ^ (curr_opcode & 0x03), ram_col[i]);
+    }
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Arithmetic //////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_add(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        accumulator[i] = select(mask[i], (accumulator[i] + ram[self().ram_cell(i)][i]) & 0x0F, accumulator[i]);
+    }
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_add11(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t sum = accumulator[i] + ram[self().ram_cell(i)][i] + carry[i];
+        skip[i] = mask[i] & ((sum > 0x0F) ? LANE_ON : 0x00);
+        carry[i] = select(mask[i], sum > 0x0F, carry[i]);
+        accumulator[i] = select(mask[i], sum & 0x0F, accumulator[i]);
+    }
+    skip_instruction(skip);
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_adx(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    bool bug_0a = (curr_opcode & 0x0F) == 0x0A; // bug of cpu with value 0x0A -> never skip
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t sum = accumulator[i] + (curr_opcode & 0x0F);
+        skip[i] = mask[i] & ((sum > 0x0F && !bug_0a) ? LANE_ON : 0x00);
+        accumulator[i] = select(mask[i], sum & 0x0F, accumulator[i]);
+    }
+    skip_instruction(skip);
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_coma(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ accumulator[i] = accumulator[i] ^ (0x0F & mask[i]); }
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_rc(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ carry[i] = select(mask[i], 0, carry[i]); }
+};
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_sc(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ carry[i] = select(mask[i], 1, carry[i]); }
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Test -> if, ... skip ////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_ta(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ skip[i] = mask[i] & (alpha_input[i] ? LANE_ON : 0x00); }
+    skip_instruction(skip);
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_tb(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ skip[i] = mask[i] & (beta_input[i] ? LANE_ON : 0x00); }
+    skip_instruction(skip);
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_tc(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ skip[i] = mask[i] & (carry[i] ? 0x00 : LANE_ON); }
+    skip_instruction(skip);
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_tam(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        skip[i] = mask[i] & ((accumulator[i] == ram[self().ram_cell(i)][i]) ? LANE_ON : 0x00);
+    }
+    skip_instruction(skip);
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_tis(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        skip[i] = mask[i] & (gamma_flag_second[i] ? 0x00 : LANE_ON);
+        gamma_flag_second[i] = select(mask[i], 0, gamma_flag_second[i]);
+    }
+    skip_instruction(skip);
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_tmi(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        skip[i] = mask[i] & ((((ram[self().ram_cell(i)][i] >> (curr_opcode & 0x03)) & 0x01) == 1) ? LANE_ON : 0x00);
+    }
+    skip_instruction(skip);
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_ta0(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ skip[i] = mask[i] & ((accumulator[i] == 0x00) ? LANE_ON : 0x00); }
+    skip_instruction(skip);
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_tabl(){
+    uint8_t skip[LOCKSTEP_NB_LANE];
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ skip[i] = mask[i] & ((accumulator[i] == ram_line[i]) ? LANE_ON : 0x00); }
+    skip_instruction(skip);
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// BIT manipulation ///////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_rm(){
+    uint8_t bit = (~(0x01 << (curr_opcode & 0x03))) & 0x0F;
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t cell = self().ram_cell(i);
+        ram[cell][i] = select(mask[i], ram[cell][i] & bit, ram[cell][i]);
+    }
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_sm(){
+    uint8_t bit = 0x01 << (curr_opcode & 0x03);
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){
+        uint8_t cell = self().ram_cell(i);
+        ram[cell][i] = select(mask[i], (ram[cell][i] | bit) & 0x0F, ram[cell][i]);
+    }
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Other ///////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_cend(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ is_sleep[i] = select(mask[i], 1, is_sleep[i]); }
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_idiv(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ f_clock_divider[i] = mask[i] ? 0x0000 : f_clock_divider[i]; }
+};
+
+template <class Lockstep, class CPU>
+void SM5XX_Lockstep<Lockstep, CPU>::g_op_illegal(){
+    for(uint8_t i = 0; i < LOCKSTEP_NB_LANE; i++){ stop_cpu[i] = select(mask[i], 1, stop_cpu[i]); }
+};
@@ -0,0 +1,32 @@
+#include "SM5XX/SM5XX_translated.h"
+
+// constant init -> ready before generated files register their rom
+static Translated_Rom_Info* translated_rom_list = nullptr;
+
+
+uint32_t translated_rom_hash(const uint8_t* file_hex, size_t size_hex){
+    uint32_t hash = 0x811C9DC5;
+    for(size_t i = 0; i < size_hex; i++){
+        hash ^= file_hex[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+
+bool register_translated_rom(Translated_Rom_Info& info){
+    info.next = translated_rom_list;
+    translated_rom_list = &info;
+    return true;
+}
+
+
+const Translated_Rom_Info* find_translated_rom(const uint8_t* file_hex, size_t size_hex, uint8_t cpu_type_id){
+    if(translated_rom_list == nullptr){ return nullptr; } // no hash if nothing is translated
+
+    uint32_t hash = translated_rom_hash(file_hex, size_hex);
+    for(const Translated_Rom_Info* info = translated_rom_list; info != nullptr; info = info->next){
+        if(info->rom_hash == hash && info->cpu_type_id == cpu_type_id){ return info; }
+    }
+    return nullptr;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+
+// Rom translated in C++ (ahead of time) by CONVERT_ROM/utils/translate_rom_to_cpp.py :
+// one function per basic block of the rom, opcodes decoded at generation -> direct call of instructions
+// Each generated file register its rom at start of program, cpu use it if the rom is the same (hash)
+// -> no generated file linked = interpreter only, nothing change
+
+template <class CPU, uint32_t ROM_HASH> struct Translated_Rom; // one specialization per generated file (friend of each cpu)
+
+struct Translated_Rom_Info {
+    uint32_t rom_hash;
+    uint8_t cpu_type_id; // same value as get_cpu_type_id()
+    const void* blocks; // const Translated_Block<CPU>* (SM5XX_core.h) of the cpu
+    uint16_t nb_block;
+    const char* ref_game;
+    Translated_Rom_Info* next; // list of registered roms
+};
+
+// same hash in translate_rom_to_cpp.py (FNV-1a 32 bit)
+uint32_t translated_rom_hash(const uint8_t* file_hex, size_t size_hex);
+
+bool register_translated_rom(Translated_Rom_Info& info); // called by generated files (static init)
+const Translated_Rom_Info* find_translated_rom(const uint8_t* file_hex, size_t size_hex, uint8_t cpu_type_id); // nullptr if not linked
@@ -0,0 +1,40 @@
+#include "SM5XX/get_cpu.h"
+#include "SM5XX/SM5A/SM5A.h"
+#include "SM5XX/SM510/SM510.h"
+#include "SM5XX/SM511_SM512/SM511_2.h"
+
+
+uint8_t get_cpu_type(const uint8_t* rom, uint16_t size_rom){
+    if(size_rom == 1856){ return CPU_TYPE_SM5A; }
+    if(size_rom == 4096){
+        for(int i = 0; i<16; i++){
+            if(rom[i+704] != 0x00){ return CPU_TYPE_SM511_2; } // SM511 game work with SM512
+        }
+        return CPU_TYPE_SM510;
+    }
+    return CPU_TYPE_UNKNOWN;
+}
+
+
+bool get_cpu(SM5XX*& cpu, const uint8_t* rom, uint16_t size_rom){
+    cpu = nullptr;
+    switch(get_cpu_type(rom, size_rom)){
+        case CPU_TYPE_SM5A: cpu = new SM5A(); break;
+        case CPU_TYPE_SM510: cpu = new SM510(); break;
+        case CPU_TYPE_SM511_2: cpu = new SM511_2(); break;
+        default: return false;
+    }
+
+    cpu->load_translated_rom(rom, size_rom); // rom translated in C++ if linked (CONVERT_ROM/utils), else interpreter
+    return true;
+}
+
+
+Segment_Layout get_segment_layout(uint8_t cpu_type){
+    switch(cpu_type){
+        case CPU_TYPE_SM5A: return SM5A::SEGMENT_LAYOUT;
+        case CPU_TYPE_SM510: return SM510::SEGMENT_LAYOUT;
+        case CPU_TYPE_SM511_2: return SM511_2::SEGMENT_LAYOUT;
+        default: return { 0, 0, 0 };
+    }
+}
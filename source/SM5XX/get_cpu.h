@@ -0,0 +1,21 @@
+#pragma once
+#include <stdint.h>
+#include "SM5XX/SM5XX.h"
+
+// same values as get_cpu_type_id() of each cpu
+constexpr uint8_t CPU_TYPE_SM5A = 0;
+constexpr uint8_t CPU_TYPE_SM510 = 1;
+constexpr uint8_t CPU_TYPE_SM511_2 = 2;
+constexpr uint8_t CPU_TYPE_UNKNOWN = 0xFF;
+
+// Cpu of a rom -> chosen with size of rom (and data at 704 for SM511), CPU_TYPE_UNKNOWN if not supported
+uint8_t get_cpu_type(const uint8_t* rom, uint16_t size_rom);
+
+// Create the cpu of a rom (SM5A, SM510 or SM511/SM512) -> same choice as get_cpu_type()
+// + rom translated in C++ if linked. Shared by all frontends (3DS, Android, headless)
+// output -> false if rom is not supported. cpu created with new, init() and load_rom() not called
+bool get_cpu(SM5XX*& cpu, const uint8_t* rom, uint16_t size_rom);
+
+// Layout of segment_bits of a cpu type, without cpu -> bit of each segment resolved at load of pack
+// {0, 0, 0} if not supported (all segments SEGMENT_BIT_NONE)
+Segment_Layout get_segment_layout(uint8_t cpu_type);
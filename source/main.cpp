@@ -18,11 +18,15 @@
 #include "std/gw_pack.h"
 #include "std/platform_paths.h"
 #include "std/debug_log.h"
+#include "std/rewind.h"
+#include "std/run_ahead.h"
+#include "std/emulation_speed.h"
 
 #include "SM5XX/SM5XX.h"
 #include "SM5XX/SM510/SM510.h"
 #include "SM5XX/SM511_SM512/SM511_2.h"
 #include "SM5XX/SM5A/SM5A.h"
+#include "SM5XX/get_cpu.h"
 
 #include "virtual_i_o/3ds_screen.h"
 #include "virtual_i_o/3ds_sound.h"
@@ -42,6 +46,8 @@ const int _INPUT_DEBUG_ = (KEY_L|KEY_X);
 const int _INPUT_SETTING_OTHER_ = (KEY_ZL|KEY_ZR);
 
 const int _INPUT_MENU_ = (KEY_L|KEY_R);
+const int _INPUT_REWIND_ = KEY_R; // held without L -> back in time, 1 state per frame
+const int _INPUT_FAST_FORWARD_ = KEY_ZR; // held without ZL -> uncapped speed
 
 const uint64_t _TIME_MOVE_MENU_ = 400000;
 const uint64_t _TIME_MOVE_VALUE_SETTING_ = 300000;
@@ -58,24 +64,28 @@ bool debug_run_op_press = false;
 
 uint8_t index_game = 0;
 
-bool get_cpu(SM5XX*& cpu, const uint8_t* rom, uint16_t size_rom){
-    if(size_rom == 1856){
-        cpu = new SM5A();
-        return true;
-    }
-    else if (size_rom == 4096)
-    {
-        for(int i = 0; i<16; i++){
-            if(rom[i+704] != 0x00){ 
-                cpu = new SM511_2();
-                return true;
-            } // SM511 game work with SM512
-        }
-        cpu = new SM510(); return true;
-    }
-    return false;
+Rewind_Buffer rewind_buffer; // arena allocated at start of game, not during play
+
+Run_Ahead run_ahead;
+RunAheadSetting run_ahead_setting; // of current game, edited in settings
+
+Emulation_Speed emulation_speed;
+uint8_t index_speed_preset = 2; // SPEED_PRESETS, chosen in settings (not saved)
+
+void apply_run_ahead(SM5XX* cpu, const GW_rom* game){
+    uint8_t mode = (run_ahead_setting.mode == RUN_AHEAD_SINGLE) ? RUN_AHEAD_SINGLE : RUN_AHEAD_SECOND;
+    run_ahead.configure(cpu, game, mode, run_ahead_setting.nb_frame);
 }
 
+// Menu navigation state (owned by main loop, not hidden in handle_menu_input)
+// Remember the last selected index per manufacturer while navigating the menu.
+// This is intentionally in-memory only (not persisted to settings).
+struct Menu_State {
+    int16_t last_index_by_manufacturer[GW_rom::MANUFACTURER_COUNT];
+    Menu_State(){
+        for (int i = 0; i < (int)GW_rom::MANUFACTURER_COUNT; i++) { last_index_by_manufacturer[i] = -1; }
+    }
+};
 
 static std::string g_pack_load_error;
 
@@ -354,7 +364,7 @@ void update_name_game(Virtual_Screen* v_screen, bool for_choose = true){
 
 
 // Returns: 0 = stay in menu, 1 = start game, 2 = go to settings
-int handle_menu_input(Virtual_Screen* v_screen, Input_Manager_3ds* input_manager){
+int handle_menu_input(Virtual_Screen* v_screen, Input_Manager_3ds* input_manager, Menu_State& menu_state){
 
     const size_t n_games = get_nb_name();
     if (n_games == 0) {
@@ -418,20 +428,11 @@ int handle_menu_input(Virtual_Screen* v_screen, Input_Manager_3ds* input_manager
 
     const uint8_t cur_mfr = get_mfr(index_game);
 
-    // Remember the last selected index per manufacturer while navigating the menu.
-    // This is intentionally in-memory only (not persisted to settings).
-    static bool s_last_by_mfr_init = false;
-    static int16_t s_last_idx_by_mfr[GW_rom::MANUFACTURER_COUNT];
-    if (!s_last_by_mfr_init) {
-        for (int i = 0; i < (int)GW_rom::MANUFACTURER_COUNT; i++) {
-            s_last_idx_by_mfr[i] = -1;
-        }
-        s_last_by_mfr_init = true;
-    }
+    int16_t* last_idx_by_mfr = menu_state.last_index_by_manufacturer;
 
     auto remember_current = [&](uint8_t mfr) {
         if (mfr < GW_rom::MANUFACTURER_COUNT) {
-            s_last_idx_by_mfr[mfr] = (int16_t)index_game;
+            last_idx_by_mfr[mfr] = (int16_t)index_game;
         }
     };
 
@@ -440,7 +441,7 @@ int handle_menu_input(Virtual_Screen* v_screen, Input_Manager_3ds* input_manager
             return fallback_idx;
         }
 
-        const int16_t saved = s_last_idx_by_mfr[mfr];
+        const int16_t saved = last_idx_by_mfr[mfr];
         if (saved >= 0 && (size_t)saved < n_games) {
             const uint8_t saved_idx = (uint8_t)saved;
             if (get_mfr(saved_idx) == mfr) {
@@ -452,7 +453,7 @@ int handle_menu_input(Virtual_Screen* v_screen, Input_Manager_3ds* input_manager
         uint8_t persisted_idx = 0;
         if (try_load_last_game_index_for_manufacturer(mfr, &persisted_idx)) {
             if ((size_t)persisted_idx < n_games && get_mfr(persisted_idx) == mfr) {
-                s_last_idx_by_mfr[mfr] = (int16_t)persisted_idx;
+                last_idx_by_mfr[mfr] = (int16_t)persisted_idx;
                 return persisted_idx;
             }
         }
@@ -461,7 +462,7 @@ int handle_menu_input(Virtual_Screen* v_screen, Input_Manager_3ds* input_manager
     };
 
     // Ensure current manufacturer has an entry.
-    if (s_last_idx_by_mfr[cur_mfr] < 0) {
+    if (last_idx_by_mfr[cur_mfr] < 0) {
         remember_current(cur_mfr);
     }
 
@@ -493,7 +494,7 @@ int handle_menu_input(Virtual_Screen* v_screen, Input_Manager_3ds* input_manager
             uint8_t cand_idx = index_game;
             if (find_next_with_mfr(index_game, -1, new_mfr, cand_idx)) {
                 index_game = restore_for_mfr_or(new_mfr, cand_idx);
-                s_last_idx_by_mfr[new_mfr] = (int16_t)index_game;
+                last_idx_by_mfr[new_mfr] = (int16_t)index_game;
                 update_name_game(v_screen);
                 save_last_selected_game(new_mfr, get_ref(index_game));
             }
@@ -505,7 +506,7 @@ int handle_menu_input(Virtual_Screen* v_screen, Input_Manager_3ds* input_manager
             uint8_t cand_idx = index_game;
             if (find_next_with_mfr(index_game, +1, new_mfr, cand_idx)) {
                 index_game = restore_for_mfr_or(new_mfr, cand_idx);
-                s_last_idx_by_mfr[new_mfr] = (int16_t)index_game;
+                last_idx_by_mfr[new_mfr] = (int16_t)index_game;
                 update_name_game(v_screen);
                 save_last_selected_game(new_mfr, get_ref(index_game));
             }
@@ -627,6 +628,7 @@ bool init_game(SM5XX** cpu, Virtual_Screen* v_screen, Virtual_Sound* v_sound, Vi
 #endif
 
     v_sound->initialize((*cpu)->frequency, (*cpu)->sound_divide_frequency, _3DS_FPS_SCREEN_);
+    v_sound->set_speed(emulation_speed.get_percent());
     v_sound->play_sample();
     YOKOI_LOG("init_game: sound init ok");
 
@@ -640,6 +642,9 @@ bool init_game(SM5XX** cpu, Virtual_Screen* v_screen, Virtual_Sound* v_sound, Vi
     YOKOI_LOG("init_game: input config ok (%p)", (const void*)*v_input);
 
     set_time_cpu(*cpu);
+    rewind_buffer.init((*cpu)->get_state_size());
+    run_ahead_setting = load_run_ahead_setting(game->ref);
+    apply_run_ahead(*cpu, game);
     YOKOI_LOG("init_game: success");
 
 #if YOKOI_ENABLE_RUNTIME_RAM_SNAPSHOT
@@ -656,7 +661,7 @@ bool init_game(SM5XX** cpu, Virtual_Screen* v_screen, Virtual_Sound* v_sound, Vi
 // Settings UI state
 int selected_setting = 0;
 int selected_bg_preset = 0;
-const int NUM_SETTINGS = 2; // Background color and segment marking alpha
+const int NUM_SETTINGS = 5; // Background color, segment marking alpha, run-ahead frames and its cpu, speed
 
 void update_settings_display(Virtual_Screen* v_screen) {
     v_screen->delete_all_text();
@@ -689,6 +694,32 @@ void update_settings_display(Virtual_Screen* v_screen) {
         alpha_text = "> " + alpha_text + " <";
     }
     v_screen->set_text(alpha_text, text_offset_x, 90, 0, 1);
+
+    // Run-ahead of selected game
+    char run_ahead_str[40];
+    if (run_ahead_setting.nb_frame == 0) { snprintf(run_ahead_str, sizeof(run_ahead_str), "Run-ahead (game): Off"); }
+    else { snprintf(run_ahead_str, sizeof(run_ahead_str), "Run-ahead (game): %d frame%s", run_ahead_setting.nb_frame, (run_ahead_setting.nb_frame > 1) ? "s" : ""); }
+    std::string run_ahead_text = run_ahead_str;
+    if (selected_setting == 2) {
+        run_ahead_text = "> " + run_ahead_text + " <";
+    }
+    v_screen->set_text(run_ahead_text, text_offset_x, 120, 0, 1);
+
+    std::string run_ahead_mode_text = (run_ahead_setting.mode == RUN_AHEAD_SINGLE) ? "Run-ahead cpu: Same" : "Run-ahead cpu: Second";
+    if (selected_setting == 3) {
+        run_ahead_mode_text = "> " + run_ahead_mode_text + " <";
+    }
+    v_screen->set_text(run_ahead_mode_text, text_offset_x, 150, 0, 1);
+
+    // Speed of emulation (session only)
+    char speed_str[32];
+    if (SPEED_PRESETS[index_speed_preset] == SPEED_UNCAPPED) { snprintf(speed_str, sizeof(speed_str), "Speed: Uncapped"); }
+    else { snprintf(speed_str, sizeof(speed_str), "Speed: %d%%", SPEED_PRESETS[index_speed_preset]); }
+    std::string speed_text = speed_str;
+    if (selected_setting == 4) {
+        speed_text = "> " + speed_text + " <";
+    }
+    v_screen->set_text(speed_text, text_offset_x, 180, 0, 1);
     
     // Instructions
     v_screen->set_text("UP/DOWN: Select setting", text_offset_x, 140, 1, 1);
@@ -729,6 +760,12 @@ bool handle_settings_input(Virtual_Screen* v_screen, Input_Manager_3ds* input_ma
         case 1: // Segment marking alpha
             time_check = _TIME_MOVE_VALUE_SETTING_;
             break;
+
+        case 2: // Run-ahead frames
+        case 3: // Run-ahead cpu
+        case 4: // Speed
+            time_check = _TIME_MOVE_MENU_;
+            break;
     }
 
     if (input_manager->input_Held_Increase(KEY_DRIGHT, time_check)) {
@@ -741,6 +778,15 @@ bool handle_settings_input(Virtual_Screen* v_screen, Input_Manager_3ds* input_ma
             // Segment marking alpha
             g_settings.segment_marking_alpha = (g_settings.segment_marking_alpha + 1) % 256;
         }
+        else if (selected_setting == 2) {
+            run_ahead_setting.nb_frame = (run_ahead_setting.nb_frame + 1) % (RUN_AHEAD_MAX_FRAME + 1);
+        }
+        else if (selected_setting == 3) {
+            run_ahead_setting.mode = (run_ahead_setting.mode == RUN_AHEAD_SINGLE) ? RUN_AHEAD_SECOND : RUN_AHEAD_SINGLE;
+        }
+        else if (selected_setting == 4) {
+            index_speed_preset = (index_speed_preset + 1) % NB_SPEED_PRESETS;
+        }
         update_settings_display(v_screen);
     }
     else if (input_manager->input_Held_Increase(KEY_DLEFT, time_check)) {
@@ -753,24 +799,37 @@ bool handle_settings_input(Virtual_Screen* v_screen, Input_Manager_3ds* input_ma
             // Segment marking alpha
             g_settings.segment_marking_alpha = (g_settings.segment_marking_alpha - 1 + 256) % 256;
         }
+        else if (selected_setting == 2) {
+            run_ahead_setting.nb_frame = (run_ahead_setting.nb_frame + RUN_AHEAD_MAX_FRAME) % (RUN_AHEAD_MAX_FRAME + 1);
+        }
+        else if (selected_setting == 3) {
+            run_ahead_setting.mode = (run_ahead_setting.mode == RUN_AHEAD_SINGLE) ? RUN_AHEAD_SECOND : RUN_AHEAD_SINGLE;
+        }
+        else if (selected_setting == 4) {
+            index_speed_preset = (index_speed_preset + NB_SPEED_PRESETS - 1) % NB_SPEED_PRESETS;
+        }
         update_settings_display(v_screen);
     }
     
     // Save and return
     if (input_manager->input_justPressed(KEY_A)) {
         save_settings();
+        save_run_ahead_setting(get_ref(index_game), run_ahead_setting);
         return true; // Exit settings
     }
     
     // Cancel (don't save)
     if (input_manager->input_justPressed(KEY_B)) {
         load_settings(); // Reload original settings
+        run_ahead_setting = load_run_ahead_setting(get_ref(index_game));
         return true; // Exit settings
     }
     
     // Reset to defaults
     if (input_manager->input_justPressed(KEY_X)) {
         reset_settings_to_default();
+        run_ahead_setting = RunAheadSetting();
+        index_speed_preset = 2; // 100%
         update_settings_display(v_screen);
         sleep_us_p(200000);
     }
@@ -857,8 +916,8 @@ int main()
         }
     }
 
-    uint32_t curr_rate = 0;
 
+    Menu_State menu_state;
     GameState state = STATE_MENU;
     GameState previous_state = STATE_MENU; // Track where we came from before settings
     bool just_exited_settings = false; // Prevent immediate input after exiting settings
@@ -882,7 +941,7 @@ int main()
                         just_exited_settings = false;
                     }
                     else {
-                        int menu_result = handle_menu_input(&v_screen, &input_manager);
+                        int menu_result = handle_menu_input(&v_screen, &input_manager, menu_state);
                         if(menu_result == 1) {
                             // Check if save exists, if so go to prompt, otherwise start fresh
                             if(save_state_exists(index_game)) {
@@ -890,7 +949,7 @@ int main()
                             } else {
                                 if (init_game(&cpu, &v_screen, &v_sound, &v_input, false)) {
                                     state = STATE_PLAY;
-                                    curr_rate = 0;
+                                    emulation_speed.reset();
                                     time_set_grace_counter = TIME_SET_GRACE_PERIOD; // Set time for first N cycles
                                 } else {
                                     state = STATE_MENU;
@@ -902,6 +961,7 @@ int main()
                             // Go to settings
                             previous_state = STATE_MENU;
                             state = STATE_SETTINGS;
+                            run_ahead_setting = load_run_ahead_setting(get_ref(index_game));
                             update_settings_display(&v_screen);
                         }
                     }
@@ -938,7 +998,7 @@ int main()
                         v_screen.delete_all_text();
                         if (init_game(&cpu, &v_screen, &v_sound, &v_input, load_save)) {
                             state = STATE_PLAY;
-                            curr_rate = 0;
+                            emulation_speed.reset();
                             time_set_grace_counter = TIME_SET_GRACE_PERIOD; // Set time for first N cycles
                             restore_single_screen_console(&v_screen);
                         } else {
@@ -964,9 +1024,32 @@ int main()
                     }
 #endif
 
-                    curr_rate += cpu->frequency;
-                    uint32_t step = curr_rate/_3DS_FPS_SCREEN_;
-                    curr_rate -= step*_3DS_FPS_SCREEN_;
+                    uint16_t speed = SPEED_PRESETS[index_speed_preset];
+                    if(input_manager.input_isHeld(_INPUT_FAST_FORWARD_) && !input_manager.input_isHeld(KEY_ZL)){ speed = SPEED_UNCAPPED; }
+                    if(speed != emulation_speed.get_percent()){
+                        emulation_speed.set_percent(speed);
+                        v_sound.set_speed(speed);
+                    }
+                    uint32_t step = emulation_speed.cycles_of_frame(cpu->frequency, _3DS_FPS_SCREEN_);
+
+                    bool rewinding = input_manager.input_isHeld(_INPUT_REWIND_) && !input_manager.input_isHeld(KEY_L);
+                    #if defined(YOKOI_DEBUG)
+                        rewinding = rewinding && !debug_run_op_press; // R = step by step in debug
+                    #endif
+                    if(rewinding){
+                        if(rewind_buffer.rewind(cpu)){ v_screen.update_buffer_video(cpu); }
+                        step = 0; // frame replaced by previous state
+                    }
+
+                    // segments presented from run-ahead, not from real frame (not during time set : cycle by cycle)
+                    bool use_run_ahead = run_ahead.is_active() && !rewinding && (time_set_grace_counter <= 0);
+                    // fast : segments presented 1 time at end of host frame, not at each update
+                    bool video_by_frame = emulation_speed.is_fast();
+                    bool more_frames = emulation_speed.is_uncapped() && !rewinding; // uncapped : frames while time of host frame not used
+                    #if defined(YOKOI_DEBUG)
+                        use_run_ahead = use_run_ahead && !debug_run_op_press;
+                        more_frames = more_frames && !debug_run_op_press;
+                    #endif
 
                     #if defined(YOKOI_DEBUG)
                         bool only_one_frame = false;
@@ -979,7 +1062,21 @@ int main()
                     #endif
 
 
-                    while(step > 0) {
+                    Cycle_Events cycle_events;
+                    while(step > 0 || (more_frames && emulation_speed.next_frame_in_budget(step, cpu->frequency, _3DS_FPS_SCREEN_))) {
+                        // cycle by cycle only if frontend need to act between opcodes, else batch of cycles
+                        bool cycle_by_cycle = (time_set_grace_counter > 0);
+                        #if defined(YOKOI_DEBUG)
+                            cycle_by_cycle = cycle_by_cycle || debug_run_op_press;
+                        #endif
+                        if(!cycle_by_cycle){
+                            uint32_t nb_cycle = cpu->run_cycles(step, cycle_events);
+                            if(cycle_events.segments_updated && !use_run_ahead && !video_by_frame){ v_screen.update_buffer_video(cpu); }
+                            v_sound.update_sound(cycle_events, nb_cycle);
+                            step -= nb_cycle;
+                            continue;
+                        }
+
                         if(cpu->step()) { 
                             // Only set time for the first few cycles after game start, otherwise the CPU
                             // won't set the correct initial time from the 3DS RTC.
@@ -997,6 +1094,11 @@ int main()
                         v_sound.update_sound(cpu); 
                         step -= 1;
                     }
+                    if(!rewinding){ rewind_buffer.record(cpu); }
+                    if(use_run_ahead){
+                        run_ahead.run(cpu, _3DS_FPS_SCREEN_, [&](SM5XX* future){ v_screen.update_buffer_video(future); });
+                    }
+                    else if(video_by_frame){ v_screen.update_buffer_video(cpu); } // nothing if no update
 
                     #if defined(YOKOI_DEBUG)
                         v_screen.delete_all_text();
@@ -1009,17 +1111,27 @@ int main()
                             v_screen.set_text(segment , 20, 20+i*16 , 1, 1);      
                             i += 1;      
                         }
+                        if(run_ahead.is_active()){
+                            char cost[48];
+                            snprintf(cost, sizeof(cost), "run-ahead %u us (avg %u)", (unsigned)run_ahead.get_last_cost_us(), (unsigned)run_ahead.get_average_cost_us());
+                            v_screen.set_text(cost, 20, 20+i*16, 1, 1);
+                        }
                         
                     #endif
 
-                    C3D_FrameBegin(C3D_FRAME_SYNCDRAW);
-                    v_screen.update_screen();
-
+                    // LCD, 3D slider and settings unchanged -> nothing draw, previous frame stay on screen
                     #if defined(YOKOI_DEBUG)
-                        if(v_screen.nb_screen == 1){ v_screen.update_text(true); }
-                        else { v_screen.update_text(false); }                        
+                        v_screen.set_need_redraw(); // text of debug each frame
                     #endif
+                    C3D_FrameBegin(C3D_FRAME_SYNCDRAW);
+                    if(v_screen.screen_need_update()){
+                        v_screen.update_screen();
 
+                        #if defined(YOKOI_DEBUG)
+                            if(v_screen.nb_screen == 1){ v_screen.update_text(true); }
+                            else { v_screen.update_text(false); }                        
+                        #endif
+                    }
                     C3D_FrameEnd(0);
 
                     if(input_manager.input_isHeld(_INPUT_MENU_)){
@@ -1063,6 +1175,7 @@ int main()
 
                             // Apply new settings
                             v_screen.refresh_settings();
+                            apply_run_ahead(cpu, load_game(index_game));
                             restore_single_screen_console(&v_screen);
                         }
                     }
@@ -0,0 +1,34 @@
+#include "blink_filter.h"
+
+
+void Blink_Filter::set_segments(const Segment* segments, size_t nb_segment){
+    bit_of_segment.resize(nb_segment);
+    for(size_t i = 0; i < nb_segment; i++){ bit_of_segment[i] = segments[i].bit; }
+    clear();
+}
+
+
+void Blink_Filter::clear(){
+    size_t nb_word = (bit_of_segment.size() + 63) / 64;
+    last.assign(nb_word, 0);
+    visible.assign(nb_word, 0);
+}
+
+
+bool Blink_Filter::update(const uint64_t segment_bits[SEGMENT_BITS_WORD]){
+    uint64_t changed = 0;
+    size_t nb_segment = bit_of_segment.size();
+    for(size_t w = 0; w < visible.size(); w++){
+        // gather 64 segments in 1 word (no branch)
+        uint64_t curr = 0;
+        size_t first = w * 64;
+        size_t nb = (nb_segment - first < 64) ? nb_segment - first : 64;
+        for(size_t i = 0; i < nb; i++){ curr |= uint64_t(segment_bit_value(segment_bits, bit_of_segment[first + i])) << i; }
+
+        uint64_t filtered = (last[w] & (curr | visible[w])) | (curr & visible[w]);
+        changed |= filtered ^ visible[w];
+        visible[w] = filtered;
+        last[w] = curr;
+    }
+    return changed != 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "segment.h"
+#include "SM5XX/SM5XX.h"
+
+// Protection of "blinking segment" shared by all renderers (3DS, Android).
+// On true G&W a segment on/off during 1 update is not visible (lcd too slow) but it is on emulator :
+// visible = previous && (new || visible) || (new && visible)   (= 2 updates needed to change a segment)
+//
+// States kept in bit-planes (segment i = bit i & 63 of word i >> 6) -> filter on 64 segments by operation.
+
+class Blink_Filter {
+public :
+    // segments of game (bit resolved by pack load), same order as renderer. All off
+    void set_segments(const Segment* segments, size_t nb_segment);
+    void clear(); // all off, same segments
+    size_t size() const { return bit_of_segment.size(); }
+
+    // new state of all segments from segment_bits of cpu -> true if a visible segment changed
+    bool update(const uint64_t segment_bits[SEGMENT_BITS_WORD]);
+    // visible == last states -> same segment_bits again give same result (update can be skipped)
+    bool is_stable() const { return visible == last; }
+    bool is_visible(size_t i) const { return (visible[i >> 6] >> (i & 63)) & 0x01; }
+
+private :
+    std::vector<uint16_t> bit_of_segment;
+    std::vector<uint64_t> last; // states of previous update
+    std::vector<uint64_t> visible; // filtered
+};
@@ -0,0 +1,31 @@
+#include "emulation_speed.h"
+#include "timer.h"
+
+
+void Emulation_Speed::set_percent(uint16_t new_percent){
+    percent = new_percent;
+    curr_rate = 0;
+}
+
+
+uint32_t Emulation_Speed::cycles_of_frame(uint32_t frequency, float fps){
+    time_start_frame = time_us_64_p();
+    uint16_t multiplier = is_uncapped() ? SPEED_NORMAL : percent; // uncapped : next frames by next_frame_in_budget
+
+    curr_rate += uint64_t(frequency) * multiplier;
+    uint64_t rate_by_frame = uint64_t(fps * SPEED_NORMAL);
+    uint32_t step = uint32_t(curr_rate / rate_by_frame);
+    curr_rate -= step * rate_by_frame;
+    return step;
+}
+
+
+bool Emulation_Speed::next_frame_in_budget(uint32_t& step, uint32_t frequency, float fps){
+    if(!is_uncapped() || time_us_64_p() - time_start_frame >= SPEED_UNCAPPED_BUDGET_US){ return false; }
+
+    curr_rate += uint64_t(frequency) * SPEED_NORMAL;
+    uint64_t rate_by_frame = uint64_t(fps * SPEED_NORMAL);
+    step = uint32_t(curr_rate / rate_by_frame);
+    curr_rate -= step * rate_by_frame;
+    return step > 0;
+}
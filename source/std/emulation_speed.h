@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+
+// Speed of emulation : multiplier of cycles emulated by host frame (fast-forward / slow-motion).
+// Uncapped -> frames of cycles emulated while time of host frame not used (SPEED_UNCAPPED_BUDGET_US).
+// Fast -> frontend present segments 1 time by host frame (not at each update), sound decimated then muted.
+
+constexpr uint16_t SPEED_NORMAL = 100; // percent
+constexpr uint16_t SPEED_UNCAPPED = 0;
+constexpr uint16_t SPEED_PRESETS[] = { 25, 50, 100, 200, 400, 800, SPEED_UNCAPPED };
+constexpr uint8_t NB_SPEED_PRESETS = sizeof(SPEED_PRESETS) / sizeof(SPEED_PRESETS[0]);
+
+constexpr uint16_t SPEED_SOUND_MAX = 400; // faster -> sound muted (decimated too much = noise)
+constexpr uint32_t SPEED_UNCAPPED_BUDGET_US = 12000; // host frame = 16.6 ms at 60 fps, rest for render
+
+class Emulation_Speed {
+public :
+    void set_percent(uint16_t new_percent); // SPEED_UNCAPPED or 25 .. 800
+    uint16_t get_percent() const { return percent; }
+    bool is_uncapped() const { return percent == SPEED_UNCAPPED; }
+    bool is_fast() const { return percent == SPEED_UNCAPPED || percent > SPEED_NORMAL; }
+    bool sound_muted() const { return percent == SPEED_UNCAPPED || percent > SPEED_SOUND_MAX; }
+
+    // cycles of this host frame (remainder kept for next frame, like curr_rate of frontends)
+    uint32_t cycles_of_frame(uint32_t frequency, float fps);
+    // uncapped : 1 more frame of cycles in step if time of host frame not used. false -> end of host frame
+    bool next_frame_in_budget(uint32_t& step, uint32_t frequency, float fps);
+    void reset(){ curr_rate = 0; }
+
+private :
+    uint16_t percent = SPEED_NORMAL;
+    uint64_t curr_rate = 0; // cycles * 100
+    uint64_t time_start_frame = 0;
+};
+
+// sound : 1 sample each divide_freq cycles at normal speed -> samples by cycle in 16.16 at this speed
+// (fast -> samples skipped, slow -> samples repeated, so sound stay at real time length)
+inline uint32_t speed_sample_step_q16(uint16_t divide_freq, uint16_t percent){
+    if(percent == SPEED_UNCAPPED){ return 0; }
+    return uint32_t((uint64_t(1) << 16) * SPEED_NORMAL / (uint64_t(divide_freq ? divide_freq : 1) * percent));
+}
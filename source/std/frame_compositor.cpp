@@ -0,0 +1,299 @@
+#include "frame_compositor.h"
+#include "GW_info_reader.h"
+
+
+// same as SEGMENT_COLOR of 3ds_screen.h (0xRRGGBB) : classic black segment + 4 colors of Game & Watch color
+static const uint32_t COMPOSITOR_SEGMENT_COLOR[5] = { 0x080908, 0x9992e7, 0x58b9a0, 0xff677c, 0x3db8e4 };
+
+// same values as Virtual_Screen in 2D (create_shadow / create_segment)
+constexpr uint32_t SHADOW_SEGMENT_COLOR = 0x111111;
+constexpr uint32_t SHADOW_SEGMENT_ALPHA = 0x18;
+constexpr uint32_t SHADOW_BACKGROUND_ALPHA = 0x24;
+constexpr uint32_t MARKING_COLOR = 0x101010;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Blend ///////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// pixel = R | G << 8 | B << 16 | A << 24. 2 channels computed by operation (SWAR : 0x00FF00FF part of word)
+// no branch, no intrinsic -> same result on all hosts, loops vectorized by compiler
+
+static inline uint32_t rgb_to_pixel(uint32_t rgb){
+    return ((rgb >> 16) & 0xFF) | (rgb & 0xFF00) | ((rgb & 0xFF) << 16) | 0xFF000000u;
+}
+
+// x * a / 255 (rounded) on channels 0 and 2 of x
+static inline uint32_t mul_2_channels(uint32_t x, uint32_t a){
+    uint32_t t = x * a + 0x00800080;
+    return ((t + ((t >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+}
+
+static inline uint32_t mul_255(uint32_t x, uint32_t a){
+    uint32_t t = x * a + 0x80;
+    return (t + (t >> 8)) >> 8;
+}
+
+// all channels * a / 255 (opaque color + alpha -> premultiplied)
+static inline uint32_t premultiply(uint32_t pixel, uint32_t a){
+    return mul_2_channels(pixel & 0x00FF00FF, a) | (mul_2_channels((pixel >> 8) & 0x00FF00FF, a) << 8);
+}
+
+// src over dst, src premultiplied
+static inline uint32_t over(uint32_t dst, uint32_t src){
+    uint32_t inv = 255 - (src >> 24);
+    return src + premultiply(dst, inv);
+}
+
+static inline uint32_t premultiply_texel(uint32_t texel){
+    return (premultiply(texel | 0xFF000000u, texel >> 24) & 0x00FFFFFF) | (texel & 0xFF000000u);
+}
+
+static bool intersect(const Compositor_Rect& a, const Compositor_Rect& b, Compositor_Rect& out){
+    out = { a.x0 > b.x0 ? a.x0 : b.x0, a.y0 > b.y0 ? a.y0 : b.y0, a.x1 < b.x1 ? a.x1 : b.x1, a.y1 < b.y1 ? a.y1 : b.y1 };
+    return out.x0 < out.x1 && out.y0 < out.y1;
+}
+
+static Compositor_Rect move_rect(const Compositor_Rect& rect, int decal){
+    return { rect.x0 + decal, rect.y0 + decal, rect.x1 + decal, rect.y1 + decal };
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Load ////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// texel of texture of pack : mirrored on x, y from bottom (as calc_uv_rect of Android renderer). 0 outside texture
+static uint32_t texel_of_pack(const Image_RGBA& texture, int u, int v, int w, int h, int x, int y){
+    int column = u + w - 1 - x;
+    int row = int(texture.height) - v - h + y;
+    if(column < 0 || row < 0 || column >= int(texture.width) || row >= int(texture.height)){ return 0; }
+    return texture.row(uint32_t(row))[column];
+}
+
+
+bool Frame_Compositor::load(const Segment* segments, size_t nb_segment, const uint16_t* segment_info, const Image_RGBA& segment_texture
+                            , const uint16_t* background_info, const Image_RGBA* background_texture
+                            , const AppSettings& settings, std::string* error_out){
+    auto fail = [&](const char* message){
+        if(error_out){ *error_out = message; }
+        return false;
+    };
+    if(segment_info == nullptr || background_info == nullptr){ return fail("no info of screen"); }
+    if(segment_texture.pixels.empty()){ return fail("no texture of segment"); }
+
+    int nb_screen = 1;
+    for(size_t i = 0; i < nb_segment; i++){ if(segments[i].screen != 0){ nb_screen = 2; } }
+    int multi = segment_info[I_SEG_MULTI] ? segment_info[I_SEG_MULTI] : 1;
+    is_mask = (segment_info[I_SEG_MASK] & 0x01) == 0x01;
+    fond_color = rgb_to_pixel(is_mask ? COMPOSITOR_SEGMENT_COLOR[0] : settings.background_color);
+    bool background_in_front = background_info[i_bg_in_front(nb_screen)] == 1;
+    shadow_decal = background_in_front ? 2 : 3;
+
+    // screens (size of fond = size of background)
+    screen_rect.clear();
+    int frame_width = 0, frame_height = 0;
+    for(int screen = 0; screen < nb_screen; screen++){
+        int w = background_info[i_bg_w(screen)];
+        int h = background_info[i_bg_h(screen)];
+        if(w == 0 || h == 0){ w = segment_info[i_seg_scr_w(screen)]; h = segment_info[i_seg_scr_h(screen)]; }
+        if(w == 0 || h == 0){ return fail("size of screen is 0"); }
+        screen_rect.push_back({ 0, frame_height, w, frame_height + h });
+        frame_width = (w > frame_width) ? w : frame_width;
+        frame_height += h;
+    }
+    frame.resize(uint32_t(frame_width), uint32_t(frame_height), 0xFF000000u);
+    overlay.assign(frame.pixels.size(), 0);
+
+    // segments at size of screen (box filter of multi x multi texels)
+    sprites.clear();
+    coverage.clear();
+    colors.clear();
+    for(size_t i = 0; i < nb_segment; i++){
+        const Segment& seg = segments[i];
+        const Compositor_Rect& screen = screen_rect[seg.screen];
+        Sprite sprite;
+        sprite.screen = seg.screen;
+        sprite.color = rgb_to_pixel(COMPOSITOR_SEGMENT_COLOR[seg.color_index < 5 ? seg.color_index : 0]);
+        sprite.offset = coverage.size();
+        Compositor_Rect full = { screen.x0 + seg.pos_scr[0] / multi, screen.y0 + seg.pos_scr[1] / multi, 0, 0 };
+        full.x1 = full.x0 + seg.size_tex[0] / multi;
+        full.y1 = full.y0 + seg.size_tex[1] / multi;
+        if(!intersect(full, screen, sprite.rect)){ sprite.rect = { full.x0, full.y0, full.x0, full.y0 }; }
+
+        uint32_t nb_texel = uint32_t(multi * multi);
+        for(int y = sprite.rect.y0; y < sprite.rect.y1; y++){
+            for(int x = sprite.rect.x0; x < sprite.rect.x1; x++){
+                uint32_t sum[4] = {};
+                for(int j = 0; j < multi; j++){
+                    for(int k = 0; k < multi; k++){
+                        uint32_t texel = texel_of_pack(segment_texture, seg.pos_tex[0], seg.pos_tex[1], seg.size_tex[0], seg.size_tex[1]
+                                                        , (x - full.x0) * multi + k, (y - full.y0) * multi + j);
+                        texel = premultiply_texel(texel);
+                        for(int c = 0; c < 4; c++){ sum[c] += (texel >> (8 * c)) & 0xFF; }
+                    }
+                }
+                coverage.push_back(uint8_t((sum[3] + nb_texel / 2) / nb_texel));
+                if(is_mask){
+                    uint32_t pixel = 0;
+                    for(int c = 0; c < 4; c++){ pixel |= ((sum[c] + nb_texel / 2) / nb_texel) << (8 * c); }
+                    colors.push_back(pixel);
+                }
+            }
+        }
+        sprites.push_back(sprite);
+    }
+
+    // layer that never change : shadow of background, background, marking
+    for(int screen = 0; screen < nb_screen && background_texture != nullptr && !background_texture->pixels.empty(); screen++){
+        const Compositor_Rect& rect = screen_rect[screen];
+        int u = background_info[i_bg_x(screen)], v = background_info[i_bg_y(screen)];
+        int w = background_info[i_bg_w(screen)], h = background_info[i_bg_h(screen)];
+        bool with_shadow = background_info[i_bg_shadow(nb_screen)] == 1;
+        int decal = background_in_front ? 3 : 2;
+
+        for(int pass = with_shadow ? 0 : 1; pass < 2; pass++){ // 0 = shadow, 1 = background
+            int move = (pass == 0) ? decal : 0;
+            for(int y = 0; y < h; y++){
+                int frame_y = rect.y0 + y + move;
+                if(frame_y >= rect.y1){ break; }
+                uint32_t* dest = &overlay[size_t(frame_y) * frame.width];
+                for(int x = 0; x < w && rect.x0 + x + move < rect.x1; x++){
+                    uint32_t texel = texel_of_pack(*background_texture, u, v, w, h, x, y);
+                    uint32_t src = (pass == 0) ? (mul_255(texel >> 24, SHADOW_BACKGROUND_ALPHA) << 24) : premultiply_texel(texel);
+                    uint32_t& pixel = dest[rect.x0 + x + move];
+                    pixel = over(pixel, src);
+                }
+            }
+        }
+    }
+    if(!is_mask && settings.segment_marking_alpha != 0){
+        uint32_t marking = rgb_to_pixel(MARKING_COLOR);
+        for(const Sprite& sprite : sprites){
+            const uint8_t* alpha = &coverage[sprite.offset];
+            for(int y = sprite.rect.y0; y < sprite.rect.y1; y++){
+                uint32_t* dest = &overlay[size_t(y) * frame.width];
+                for(int x = sprite.rect.x0; x < sprite.rect.x1; x++){
+                    dest[x] = over(dest[x], premultiply(marking, mul_255(*alpha++, settings.segment_marking_alpha)));
+                }
+            }
+        }
+    }
+
+    drawn.assign((nb_segment + 63) / 64, 0);
+    full_redraw = true;
+    dirty_rects.clear();
+    dirty_screen.clear();
+    return true;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Compose /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Frame_Compositor::add_dirty(const Compositor_Rect& rect, uint8_t screen){
+    Compositor_Rect curr;
+    if(!intersect(rect, screen_rect[screen], curr)){ return; }
+    // merge with rects touching it (segments of a same figure often side by side)
+    bool merged = true;
+    while(merged){
+        merged = false;
+        for(size_t i = 0; i < dirty_rects.size(); i++){
+            const Compositor_Rect& other = dirty_rects[i];
+            if(dirty_screen[i] != screen || other.x0 > curr.x1 || curr.x0 > other.x1 || other.y0 > curr.y1 || curr.y0 > other.y1){ continue; }
+            curr = { other.x0 < curr.x0 ? other.x0 : curr.x0, other.y0 < curr.y0 ? other.y0 : curr.y0
+                    , other.x1 > curr.x1 ? other.x1 : curr.x1, other.y1 > curr.y1 ? other.y1 : curr.y1 };
+            dirty_rects.erase(dirty_rects.begin() + i);
+            dirty_screen.erase(dirty_screen.begin() + i);
+            merged = true;
+            break;
+        }
+    }
+    dirty_rects.push_back(curr);
+    dirty_screen.push_back(screen);
+}
+
+
+bool Frame_Compositor::compose(const Blink_Filter& filter){
+    dirty_rects.clear();
+    dirty_screen.clear();
+    if(filter.size() != sprites.size()){ return false; } // filter of other game
+
+    for(size_t i = 0; i < sprites.size(); i++){
+        uint64_t bit = uint64_t(1) << (i & 63);
+        bool visible = filter.is_visible(i);
+        if(visible == ((drawn[i >> 6] & bit) != 0)){ continue; }
+        drawn[i >> 6] ^= bit;
+        if(full_redraw){ continue; }
+        const Sprite& sprite = sprites[i];
+        Compositor_Rect shadow = move_rect(sprite.rect, shadow_decal);
+        add_dirty({ sprite.rect.x0, sprite.rect.y0, shadow.x1, shadow.y1 }, sprite.screen);
+    }
+    if(full_redraw){
+        for(size_t screen = 0; screen < screen_rect.size(); screen++){ add_dirty(screen_rect[screen], uint8_t(screen)); }
+        full_redraw = false;
+    }
+
+    for(size_t i = 0; i < dirty_rects.size(); i++){ compose_rect(dirty_rects[i], dirty_screen[i]); }
+    return !dirty_rects.empty();
+}
+
+
+void Frame_Compositor::compose_rect(const Compositor_Rect& rect, uint8_t screen){
+    const uint32_t width = frame.width;
+    const uint32_t fond = fond_color;
+    for(int y = rect.y0; y < rect.y1; y++){
+        uint32_t* dest = frame.row(uint32_t(y));
+        for(int x = rect.x0; x < rect.x1; x++){ dest[x] = fond; }
+    }
+
+    // shadow of segments on
+    uint32_t shadow_color = rgb_to_pixel(SHADOW_SEGMENT_COLOR);
+    for(size_t i = 0; i < sprites.size(); i++){
+        const Sprite& sprite = sprites[i];
+        Compositor_Rect part;
+        if(sprite.screen != screen || !((drawn[i >> 6] >> (i & 63)) & 0x01)){ continue; }
+        Compositor_Rect shadow = move_rect(sprite.rect, shadow_decal);
+        if(!intersect(shadow, rect, part)){ continue; }
+        int sprite_width = sprite.rect.x1 - sprite.rect.x0;
+        for(int y = part.y0; y < part.y1; y++){
+            uint32_t* dest = frame.row(uint32_t(y));
+            const uint8_t* alpha = &coverage[sprite.offset + size_t(y - shadow.y0) * sprite_width - shadow.x0];
+            for(int x = part.x0; x < part.x1; x++){
+                dest[x] = over(dest[x], premultiply(shadow_color, mul_255(alpha[x], SHADOW_SEGMENT_ALPHA)));
+            }
+        }
+    }
+
+    // shadow of background, background, marking
+    for(int y = rect.y0; y < rect.y1; y++){
+        uint32_t* dest = frame.row(uint32_t(y));
+        const uint32_t* src = &overlay[size_t(y) * width];
+        for(int x = rect.x0; x < rect.x1; x++){ dest[x] = over(dest[x], src[x]); }
+    }
+
+    // segments on
+    for(size_t i = 0; i < sprites.size(); i++){
+        const Sprite& sprite = sprites[i];
+        Compositor_Rect part;
+        if(sprite.screen != screen || !((drawn[i >> 6] >> (i & 63)) & 0x01)){ continue; }
+        if(!intersect(sprite.rect, rect, part)){ continue; }
+        int sprite_width = sprite.rect.x1 - sprite.rect.x0;
+        for(int y = part.y0; y < part.y1; y++){
+            uint32_t* dest = frame.row(uint32_t(y));
+            size_t first = sprite.offset + size_t(y - sprite.rect.y0) * sprite_width - sprite.rect.x0;
+            if(is_mask){
+                const uint32_t* src = &colors[first];
+                for(int x = part.x0; x < part.x1; x++){ dest[x] = over(dest[x], src[x]); }
+            }
+            else {
+                const uint8_t* alpha = &coverage[first];
+                uint32_t color = sprite.color;
+                for(int x = part.x0; x < part.x1; x++){ dest[x] = over(dest[x], premultiply(color, alpha[x])); }
+            }
+        }
+    }
+}
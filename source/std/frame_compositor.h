@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "segment.h"
+#include "settings.h"
+#include "png_image.h"
+#include "blink_filter.h"
+
+// Software compositor of the LCD of a game : frame capture on host tools, without gpu.
+// Same layers as Virtual_Screen::update_screen (3ds_screen.cpp) in 2D, from back to front :
+//   fond color, shadow of segments on, shadow of background, background, marking of all segments, segments on
+// Textures = png of pack (mirrored on x, y of position from bottom -> same as Android renderer).
+// Game with camera : fond color instead of camera.
+//
+// Layers that never change (shadow of background, background, marking) merged at load in 1 premultiplied layer.
+// Each compose, only rects of segments changed (+ their shadow) are composed again.
+// Screens of game stacked vertically in the frame (screen 0 on top).
+
+struct Compositor_Rect {
+    int x0, y0, x1, y1; // x1 / y1 excluded
+};
+
+class Frame_Compositor {
+public :
+    // background_texture nullptr if game without background image. false + short message in error_out if data not usable
+    bool load(const Segment* segments, size_t nb_segment, const uint16_t* segment_info, const Image_RGBA& segment_texture
+            , const uint16_t* background_info, const Image_RGBA* background_texture
+            , const AppSettings& settings = AppSettings(), std::string* error_out = nullptr);
+
+    // visible segments from filter (set with segments of load, same order) -> true if frame changed
+    bool compose(const Blink_Filter& filter);
+    void invalidate(){ full_redraw = true; } // all screens composed again by next compose
+
+    const Image_RGBA& get_frame() const { return frame; }
+    const std::vector<Compositor_Rect>& get_dirty_rects() const { return dirty_rects; } // rects composed by last compose
+    uint8_t get_nb_screen() const { return uint8_t(screen_rect.size()); }
+
+private :
+    struct Sprite {
+        Compositor_Rect rect; // in frame, clipped to its screen
+        uint8_t screen;
+        uint32_t color; // segment on (not mask)
+        size_t offset; // first pixel in coverage / colors
+    };
+
+    bool is_mask = false;
+    int shadow_decal = 2;
+    uint32_t fond_color = 0;
+    std::vector<Compositor_Rect> screen_rect;
+    std::vector<Sprite> sprites;
+    std::vector<uint8_t> coverage; // alpha of each sprite at size of screen
+    std::vector<uint32_t> colors; // premultiplied pixels of each sprite (mask game)
+    std::vector<uint32_t> overlay; // premultiplied, size of frame
+
+    std::vector<uint64_t> drawn; // segments visible in frame
+    bool full_redraw = true;
+    Image_RGBA frame;
+    std::vector<Compositor_Rect> dirty_rects;
+    std::vector<uint8_t> dirty_screen; // screen of each dirty rect
+
+    void add_dirty(const Compositor_Rect& rect, uint8_t screen);
+    void compose_rect(const Compositor_Rect& rect, uint8_t screen);
+};
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "segment.h"
+#include "SM5XX/get_cpu.h"
 
 #include "debug_log.h"
 #define GWPACK_LOG(...) YOKOI_LOG(__VA_ARGS__)
@@ -539,6 +540,8 @@ bool load(const std::string& path, std::string* error_out) {
             GWPACK_LOG("gw_pack: segments out of range i=%u", (unsigned)i);
             return false;
         }
+        // Segment ids compiled to their bit in segment_bits of the cpu of this rom (no decode at each refresh).
+        const Segment_Layout layout = get_segment_layout(get_cpu_type(rec.storage.rom.data(), (uint16_t)rec.storage.rom.size()));
         if (ge.segments_count > 0) {
             rec.storage.segments.clear();
             rec.storage.segments.resize(ge.segments_count);
@@ -559,6 +562,7 @@ bool load(const std::string& path, std::string* error_out) {
                 s.id[0] = sd.id0;
                 s.id[1] = sd.id1;
                 s.id[2] = sd.id2;
+                s.bit = segment_bit_index(layout, sd.id0, sd.id1, sd.id2);
                 s.pos_scr[0] = (int)sd.pos_scr_x;
                 s.pos_scr[1] = (int)sd.pos_scr_y;
                 s.pos_tex[0] = sd.pos_tex_x;
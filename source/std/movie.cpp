@@ -0,0 +1,235 @@
+#include "movie.h"
+#include "SM5XX/SM5XX.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char MOVIE_MAGIC[4] = { 'Y', 'K', 'M', 'V' };
+constexpr uint8_t MOVIE_FLAG_NO_MULTIPLEX = 0x01;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Record //////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Movie::start_record(SM5XX* cpu, const std::string& ref_game, uint32_t curr_rate){
+    ref = ref_game;
+    frequency = cpu->frequency;
+    rate_start = curr_rate;
+    input_no_multiplex = cpu->input_no_multiplex;
+    cycle_start = cpu->cycle_count;
+    cycle_end = cycle_start;
+    state.assign(cpu->get_state_size(), 0);
+    cpu->snapshot(state.data());
+    input_events.clear();
+
+    recording = true;
+    cpu->movie_record = this;
+}
+
+
+void Movie::stop_record(SM5XX* cpu){
+    if(!recording){ return; }
+    cycle_end = cpu->cycle_count;
+    recording = false;
+    if(cpu->movie_record == this){ cpu->movie_record = nullptr; }
+}
+
+
+void Movie::add_input(uint64_t cycle, int group, int line, bool state){
+    if(!recording){ return; }
+    input_events.push_back({ cycle, uint8_t(group & 0x07), uint8_t(line & 0x0F), state });
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Replay //////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Movie::start_play(SM5XX* cpu){
+    if(state.empty() || cpu->get_state_size() != state.size()){ return false; }
+    cpu->movie_record = nullptr;
+    cpu->input_no_multiplex = input_no_multiplex;
+    cpu->restore(state.data()); // cycle_count = cycle_start in state
+    i_play = 0;
+    return true;
+}
+
+
+void Movie::apply_inputs(SM5XX* cpu){
+    while(i_play < input_events.size() && input_events[i_play].cycle <= cpu->cycle_count){
+        const Movie_Event& event = input_events[i_play];
+        cpu->input_set(event.group, event.line, event.state);
+        i_play++;
+    }
+}
+
+
+uint32_t Movie::play_cycles(SM5XX* cpu, uint32_t nb_cycle, Cycle_Events& events){
+    apply_inputs(cpu);
+    if(i_play < input_events.size()){
+        uint64_t before_event = input_events[i_play].cycle - cpu->cycle_count;
+        if(before_event < nb_cycle){ nb_cycle = uint32_t(before_event); }
+    }
+    return cpu->run_cycles(nb_cycle, events); // events of next cycle applied by next call, as frontend did
+}
+
+
+bool Movie::is_finished(SM5XX* cpu) const {
+    return cpu->cycle_count >= cycle_end;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// File ////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void put_u32(std::vector<uint8_t>& out, uint32_t value){
+    for(int i = 0; i < 4; i++){ out.push_back(uint8_t(value >> (8 * i))); }
+}
+
+static void put_u64(std::vector<uint8_t>& out, uint64_t value){
+    for(int i = 0; i < 8; i++){ out.push_back(uint8_t(value >> (8 * i))); }
+}
+
+static void put_varint(std::vector<uint8_t>& out, uint64_t value){ // 7 bits by octet, bit 7 = more octets
+    while(value >= 0x80){
+        out.push_back(uint8_t(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+// reader of file in memory : false when end of data
+struct Movie_Reader {
+    const std::vector<uint8_t>& data;
+    size_t pos = 0;
+
+    bool get(uint8_t* out, size_t size){
+        if(pos + size > data.size()){ return false; }
+        memcpy(out, &data[pos], size);
+        pos += size;
+        return true;
+    }
+    bool get_u32(uint32_t& value){
+        uint8_t raw[4];
+        if(!get(raw, 4)){ return false; }
+        value = 0;
+        for(int i = 0; i < 4; i++){ value |= uint32_t(raw[i]) << (8 * i); }
+        return true;
+    }
+    bool get_u64(uint64_t& value){
+        uint8_t raw[8];
+        if(!get(raw, 8)){ return false; }
+        value = 0;
+        for(int i = 0; i < 8; i++){ value |= uint64_t(raw[i]) << (8 * i); }
+        return true;
+    }
+    bool get_varint(uint64_t& value){
+        value = 0;
+        for(int shift = 0; shift < 64; shift += 7){
+            if(pos >= data.size()){ return false; }
+            uint8_t octet = data[pos++];
+            value |= uint64_t(octet & 0x7F) << shift;
+            if((octet & 0x80) == 0){ return true; }
+        }
+        return false;
+    }
+};
+
+
+bool Movie::save(const std::string& path, std::string* error_out) const {
+    std::vector<uint8_t> out;
+    out.insert(out.end(), MOVIE_MAGIC, MOVIE_MAGIC + 4);
+    out.push_back(MOVIE_VERSION);
+    out.push_back(input_no_multiplex ? MOVIE_FLAG_NO_MULTIPLEX : 0x00);
+    out.push_back(0x00);
+    out.push_back(0x00);
+
+    char ref_field[MOVIE_REF_SIZE] = {};
+    strncpy(ref_field, ref.c_str(), MOVIE_REF_SIZE - 1);
+    out.insert(out.end(), ref_field, ref_field + MOVIE_REF_SIZE);
+    put_u32(out, frequency);
+    put_u32(out, rate_start);
+    put_u64(out, cycle_start);
+    put_u64(out, cycle_end);
+    put_u32(out, uint32_t(state.size()));
+    out.insert(out.end(), state.begin(), state.end());
+
+    put_u32(out, uint32_t(input_events.size()));
+    uint64_t prev_cycle = cycle_start;
+    for(const Movie_Event& event : input_events){
+        put_varint(out, event.cycle - prev_cycle);
+        out.push_back(uint8_t((event.group << 5) | (event.line << 1) | (event.state ? 1 : 0)));
+        prev_cycle = event.cycle;
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if(!file){
+        if(error_out){ *error_out = "can not create file"; }
+        return false;
+    }
+    bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+    ok = (fclose(file) == 0) && ok;
+    if(!ok && error_out){ *error_out = "write failed"; }
+    return ok;
+}
+
+
+bool Movie::load(const std::string& path, std::string* error_out){
+    auto fail = [&](const char* message){
+        if(error_out){ *error_out = message; }
+        return false;
+    };
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if(!file){ return fail("can not open file"); }
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t nb_read;
+    while((nb_read = fread(buffer, 1, sizeof(buffer), file)) > 0){ data.insert(data.end(), buffer, buffer + nb_read); }
+    fclose(file);
+
+    Movie_Reader reader{ data };
+    uint8_t header[8];
+    if(!reader.get(header, 8) || memcmp(header, MOVIE_MAGIC, 4) != 0){ return fail("not a movie file"); }
+    if(header[4] != MOVIE_VERSION){ return fail("version of movie not supported"); }
+
+    char ref_field[MOVIE_REF_SIZE + 1] = {};
+    uint32_t size_state = 0;
+    uint64_t new_cycle_start = 0, new_cycle_end = 0;
+    uint32_t new_frequency = 0, new_rate_start = 0;
+    if(!reader.get((uint8_t*)ref_field, MOVIE_REF_SIZE) || !reader.get_u32(new_frequency) || !reader.get_u32(new_rate_start)
+        || !reader.get_u64(new_cycle_start) || !reader.get_u64(new_cycle_end) || !reader.get_u32(size_state)
+        || size_state > data.size() - reader.pos || new_cycle_end < new_cycle_start){
+        return fail("header of movie truncated");
+    }
+    std::vector<uint8_t> new_state(size_state);
+    reader.get(new_state.data(), size_state);
+
+    uint32_t nb_event = 0;
+    if(!reader.get_u32(nb_event)){ return fail("events of movie truncated"); }
+    std::vector<Movie_Event> new_events;
+    new_events.reserve(nb_event < data.size() ? nb_event : data.size()); // 2 octets min by event
+    uint64_t cycle = new_cycle_start;
+    for(uint32_t i = 0; i < nb_event; i++){
+        uint64_t delta;
+        uint8_t packed;
+        if(!reader.get_varint(delta) || !reader.get(&packed, 1)){ return fail("events of movie truncated"); }
+        cycle += delta;
+        new_events.push_back({ cycle, uint8_t(packed >> 5), uint8_t((packed >> 1) & 0x0F), (packed & 0x01) != 0 });
+    }
+
+    ref = ref_field;
+    frequency = new_frequency;
+    rate_start = new_rate_start;
+    input_no_multiplex = (header[5] & MOVIE_FLAG_NO_MULTIPLEX) != 0;
+    cycle_start = new_cycle_start;
+    cycle_end = new_cycle_end;
+    state = std::move(new_state);
+    input_events = std::move(new_events);
+    recording = false;
+    i_play = 0;
+    return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class SM5XX;
+struct Cycle_Events;
+
+// Movie : input of a game recorded at the cycle where rom see it -> same run replayed exactly (regression, bug report).
+// Start = snapshot of cpu, then each change of K / alpha / beta done by SM5XX::input_set() with its cycle_count.
+// Replay restore the snapshot and stop run_cycles on cycle of each event -> same segments, whatever the batches.
+//
+// File (little endian) :
+//   "YKMV" version u8, flags u8 (bit0 input_no_multiplex), pad u16
+//   ref char[16], frequency u32, rate_start u32 (remainder of cycles by frame of frontend at start)
+//   cycle_start u64, cycle_end u64, size state u32, state
+//   nb event u32, events : delta of cycle (varint, from previous event) + octet group << 5 | line << 1 | state
+
+constexpr uint8_t MOVIE_VERSION = 1;
+constexpr size_t MOVIE_REF_SIZE = 16;
+
+struct Movie_Event {
+    uint64_t cycle;
+    uint8_t group;
+    uint8_t line; // 8 = alpha, 9 = beta (same as input_set)
+    bool state;
+};
+
+class Movie {
+public :
+    std::string ref; // game of the movie
+    uint32_t frequency = 0;
+    uint32_t rate_start = 0;
+
+    // record : detach with stop_record before delete of cpu
+    void start_record(SM5XX* cpu, const std::string& ref_game, uint32_t curr_rate = 0);
+    void stop_record(SM5XX* cpu);
+    bool is_recording() const { return recording; }
+    void add_input(uint64_t cycle, int group, int line, bool state); // by SM5XX::input_set, only on change
+
+    // replay : cpu of same game (ref), false if state not of this cpu
+    bool start_play(SM5XX* cpu);
+    // same as cpu->run_cycles but stop on cycle of next event, events applied before the cycles
+    uint32_t play_cycles(SM5XX* cpu, uint32_t nb_cycle, Cycle_Events& events);
+    void apply_inputs(SM5XX* cpu); // events until cycle_count of cpu (before each step() if cycle per cycle)
+    bool is_finished(SM5XX* cpu) const;
+    uint64_t get_nb_cycle() const { return cycle_end - cycle_start; }
+    size_t get_nb_event() const { return input_events.size(); }
+
+    // false + short message in error_out if problem
+    bool save(const std::string& path, std::string* error_out = nullptr) const;
+    bool load(const std::string& path, std::string* error_out = nullptr);
+
+private :
+    bool recording = false;
+    bool input_no_multiplex = false;
+    uint64_t cycle_start = 0;
+    uint64_t cycle_end = 0;
+    std::vector<uint8_t> state;
+    std::vector<Movie_Event> input_events;
+    size_t i_play = 0;
+};
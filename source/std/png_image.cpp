@@ -0,0 +1,430 @@
+#include "png_image.h"
+#include <stdio.h>
+#include <string.h>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Inflate (zlib / deflate of IDAT) ////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr int HUFFMAN_MAX_BITS = 15;
+
+// bits of deflate stream : first bit = bit 0 of octet
+struct Bit_Reader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+    uint32_t bit_buffer = 0;
+    int nb_bit = 0;
+    bool overflow = false; // read after end of data
+
+    uint32_t bits(int need){
+        uint32_t value = bit_buffer;
+        while(nb_bit < need){
+            if(pos >= size){ overflow = true; return 0; }
+            value |= uint32_t(data[pos++]) << nb_bit;
+            nb_bit += 8;
+        }
+        bit_buffer = value >> need;
+        nb_bit -= need;
+        return value & ((1u << need) - 1);
+    }
+};
+
+// canonical huffman : nb code by length + symbols sorted by code
+struct Huffman {
+    uint16_t count[HUFFMAN_MAX_BITS + 1];
+    uint16_t symbol[288];
+};
+
+bool build_huffman(Huffman& huffman, const uint8_t* length, int nb_symbol){
+    memset(huffman.count, 0, sizeof(huffman.count));
+    for(int i = 0; i < nb_symbol; i++){ huffman.count[length[i]]++; }
+    if(huffman.count[0] == nb_symbol){ return true; } // no code (distances of block with only literals)
+
+    int left = 1;
+    for(int len = 1; len <= HUFFMAN_MAX_BITS; len++){
+        left = (left << 1) - huffman.count[len];
+        if(left < 0){ return false; } // too many codes
+    }
+    uint16_t offset[HUFFMAN_MAX_BITS + 1];
+    offset[1] = 0;
+    for(int len = 1; len < HUFFMAN_MAX_BITS; len++){ offset[len + 1] = offset[len] + huffman.count[len]; }
+    for(int i = 0; i < nb_symbol; i++){
+        if(length[i] != 0){ huffman.symbol[offset[length[i]]++] = uint16_t(i); }
+    }
+    return true;
+}
+
+int decode_symbol(Bit_Reader& in, const Huffman& huffman){
+    int code = 0, first = 0, index = 0;
+    for(int len = 1; len <= HUFFMAN_MAX_BITS; len++){
+        code |= int(in.bits(1));
+        int count = huffman.count[len];
+        if(code - count < first){ return huffman.symbol[index + (code - first)]; }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+bool inflate_codes(Bit_Reader& in, const Huffman& literal, const Huffman& distance, std::vector<uint8_t>& out, size_t max_out){
+    for(;;){
+        int symbol = decode_symbol(in, literal);
+        if(symbol < 0 || in.overflow){ return false; }
+        if(symbol < 256){ out.push_back(uint8_t(symbol)); }
+        else if(symbol == 256){ return true; } // end of block
+        else {
+            symbol -= 257;
+            if(symbol >= 29){ return false; }
+            size_t len = LENGTH_BASE[symbol] + in.bits(LENGTH_EXTRA[symbol]);
+            int symbol_distance = decode_symbol(in, distance);
+            if(symbol_distance < 0 || symbol_distance >= 30){ return false; }
+            size_t dist = DISTANCE_BASE[symbol_distance] + in.bits(DISTANCE_EXTRA[symbol_distance]);
+            if(in.overflow || dist > out.size() || out.size() + len > max_out){ return false; }
+            size_t from = out.size() - dist;
+            for(size_t i = 0; i < len; i++){ out.push_back(out[from + i]); } // copy can overlap itself
+        }
+        if(out.size() > max_out){ return false; }
+    }
+}
+
+bool inflate_dynamic_tables(Bit_Reader& in, Huffman& literal, Huffman& distance){
+    static const uint8_t ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+    int nb_literal = int(in.bits(5)) + 257;
+    int nb_distance = int(in.bits(5)) + 1;
+    int nb_code = int(in.bits(4)) + 4;
+    if(nb_literal > 286 || nb_distance > 30){ return false; }
+
+    uint8_t length[286 + 30] = {};
+    for(int i = 0; i < nb_code; i++){ length[ORDER[i]] = uint8_t(in.bits(3)); }
+    Huffman code_length;
+    if(!build_huffman(code_length, length, 19)){ return false; }
+
+    int i = 0;
+    while(i < nb_literal + nb_distance){
+        int symbol = decode_symbol(in, code_length);
+        if(symbol < 0 || in.overflow){ return false; }
+        if(symbol < 16){ length[i++] = uint8_t(symbol); continue; }
+
+        uint8_t value = 0;
+        int repeat;
+        if(symbol == 16){
+            if(i == 0){ return false; }
+            value = length[i - 1];
+            repeat = 3 + int(in.bits(2));
+        }
+        else if(symbol == 17){ repeat = 3 + int(in.bits(3)); }
+        else { repeat = 11 + int(in.bits(7)); }
+        if(i + repeat > nb_literal + nb_distance){ return false; }
+        while(repeat-- > 0){ length[i++] = value; }
+    }
+    if(length[256] == 0){ return false; } // no end of block
+    return build_huffman(literal, length, nb_literal) && build_huffman(distance, length + nb_literal, nb_distance);
+}
+
+// zlib stream -> data, max_out = size expected (protection against broken file)
+bool zlib_inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out, size_t max_out){
+    if(size < 2 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20)){ return false; }
+    Bit_Reader in{ data + 2, size - 2 };
+    out.reserve(max_out);
+
+    bool last = false;
+    while(!last){
+        last = in.bits(1) != 0;
+        uint32_t type = in.bits(2);
+        if(in.overflow){ return false; }
+        if(type == 0){ // stored
+            in.bit_buffer = 0;
+            in.nb_bit = 0;
+            if(in.pos + 4 > in.size){ return false; }
+            uint32_t len = in.data[in.pos] | (in.data[in.pos + 1] << 8);
+            uint32_t nlen = in.data[in.pos + 2] | (in.data[in.pos + 3] << 8);
+            in.pos += 4;
+            if(len != (~nlen & 0xFFFF) || in.pos + len > in.size || out.size() + len > max_out){ return false; }
+            out.insert(out.end(), in.data + in.pos, in.data + in.pos + len);
+            in.pos += len;
+        }
+        else if(type == 1){ // fixed huffman
+            struct Fixed_Tables { Huffman literal, distance; };
+            static const Fixed_Tables fixed = [](){ // init thread safe (static)
+                Fixed_Tables tables;
+                uint8_t length[288];
+                for(int i = 0; i < 288; i++){ length[i] = (i < 144) ? 8 : (i < 256) ? 9 : (i < 280) ? 7 : 8; }
+                build_huffman(tables.literal, length, 288);
+                for(int i = 0; i < 30; i++){ length[i] = 5; }
+                build_huffman(tables.distance, length, 30);
+                return tables;
+            }();
+            if(!inflate_codes(in, fixed.literal, fixed.distance, out, max_out)){ return false; }
+        }
+        else if(type == 2){ // dynamic huffman
+            Huffman literal, distance;
+            if(!inflate_dynamic_tables(in, literal, distance)){ return false; }
+            if(!inflate_codes(in, literal, distance, out, max_out)){ return false; }
+        }
+        else { return false; }
+    }
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// PNG /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const uint8_t PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+enum : uint8_t { PNG_GRAY = 0, PNG_RGB = 2, PNG_PALETTE = 3, PNG_GRAY_ALPHA = 4, PNG_RGBA = 6 };
+
+uint32_t read_be32(const uint8_t* p){ return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3]; }
+
+uint8_t paeth(int a, int b, int c){
+    int p = a + b - c;
+    int pa = p > a ? p - a : a - p;
+    int pb = p > b ? p - b : b - p;
+    int pc = p > c ? p - c : c - p;
+    if(pa <= pb && pa <= pc){ return uint8_t(a); }
+    return uint8_t(pb <= pc ? b : c);
+}
+
+// filter of each row removed in place (filter octet kept)
+bool unfilter(std::vector<uint8_t>& raw, uint32_t height, size_t stride, size_t bpp){
+    const uint8_t* prev = nullptr;
+    for(uint32_t y = 0; y < height; y++){
+        uint8_t* line = &raw[y * (stride + 1)];
+        uint8_t filter = line[0];
+        uint8_t* curr = line + 1;
+        for(size_t i = 0; i < stride; i++){
+            int a = (i >= bpp) ? curr[i - bpp] : 0;
+            int b = prev ? prev[i] : 0;
+            int c = (prev && i >= bpp) ? prev[i - bpp] : 0;
+            switch(filter){
+                case 0: break;
+                case 1: curr[i] = uint8_t(curr[i] + a); break;
+                case 2: curr[i] = uint8_t(curr[i] + b); break;
+                case 3: curr[i] = uint8_t(curr[i] + ((a + b) >> 1)); break;
+                case 4: curr[i] = uint8_t(curr[i] + paeth(a, b, c)); break;
+                default: return false;
+            }
+        }
+        prev = curr;
+    }
+    return true;
+}
+
+} // namespace
+
+
+bool png_decode(const uint8_t* data, size_t size, Image_RGBA& out, std::string* error_out){
+    auto fail = [&](const char* message){
+        if(error_out){ *error_out = message; }
+        return false;
+    };
+    if(size < 8 || memcmp(data, PNG_SIGNATURE, 8) != 0){ return fail("not a png file"); }
+
+    uint32_t width = 0, height = 0;
+    uint8_t depth = 0, color_type = 0;
+    bool header_read = false;
+    uint32_t palette[256];
+    size_t nb_palette = 0;
+    int transparent[3] = { -1, -1, -1 }; // tRNS of gray / RGB
+    std::vector<uint8_t> idat;
+
+    size_t pos = 8;
+    for(;;){
+        if(pos + 12 > size){ return fail("png truncated"); }
+        uint32_t len = read_be32(&data[pos]);
+        const uint8_t* type = &data[pos + 4];
+        const uint8_t* chunk = &data[pos + 8];
+        if(len > size - pos - 12){ return fail("png truncated"); }
+        pos += 12 + len;
+
+        if(memcmp(type, "IHDR", 4) == 0){
+            if(len < 13){ return fail("bad png header"); }
+            width = read_be32(chunk);
+            height = read_be32(chunk + 4);
+            depth = chunk[8];
+            color_type = chunk[9];
+            if(chunk[10] != 0 || chunk[11] != 0){ return fail("bad png header"); }
+            if(chunk[12] != 0){ return fail("interlaced png not supported"); }
+            bool depth_ok = (depth == 8) || (depth == 16 && color_type != PNG_PALETTE)
+                            || (depth < 8 && (depth == 1 || depth == 2 || depth == 4) && (color_type == PNG_GRAY || color_type == PNG_PALETTE));
+            bool type_ok = color_type == PNG_GRAY || color_type == PNG_RGB || color_type == PNG_PALETTE
+                            || color_type == PNG_GRAY_ALPHA || color_type == PNG_RGBA;
+            if(!depth_ok || !type_ok){ return fail("format of png not supported"); }
+            if(width == 0 || height == 0 || width > 16384 || height > 16384){ return fail("size of png not supported"); }
+            header_read = true;
+        }
+        else if(memcmp(type, "PLTE", 4) == 0){
+            nb_palette = len / 3 > 256 ? 256 : len / 3;
+            for(size_t i = 0; i < nb_palette; i++){
+                palette[i] = chunk[i * 3] | (chunk[i * 3 + 1] << 8) | (chunk[i * 3 + 2] << 16) | 0xFF000000u;
+            }
+        }
+        else if(memcmp(type, "tRNS", 4) == 0){
+            if(color_type == PNG_PALETTE){
+                for(size_t i = 0; i < len && i < nb_palette; i++){ palette[i] = (palette[i] & 0x00FFFFFF) | (uint32_t(chunk[i]) << 24); }
+            }
+            else if(color_type == PNG_GRAY && len >= 2){ transparent[0] = (chunk[0] << 8) | chunk[1]; }
+            else if(color_type == PNG_RGB && len >= 6){
+                for(int i = 0; i < 3; i++){ transparent[i] = (chunk[i * 2] << 8) | chunk[i * 2 + 1]; }
+            }
+        }
+        else if(memcmp(type, "IDAT", 4) == 0){ idat.insert(idat.end(), chunk, chunk + len); }
+        else if(memcmp(type, "IEND", 4) == 0){ break; }
+        else if(!(type[0] & 0x20)){ return fail("critical chunk of png not supported"); }
+    }
+    if(!header_read){ return fail("bad png header"); }
+    if(color_type == PNG_PALETTE && nb_palette == 0){ return fail("png without palette"); }
+
+    static const uint8_t CHANNELS[7] = { 1, 0, 3, 1, 2, 0, 4 };
+    size_t bits_by_pixel = size_t(CHANNELS[color_type]) * depth;
+    size_t stride = (size_t(width) * bits_by_pixel + 7) / 8;
+    size_t bpp = (bits_by_pixel + 7) / 8;
+    std::vector<uint8_t> raw;
+    if(!zlib_inflate(idat.data(), idat.size(), raw, (stride + 1) * height) || raw.size() != (stride + 1) * height){
+        return fail("data of png broken");
+    }
+    if(!unfilter(raw, height, stride, bpp)){ return fail("data of png broken"); }
+
+    out.resize(width, height);
+    for(uint32_t y = 0; y < height; y++){
+        const uint8_t* line = &raw[y * (stride + 1) + 1];
+        uint32_t* dest = out.row(y);
+        for(uint32_t x = 0; x < width; x++){
+            if(depth < 8){ // gray or palette
+                size_t bit = size_t(x) * depth;
+                int value = (line[bit >> 3] >> (8 - depth - (bit & 7))) & ((1 << depth) - 1);
+                if(color_type == PNG_PALETTE){ dest[x] = (size_t(value) < nb_palette) ? palette[value] : 0; continue; }
+                uint32_t gray = uint32_t(value * 255 / ((1 << depth) - 1));
+                uint32_t alpha = (value == transparent[0]) ? 0 : 0xFF;
+                dest[x] = gray | (gray << 8) | (gray << 16) | (alpha << 24);
+                continue;
+            }
+            // 8 or 16 bits by channel : 8 bits of high weight
+            size_t step = depth / 8;
+            const uint8_t* p = line + size_t(x) * CHANNELS[color_type] * step;
+            auto sample = [&](int i){ return uint32_t(p[i * step]); };
+            auto full = [&](int i){ return (step == 2) ? ((p[i * 2] << 8) | p[i * 2 + 1]) : p[i]; };
+            switch(color_type){
+                case PNG_GRAY : {
+                    uint32_t alpha = (full(0) == transparent[0]) ? 0 : 0xFF;
+                    dest[x] = sample(0) | (sample(0) << 8) | (sample(0) << 16) | (alpha << 24);
+                    break;
+                }
+                case PNG_RGB : {
+                    bool key = full(0) == transparent[0] && full(1) == transparent[1] && full(2) == transparent[2];
+                    dest[x] = sample(0) | (sample(1) << 8) | (sample(2) << 16) | (key ? 0 : 0xFF000000u);
+                    break;
+                }
+                case PNG_PALETTE : dest[x] = (p[0] < nb_palette) ? palette[p[0]] : 0; break;
+                case PNG_GRAY_ALPHA : dest[x] = sample(0) | (sample(0) << 8) | (sample(0) << 16) | (sample(1) << 24); break;
+                default : dest[x] = sample(0) | (sample(1) << 8) | (sample(2) << 16) | (sample(3) << 24); break;
+            }
+        }
+    }
+    return true;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Write ///////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t size){
+    struct Crc_Table { uint32_t value[256]; };
+    static const Crc_Table table = [](){
+        Crc_Table t;
+        for(uint32_t n = 0; n < 256; n++){
+            uint32_t c = n;
+            for(int k = 0; k < 8; k++){ c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1; }
+            t.value[n] = c;
+        }
+        return t;
+    }();
+    for(size_t i = 0; i < size; i++){ crc = table.value[(crc ^ data[i]) & 0xFF] ^ (crc >> 8); }
+    return crc;
+}
+
+void put_be32(std::vector<uint8_t>& out, uint32_t value){
+    for(int i = 3; i >= 0; i--){ out.push_back(uint8_t(value >> (8 * i))); }
+}
+
+void put_chunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t size){
+    put_be32(out, uint32_t(size));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    put_be32(out, ~crc32_update(0xFFFFFFFFu, &out[start], size + 4));
+}
+
+} // namespace
+
+
+bool png_save(const std::string& path, const Image_RGBA& image, std::string* error_out){
+    std::vector<uint8_t> out(PNG_SIGNATURE, PNG_SIGNATURE + 8);
+
+    uint8_t header[13];
+    for(int i = 0; i < 4; i++){
+        header[i] = uint8_t(image.width >> (24 - 8 * i));
+        header[4 + i] = uint8_t(image.height >> (24 - 8 * i));
+    }
+    header[8] = 8; // bits by channel
+    header[9] = PNG_RGBA;
+    header[10] = header[11] = header[12] = 0;
+    put_chunk(out, "IHDR", header, 13);
+
+    // rows without filter, in deflate stored blocks of 65535 octets max
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t(image.width) * 4 + 1) * image.height);
+    for(uint32_t y = 0; y < image.height; y++){
+        raw.push_back(0);
+        const uint32_t* line = image.row(y);
+        for(uint32_t x = 0; x < image.width; x++){
+            for(int c = 0; c < 4; c++){ raw.push_back(uint8_t(line[x] >> (8 * c))); }
+        }
+    }
+    std::vector<uint8_t> zlib = { 0x78, 0x01 };
+    zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    size_t pos = 0;
+    do {
+        size_t len = raw.size() - pos < 65535 ? raw.size() - pos : 65535;
+        zlib.push_back(pos + len == raw.size() ? 1 : 0); // last block
+        zlib.push_back(uint8_t(len));
+        zlib.push_back(uint8_t(len >> 8));
+        zlib.push_back(uint8_t(~len));
+        zlib.push_back(uint8_t(~len >> 8));
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    } while(pos < raw.size());
+    uint32_t adler_a = 1, adler_b = 0;
+    for(uint8_t octet : raw){
+        adler_a = (adler_a + octet) % 65521;
+        adler_b = (adler_b + adler_a) % 65521;
+    }
+    put_be32(zlib, (adler_b << 16) | adler_a);
+    put_chunk(out, "IDAT", zlib.data(), zlib.size());
+    put_chunk(out, "IEND", nullptr, 0);
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if(!file){
+        if(error_out){ *error_out = "can not create file"; }
+        return false;
+    }
+    bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+    ok = (fclose(file) == 0) && ok;
+    if(!ok && error_out){ *error_out = "write failed"; }
+    return ok;
+}
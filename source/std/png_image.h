@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Image RGBA 8 bits for host tools (frame capture) : no libpng / zlib needed.
+// pixel = R | G << 8 | B << 16 | A << 24, row 0 = top (as in png file)
+
+struct Image_RGBA {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint32_t> pixels;
+
+    void resize(uint32_t new_width, uint32_t new_height, uint32_t color = 0){
+        width = new_width;
+        height = new_height;
+        pixels.assign(size_t(width) * height, color);
+    }
+    uint32_t* row(uint32_t y){ return &pixels[size_t(y) * width]; }
+    const uint32_t* row(uint32_t y) const { return &pixels[size_t(y) * width]; }
+};
+
+// png of pack (textures from CONVERT_ROM : RGBA / RGB / gray / palette, not interlaced)
+// false + short message in error_out if format not supported or data broken
+bool png_decode(const uint8_t* data, size_t size, Image_RGBA& out, std::string* error_out = nullptr);
+
+// png RGBA 8 bits, not compressed (deflate stored) -> fast to write, any viewer can open it
+bool png_save(const std::string& path, const Image_RGBA& image, std::string* error_out = nullptr);
@@ -0,0 +1,226 @@
+#include "rewind.h"
+#include "SM5XX/SM5XX.h"
+#include <string.h>
+
+constexpr uint8_t REWIND_KIND_KEY = 0;
+constexpr uint8_t REWIND_KIND_DELTA = 1;
+constexpr size_t REWIND_MARK_SIZE = 3; // size u16 + kind u8, before and after data
+constexpr uint8_t REWIND_MIN_ZERO_RUN = 3; // less -> stay in literal (1 token = 2 octets)
+
+
+void Rewind_Buffer::init(size_t size_state, size_t arena_size, uint16_t interval_key, uint8_t interval_frame){
+    state_size = size_state;
+    keyframe_interval = (interval_key == 0) ? 1 : interval_key;
+    frame_interval = (interval_frame == 0) ? 1 : interval_frame;
+
+    arena.assign(arena_size, 0);
+    key_state.assign(state_size, 0);
+    curr_state.assign(state_size, 0);
+    encoded.assign(state_size * 3 + 4, 0); // worst case : 1 token of 2 octets by literal octet
+    clear();
+}
+
+
+void Rewind_Buffer::clear(){
+    head = 0;
+    tail = 0;
+    used = 0;
+    nb_entry = 0;
+    frame_count = 0;
+    key_valid = false;
+    key_pos = 0;
+    nb_since_key = 0;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Record / rewind /////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Rewind_Buffer::record(SM5XX* cpu){
+    if(arena.empty()){ return; }
+    frame_count += 1;
+    if(frame_count < frame_interval){ return; }
+    frame_count = 0;
+
+    cpu->snapshot(curr_state.data());
+
+    bool is_key = !key_valid || nb_since_key >= keyframe_interval;
+    size_t size = encode(curr_state.data(), is_key ? nullptr : key_state.data());
+    if(!push_entry(is_key ? REWIND_KIND_KEY : REWIND_KIND_DELTA, size)){
+        if(is_key){ return; } // arena smaller than 1 state
+        // keyframe dropped to have space -> this state become the keyframe
+        is_key = true;
+        size = encode(curr_state.data(), nullptr);
+        if(!push_entry(REWIND_KIND_KEY, size)){ return; }
+    }
+
+    if(is_key){
+        memcpy(key_state.data(), curr_state.data(), state_size);
+        key_valid = true;
+        nb_since_key = 0;
+    }
+    nb_since_key += 1;
+}
+
+
+bool Rewind_Buffer::rewind(SM5XX* cpu){
+    if(nb_entry == 0){ return false; }
+
+    uint16_t size;
+    uint8_t kind;
+    read_mark((head + arena.size() - REWIND_MARK_SIZE) % arena.size(), size, kind);
+    size_t start = (head + arena.size() - (size + 2 * REWIND_MARK_SIZE)) % arena.size();
+    read_arena((start + REWIND_MARK_SIZE) % arena.size(), encoded.data(), size);
+    decode(encoded.data(), size, (kind == REWIND_KIND_KEY) ? nullptr : key_state.data(), curr_state.data());
+    cpu->restore(curr_state.data());
+
+    head = start;
+    used -= size + 2 * REWIND_MARK_SIZE;
+    nb_entry -= 1;
+    frame_count = 0;
+
+    if(kind == REWIND_KIND_KEY){ load_key_of_head(); }
+    else { nb_since_key -= 1; }
+    return true;
+}
+
+
+void Rewind_Buffer::load_key_of_head(){
+    // walk back to keyframe of newest entry (max keyframe_interval entries)
+    key_valid = false;
+    nb_since_key = 0;
+    size_t pos = head;
+    for(uint32_t i = 0; i < nb_entry; i++){
+        uint16_t size;
+        uint8_t kind;
+        read_mark((pos + arena.size() - REWIND_MARK_SIZE) % arena.size(), size, kind);
+        pos = (pos + arena.size() - (size + 2 * REWIND_MARK_SIZE)) % arena.size();
+        nb_since_key += 1;
+        if(kind == REWIND_KIND_KEY){
+            read_arena((pos + REWIND_MARK_SIZE) % arena.size(), encoded.data(), size);
+            decode(encoded.data(), size, nullptr, key_state.data());
+            key_valid = true;
+            key_pos = pos;
+            return;
+        }
+    }
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// Arena ///////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Rewind_Buffer::push_entry(uint8_t kind, size_t size){
+    size_t total = size + 2 * REWIND_MARK_SIZE;
+    if(total > arena.size()){ return false; }
+
+    while(arena.size() - used < total){ drop_oldest(); }
+    if(kind == REWIND_KIND_DELTA && !key_valid){ return false; } // its keyframe was in dropped entries
+
+    uint8_t mark[REWIND_MARK_SIZE] = { uint8_t(size & 0xFF), uint8_t(size >> 8), kind };
+    if(kind == REWIND_KIND_KEY){ key_pos = head; }
+    write_arena(head, mark, REWIND_MARK_SIZE);
+    write_arena((head + REWIND_MARK_SIZE) % arena.size(), encoded.data(), size);
+    write_arena((head + REWIND_MARK_SIZE + size) % arena.size(), mark, REWIND_MARK_SIZE);
+
+    head = (head + total) % arena.size();
+    used += total;
+    nb_entry += 1;
+    return true;
+}
+
+
+void Rewind_Buffer::drop_oldest(){
+    // oldest entry is always a keyframe : drop it and its deltas (no use without it)
+    bool first = true;
+    while(nb_entry > 0){
+        uint16_t size;
+        uint8_t kind;
+        read_mark(tail, size, kind);
+        if(!first && kind == REWIND_KIND_KEY){ break; }
+        if(kind == REWIND_KIND_KEY && tail == key_pos){ key_valid = false; } // keyframe of newest entries
+
+        tail = (tail + size + 2 * REWIND_MARK_SIZE) % arena.size();
+        used -= size + 2 * REWIND_MARK_SIZE;
+        nb_entry -= 1;
+        first = false;
+    }
+}
+
+
+void Rewind_Buffer::write_arena(size_t pos, const uint8_t* data, size_t size){
+    size_t first = (pos + size <= arena.size()) ? size : arena.size() - pos;
+    memcpy(&arena[pos], data, first);
+    if(first < size){ memcpy(&arena[0], data + first, size - first); }
+}
+
+void Rewind_Buffer::read_arena(size_t pos, uint8_t* data, size_t size){
+    size_t first = (pos + size <= arena.size()) ? size : arena.size() - pos;
+    memcpy(data, &arena[pos], first);
+    if(first < size){ memcpy(data + first, &arena[0], size - first); }
+}
+
+void Rewind_Buffer::read_mark(size_t pos, uint16_t& size, uint8_t& kind){
+    uint8_t mark[REWIND_MARK_SIZE];
+    read_arena(pos, mark, REWIND_MARK_SIZE);
+    size = uint16_t(mark[0] | (mark[1] << 8));
+    kind = mark[2];
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// XOR delta + run length //////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// token : [nb octets = 0][nb literal octets][literals]. Octet = state XOR key (key = 0 for keyframe).
+// zeros at end not written -> state without change = 0 octet
+
+size_t Rewind_Buffer::encode(const uint8_t* state, const uint8_t* key){
+    auto value = [&](size_t i) -> uint8_t { return key ? (state[i] ^ key[i]) : state[i]; };
+    auto is_zero_run = [&](size_t i){ // short run of 0 -> cheaper in literal
+        for(size_t j = i; j < i + REWIND_MIN_ZERO_RUN && j < state_size; j++){
+            if(value(j) != 0){ return false; }
+        }
+        return true;
+    };
+
+    size_t out = 0;
+    size_t i = 0;
+    while(i < state_size){
+        uint8_t nb_zero = 0;
+        while(i < state_size && nb_zero < 255 && value(i) == 0){ nb_zero++; i++; }
+        if(i == state_size){ break; }
+
+        size_t pos_nb_literal = out + 1;
+        encoded[out] = nb_zero;
+        out += 2;
+        uint8_t nb_literal = 0;
+        while(i < state_size && nb_literal < 255 && !is_zero_run(i)){
+            encoded[out++] = value(i);
+            nb_literal++;
+            i++;
+        }
+        encoded[pos_nb_literal] = nb_literal;
+    }
+    return out;
+}
+
+
+void Rewind_Buffer::decode(const uint8_t* data, size_t size, const uint8_t* key, uint8_t* state){
+    if(key){ memcpy(state, key, state_size); }
+    else { memset(state, 0, state_size); }
+
+    size_t i = 0;
+    size_t p = 0;
+    while(p + 1 < size){
+        i += data[p];
+        uint8_t nb_literal = data[p + 1];
+        p += 2;
+        for(uint8_t j = 0; j < nb_literal; j++, i++, p++){ state[i] = key ? (state[i] ^ data[p]) : data[p]; }
+    }
+}
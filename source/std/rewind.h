@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class SM5XX;
+
+// Rewind : ring of cpu states (SM5XX::snapshot) in a fixed arena, allocated once by init (no allocation during play).
+// A keyframe each keyframe_interval states, other states are XOR with their keyframe -> mostly 0 -> run length.
+// 1 state ~ 20-35 octets -> 512 KB = 4-6 minutes at 60 states per second. Arena full -> oldest keyframe and its deltas dropped.
+//
+// Entry in arena (circular) : [size u16][kind u8] [data] [size u16][kind u8] -> walk from both sides
+
+constexpr size_t REWIND_DEFAULT_ARENA = 512 * 1024;
+constexpr uint16_t REWIND_DEFAULT_KEYFRAME = 60; // 1 keyframe / s at 60 states per second
+
+class Rewind_Buffer {
+public :
+    // state_size = cpu->get_state_size(). frame_interval : 1 state each n frames
+    void init(size_t state_size, size_t arena_size = REWIND_DEFAULT_ARENA,
+              uint16_t keyframe_interval = REWIND_DEFAULT_KEYFRAME, uint8_t frame_interval = 1);
+    void clear(); // new game, load of save : history not valid
+
+    void record(SM5XX* cpu); // call after each frame
+    bool rewind(SM5XX* cpu); // newest state -> cpu, removed from history. false if history empty
+
+    bool is_init() const { return !arena.empty(); }
+    uint32_t nb_state() const { return nb_entry; }
+    size_t memory_used() const { return used; }
+
+private :
+    std::vector<uint8_t> arena;
+    size_t head = 0; // next write
+    size_t tail = 0; // oldest entry
+    size_t used = 0;
+    uint32_t nb_entry = 0;
+
+    size_t state_size = 0;
+    uint16_t keyframe_interval = REWIND_DEFAULT_KEYFRAME;
+    uint8_t frame_interval = 1;
+    uint8_t frame_count = 0;
+
+    // keyframe of newest entry (decoded), position of its entry in arena
+    bool key_valid = false;
+    size_t key_pos = 0;
+    uint16_t nb_since_key = 0;
+
+    // work buffers, size fixed by init
+    std::vector<uint8_t> key_state;
+    std::vector<uint8_t> curr_state;
+    std::vector<uint8_t> encoded;
+
+    size_t encode(const uint8_t* state, const uint8_t* key); // -> encoded, key = nullptr for keyframe
+    void decode(const uint8_t* data, size_t size, const uint8_t* key, uint8_t* state);
+
+    void write_arena(size_t pos, const uint8_t* data, size_t size);
+    void read_arena(size_t pos, uint8_t* data, size_t size);
+    void read_mark(size_t pos, uint16_t& size, uint8_t& kind);
+
+    void drop_oldest(); // oldest keyframe + its deltas
+    bool push_entry(uint8_t kind, size_t size); // encoded -> arena, false if key of entry dropped for space
+    void load_key_of_head(); // after rewind : keyframe of new newest entry
+};
@@ -0,0 +1,84 @@
+#include "run_ahead.h"
+#include "timer.h"
+#include "GW_ROM.h"
+#include "SM5XX/SM5XX.h"
+#include "SM5XX/get_cpu.h"
+
+
+Run_Ahead::~Run_Ahead(){
+    delete second_cpu;
+}
+
+
+bool Run_Ahead::configure(SM5XX* cpu, const GW_rom* game, uint8_t new_mode, uint8_t new_nb_frame){
+    disable();
+    if(cpu == nullptr || new_mode == RUN_AHEAD_OFF || new_nb_frame == 0){ return true; }
+
+    if(new_mode == RUN_AHEAD_SECOND){
+        if(game == nullptr || !get_cpu(second_cpu, game->rom, game->size_rom)){ second_cpu = nullptr; return false; }
+        second_cpu->init();
+        second_cpu->load_rom(game->rom, game->size_rom);
+        second_cpu->load_rom_melody(game->melody, game->size_melody);
+        second_cpu->load_rom_time_addresses(game->ref);
+        // config not in snapshot
+        second_cpu->input_no_multiplex = cpu->input_no_multiplex;
+        second_cpu->busy_loop_skip = cpu->busy_loop_skip;
+        second_cpu->translated_rom = cpu->translated_rom;
+        second_cpu->block_cache = cpu->block_cache;
+    }
+
+    mode = new_mode;
+    nb_frame = (new_nb_frame > RUN_AHEAD_MAX_FRAME) ? RUN_AHEAD_MAX_FRAME : new_nb_frame;
+    state.assign(cpu->get_state_size(), 0);
+    return true;
+}
+
+
+void Run_Ahead::disable(){
+    mode = RUN_AHEAD_OFF;
+    nb_frame = 0;
+    delete second_cpu;
+    second_cpu = nullptr;
+    curr_rate = 0;
+    last_cost_us = 0;
+    average_cost_us = 0;
+    sum_cost_us = 0;
+    nb_cost = 0;
+}
+
+
+SM5XX* Run_Ahead::run_frames_ahead(SM5XX* cpu, float fps){
+    time_start = time_us_64_p();
+
+    cpu->snapshot(state.data());
+    SM5XX* future = cpu;
+    if(mode == RUN_AHEAD_SECOND){
+        second_cpu->frequency = cpu->frequency;
+        second_cpu->restore(state.data());
+        future = second_cpu;
+    }
+
+    Cycle_Events cycle_events; // sound of frames ahead ignored
+    for(uint8_t i = 0; i < nb_frame; i++){
+        curr_rate += future->frequency;
+        uint32_t step = uint32_t(curr_rate / fps);
+        curr_rate -= uint32_t(step * fps);
+        while(step > 0){ step -= future->run_cycles(step, cycle_events); }
+    }
+    future->segments_state_are_update = true; // future always presented (restore of real state after)
+    return future;
+}
+
+
+void Run_Ahead::end_frame(SM5XX* cpu){
+    if(mode == RUN_AHEAD_SINGLE){ cpu->restore(state.data()); }
+
+    last_cost_us = uint32_t(time_us_64_p() - time_start);
+    sum_cost_us += last_cost_us;
+    nb_cost += 1;
+    if(nb_cost >= RUN_AHEAD_COST_WINDOW){
+        average_cost_us = sum_cost_us / nb_cost;
+        sum_cost_us = 0;
+        nb_cost = 0;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class SM5XX;
+struct GW_rom;
+
+// Run-ahead : game read input and show result on next refresh of lcd, frontend add 1 frame more.
+// After each real frame : cpu state copied, nb_frame emulated with same input, segments of this future presented,
+// real state kept -> game react up to nb_frame earlier on screen. Input still read by rom at its own rhythm.
+//
+// RUN_AHEAD_SINGLE : same cpu, snapshot before frames ahead and restore after (sound of frames ahead not used).
+// RUN_AHEAD_SECOND : second cpu with same rom, copy of real cpu each frame -> real cpu never touched,
+//                    sound and caches of real cpu (busy loop, blocks) stay continuous. 1 cpu more in memory.
+
+enum Run_Ahead_Mode : uint8_t {
+    RUN_AHEAD_OFF = 0,
+    RUN_AHEAD_SINGLE = 1,
+    RUN_AHEAD_SECOND = 2
+};
+
+constexpr uint8_t RUN_AHEAD_MAX_FRAME = 4;
+constexpr uint8_t RUN_AHEAD_COST_WINDOW = 60; // cost averaged on 1 s
+
+class Run_Ahead {
+public :
+    ~Run_Ahead();
+
+    // new game or new setting. game = rom of second cpu. nb_frame = 0 or mode OFF -> disabled
+    // false if second cpu not possible (rom not supported) -> disabled
+    bool configure(SM5XX* cpu, const GW_rom* game, uint8_t mode, uint8_t nb_frame);
+    void disable();
+    bool is_active() const { return mode != RUN_AHEAD_OFF; }
+    uint8_t get_mode() const { return mode; }
+    uint8_t get_nb_frame() const { return nb_frame; }
+
+    // after real frame of cpu : present(SM5XX* future) called with segments nb_frame ahead
+    template <class Present>
+    void run(SM5XX* cpu, float fps, Present&& present){
+        SM5XX* future = run_frames_ahead(cpu, fps);
+        present(future);
+        end_frame(cpu);
+    }
+
+    // cost : time of emulation of frames ahead (+ snapshot / restore), by host frame
+    uint32_t get_last_cost_us() const { return last_cost_us; }
+    uint32_t get_average_cost_us() const { return average_cost_us; }
+
+private :
+    uint8_t mode = RUN_AHEAD_OFF;
+    uint8_t nb_frame = 0;
+    SM5XX* second_cpu = nullptr;
+    std::vector<uint8_t> state; // real state (single) or copy for second cpu, size fixed by configure
+    uint32_t curr_rate = 0; // remainder of cycles by frame, like frontend
+
+    uint64_t time_start = 0;
+    uint32_t last_cost_us = 0;
+    uint32_t average_cost_us = 0;
+    uint32_t sum_cost_us = 0;
+    uint8_t nb_cost = 0;
+
+    SM5XX* run_frames_ahead(SM5XX* cpu, float fps); // -> cpu with future state
+    void end_frame(SM5XX* cpu);
+};
@@ -4,6 +4,7 @@
 
 struct Segment {
     uint8_t id[3]; // col, line, word
+    uint16_t bit; // id resolved in SM5XX::segment_bits of cpu of game (pack load), SEGMENT_BIT_NONE if not on cpu
     int pos_scr[2]; // position screen : x, y
     uint16_t pos_tex[2]; // position in texture : x, y 
     uint16_t size_tex[2]; // size in texture : x, y
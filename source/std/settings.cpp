@@ -5,6 +5,7 @@
 #include "GW_ROM.h"
 #include <stdio.h>
 #include <string.h>
+#include <vector>
 
 // Global settings instance
 AppSettings g_settings;
@@ -17,6 +18,10 @@ static std::string last_games_by_mfr_file_path() {
     return storage_path("yokoi_gw_last_game_by_mfr.dat");
 }
 
+static std::string run_ahead_file_path() {
+    return storage_path("yokoi_gw_run_ahead.dat");
+}
+
 static constexpr size_t kLastGameRefMax = 16;
 
 // Backwards-compatible layout for when MANUFACTURER_COUNT was 2.
@@ -204,3 +209,68 @@ bool try_load_last_game_index_for_manufacturer(uint8_t manufacturer_id, uint8_t*
 
     return false;
 }
+
+// One record per game that has been configured, in the order they were first saved.
+struct RunAheadRecord {
+    char game_ref[kLastGameRefMax];
+    uint8_t mode;
+    uint8_t nb_frame;
+    uint8_t _pad[2];
+};
+
+static std::vector<RunAheadRecord> load_run_ahead_records() {
+    std::vector<RunAheadRecord> records;
+    FILE* file = fopen(run_ahead_file_path().c_str(), "rb");
+    if (!file) {
+        return records;
+    }
+    RunAheadRecord record;
+    while (fread(&record, sizeof(RunAheadRecord), 1, file) == 1) {
+        record.game_ref[kLastGameRefMax - 1] = '\0';
+        records.push_back(record);
+    }
+    fclose(file);
+    return records;
+}
+
+RunAheadSetting load_run_ahead_setting(const std::string& game_ref) {
+    RunAheadSetting setting;
+    for (const RunAheadRecord& record : load_run_ahead_records()) {
+        if (game_ref == record.game_ref) {
+            setting.mode = record.mode;
+            setting.nb_frame = record.nb_frame;
+            break;
+        }
+    }
+    return setting;
+}
+
+void save_run_ahead_setting(const std::string& game_ref, const RunAheadSetting& setting) {
+    std::vector<RunAheadRecord> records = load_run_ahead_records();
+    RunAheadRecord* found = nullptr;
+    for (RunAheadRecord& record : records) {
+        if (game_ref == record.game_ref) {
+            found = &record;
+            break;
+        }
+    }
+    if (!found) {
+        RunAheadRecord record;
+        memset(&record, 0, sizeof(record));
+        strncpy(record.game_ref, game_ref.c_str(), sizeof(record.game_ref) - 1);
+        records.push_back(record);
+        found = &records.back();
+    }
+    found->mode = setting.mode;
+    found->nb_frame = setting.nb_frame;
+
+    std::string path = run_ahead_file_path();
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        YOKOI_LOG("settings: run_ahead save open failed: '%s'", path.c_str());
+        return;
+    }
+    const size_t wrote = fwrite(records.data(), sizeof(RunAheadRecord), records.size(), file);
+    fclose(file);
+    (void)wrote;
+}
@@ -52,3 +52,12 @@ uint8_t load_last_selected_manufacturer(uint8_t default_manufacturer = 0);
 // Persists the last selected game *ref* for the given manufacturer.
 void save_last_selected_game(uint8_t manufacturer_id, const std::string& game_ref);
 bool try_load_last_game_index_for_manufacturer(uint8_t manufacturer_id, uint8_t* out_index);
+
+// Run-ahead per game (see run_ahead.h), stored by game *ref* in yokoi_gw_run_ahead.dat.
+// Game never set -> off.
+struct RunAheadSetting {
+    uint8_t mode = 0;       // Run_Ahead_Mode
+    uint8_t nb_frame = 0;   // frames emulated ahead, 0 = off
+};
+RunAheadSetting load_run_ahead_setting(const std::string& game_ref);
+void save_run_ahead_setting(const std::string& game_ref, const RunAheadSetting& setting);
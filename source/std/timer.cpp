@@ -3,8 +3,8 @@
 #if defined(__3DS__)
     #include <3ds.h>
     
-    uint64_t time_us_64_p(void) {
-        return osGetTime()* 1000ULL;
+    uint64_t time_us_64_p(void) { // system tick : precise to the us (osGetTime only ms)
+        return (uint64_t)(svcGetSystemTick() / CPU_TICKS_PER_USEC);
     }
 
     void sleep_us_p(uint64_t us) {
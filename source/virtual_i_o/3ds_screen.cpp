@@ -349,6 +349,9 @@ bool Virtual_Screen::load_visual(std::string path_segment
     index_segment_screen[1] = curr_i_screen_0;
     index_segment_screen[2] = curr_i_screen_1+1;
     index_segment_screen[3] = size_segment_list;
+    blink_filter.set_segments(list_segment.data(), list_segment.size());
+    cpu_segments_read = nullptr;
+    need_redraw = true;
 
     // Load additional information
     segment_info = v_segment_info;
@@ -382,6 +385,7 @@ void Virtual_Screen::refresh_settings(){
         curr_fond_color = g_settings.background_color;
         curr_fond_color_noise = lum_rgb8(curr_fond_color, _LUM_DARK_FOND_NOISE_);
     }
+    need_redraw = true;
     // Segment marking effect settings are already read from g_settings in update_screen()
 }
 
@@ -492,30 +496,19 @@ bool Virtual_Screen::init_visual(){
 
 ////// Used for menu of emulateur ///////////////////////////////////////////////////////////////////////////
 
-void Virtual_Screen::protect_blinking(Segment *seg, bool new_state){
-    // Protect to "blinking segment"
-    // On true G&W is not visible to segment blink (segment too slow to update)
-    // but is visible on emulator without this protection
-    
-    // see before and new value of segment for patch if is only blink
-    seg->state = seg->state && (new_state || seg->buffer_state);
-    seg->state = seg->state || (new_state && seg->buffer_state);
-}
-
-
 bool Virtual_Screen::update_buffer_video(SM5XX* cpu){
     bool screen_are_update = false;
     if(!cpu->segments_state_are_update){ return screen_are_update; } // no need to update -> Stop
-    
-    for(size_t i_seg = 0; i_seg < list_segment.size(); i_seg++){
-        Segment& curr_seg = list_segment[i_seg];
-        bool new_state = cpu->get_segments_state(curr_seg.id[0], curr_seg.id[1], curr_seg.id[2]);
-        protect_blinking(&curr_seg, new_state);
-        if(curr_seg.buffer_state != curr_seg.state){ screen_are_update = true; }
-        curr_seg.buffer_state = curr_seg.state;
-        curr_seg.state = new_state;
-    }
     cpu->segments_state_are_update = false;
+
+    // all segments compared in 4 XOR. No change and filter stable -> blink protection give same result, stop
+    uint64_t changed[SEGMENT_BITS_WORD];
+    bool segments_changed = cpu->read_segment_changes(changed) || cpu != cpu_segments_read;
+    cpu_segments_read = cpu;
+    if(!segments_changed && blink_filter.is_stable()){ return screen_are_update; }
+
+    screen_are_update = blink_filter.update(cpu->segment_bits);
+    if(screen_are_update){ need_redraw = true; }
     return screen_are_update;
 }
 
@@ -551,6 +544,7 @@ void Virtual_Screen::delete_all_text(){
 }
 
 void Virtual_Screen::update_text(bool clean){
+    need_redraw = true; // text draw on screen of game
     set_alpha_environnement();
     C3D_TexBind(0, &text_texture);
     if(size_text_screen_0 != 0){
@@ -603,6 +597,7 @@ void Virtual_Screen::delete_all_img(){
 }
 
 void Virtual_Screen::update_img(bool clean){
+    need_redraw = true;
     set_screen_down();
     set_base_environnement();
     if(clean){ C3D_RenderTargetClear(target_down, C3D_CLEAR_ALL, (FOND_COLOR_MENU<<8)|0xFF, 0); }
@@ -801,8 +796,7 @@ void Virtual_Screen::create_shadow(int nb_render, int i_render, int curr_screen)
     C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, uLoc_modelView, &modelView_tmp); // transfert Transformation Matrix to gpu (to vertex shader)
     
     for(size_t i = index_segment_screen[curr_screen*2]; i < index_segment_screen[curr_screen*2+1]; i++){
-        Segment seg_gw = list_segment[i];
-        if(seg_gw.buffer_state){ C3D_DrawArrays(GPU_TRIANGLES, seg_gw.index_vertex, 6); }
+        if(blink_filter.is_visible(i)){ C3D_DrawArrays(GPU_TRIANGLES, list_segment[i].index_vertex, 6); }
     }
 
 
@@ -856,8 +850,8 @@ void Virtual_Screen::create_segment(int nb_render, int i_render, int curr_screen
     uint8_t alpha_segment = (background_info[i_camera(nb_screen)] == 1) ? 0xA0: 0xFF;
     // create true segment
     for(size_t i = index_segment_screen[curr_screen*2]; i < index_segment_screen[curr_screen*2+1]; i++){
-        Segment seg_gw = list_segment[i];
-        if(seg_gw.buffer_state){ // segment is activ / visible
+        const Segment& seg_gw = list_segment[i];
+        if(blink_filter.is_visible(i)){ // segment is activ / visible
             change_alpha_color_environnement(SEGMENT_COLOR[seg_gw.color_index], alpha_segment); // function already check if necessary, useful for Crab and spitball
             C3D_DrawArrays(GPU_TRIANGLES, seg_gw.index_vertex, 6); 
         }
@@ -938,8 +932,18 @@ void Virtual_Screen::create_border(int nb_render, int i_render, int curr_screen)
 ////// loop of screen ///////////////////////////////////////////////////////////////////////////
 
 
+bool Virtual_Screen::screen_need_update(){
+    // frame on screen stay if nothing draw between C3D_FrameBegin / C3D_FrameEnd (target not swapped)
+    if(need_redraw){ return true; }
+    if(background_info[i_camera(nb_screen)] == 1){ return true; } // camera -> new image each frame
+    return osGet3DSliderState() != slider_3d_drawn;
+}
+
+
 void Virtual_Screen::update_screen(){
     int nb_render_to_make = 1; 
+    need_redraw = false;
+    slider_3d_drawn = osGet3DSliderState();
     
     for(int curr_screen = 0; curr_screen < nb_screen; curr_screen++){
 
@@ -4,6 +4,7 @@
 #include <string>
 #include "SM5XX/SM5XX.h"
 #include "std/segment.h"
+#include "std/blink_filter.h"
 #include "std/settings.h"
 
 #include "virtual_i_o/3ds_camera.h"
@@ -52,6 +53,10 @@ class Virtual_Screen {
         std::string img_texture_path[nb_img_interface_max];
 
         std::vector<Segment> list_segment;
+        Blink_Filter blink_filter; // visible state of list_segment
+        const SM5XX* cpu_segments_read = nullptr; // segment_bits of this cpu in blink_filter
+        bool need_redraw = true; // something visible changed since last update_screen (segments, settings, text)
+        float slider_3d_drawn = -1; // osGet3DSliderState() of last update_screen
         uint32_t index_segment_screen[4];
         const uint16_t* segment_info;
 
@@ -104,6 +109,8 @@ class Virtual_Screen {
                         , const uint16_t* v_background_info );
         bool init_visual();
         bool update_buffer_video(SM5XX* cpu);
+        bool screen_need_update(); // false -> frame on screen is still good, update_screen can be skipped
+        void set_need_redraw() { need_redraw = true; }
         void update_screen();
         void Quit_Game();
         void Exit();
@@ -120,8 +127,6 @@ class Virtual_Screen {
         std::vector<int> pos_fond;
 
     private:
-        void protect_blinking(Segment *seg, bool new_state);
-
         void set_base_environnement();
         void set_alpha_environnement(uint8_t alpha_multiply = 0xFF);
         void set_color_environnement(uint32_t color);
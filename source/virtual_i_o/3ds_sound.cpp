@@ -36,24 +36,46 @@ void Virtual_Sound::initialize(uint32_t v_freq, uint16_t v_divide_freq, float v_
 
     curr_buffer = 0;
     curr_sequence = 0;
-    curr_wait_before_update = 0;
+    accu_sample_q16 = 0;
     accu_freq_sequence = 0;
     curr_value = false;
+    set_speed(SPEED_NORMAL);
 
 	ndspChnSetRate(0, (base_freq/divide_freq)); 
     ndspChnSetPaused(0, false);
 }
 
 
-void Virtual_Sound::update_sound(SM5XX* cpu){
-    curr_wait_before_update += 1;
-    curr_value = curr_value || cpu->get_active_sound();
-    if(curr_wait_before_update < divide_freq){ return; } // if divide_freq = 1 -> Always update
-    curr_wait_before_update = 0;
-    if(curr_sequence < curr_size_buffer[curr_buffer] && curr_sequence < length_max_sequence){
-        buffer_sound[curr_buffer][2*curr_sequence] =  (curr_value ? int(INT16_MAX*LIMIT_SQUARE) : 0);
-        buffer_sound[curr_buffer][2*curr_sequence+1] =  (curr_value ? int(INT16_MAX*LIMIT_SQUARE) : 0);
-        curr_sequence += 1;
+void Virtual_Sound::update_sound(SM5XX* cpu){ push_sound_value(cpu->get_active_sound()); }
+
+void Virtual_Sound::set_speed(uint16_t percent){
+    mute = (percent == SPEED_UNCAPPED || percent > SPEED_SOUND_MAX);
+    sample_step_q16 = mute ? 0 : speed_sample_step_q16(divide_freq, percent);
+    accu_sample_q16 = 0;
+}
+
+void Virtual_Sound::update_sound(const Cycle_Events& events, uint32_t nb_cycle){
+    if(mute){ return; }
+    // rebuild value of each cycle of the batch from the sound edges
+    bool value = events.sound_start;
+    uint16_t i_edge = 0;
+    for(uint32_t i_cycle = 0; i_cycle < nb_cycle; i_cycle++){
+        if(i_edge < events.nb_sound_edge && events.sound_edge[i_edge] == i_cycle){ value = !value; i_edge++; }
+        push_sound_value(value);
+    }
+}
+
+void Virtual_Sound::push_sound_value(bool value){
+    curr_value = curr_value || value;
+    accu_sample_q16 += sample_step_q16; // normal speed : 1 sample each divide_freq cycles
+    if(accu_sample_q16 < (1 << 16)){ return; }
+    while(accu_sample_q16 >= (1 << 16)){ // slow-motion -> same sample several times
+        accu_sample_q16 -= (1 << 16);
+        if(curr_sequence < curr_size_buffer[curr_buffer] && curr_sequence < length_max_sequence){
+            buffer_sound[curr_buffer][2*curr_sequence] =  (curr_value ? int(INT16_MAX*LIMIT_SQUARE) : 0);
+            buffer_sound[curr_buffer][2*curr_sequence+1] =  (curr_value ? int(INT16_MAX*LIMIT_SQUARE) : 0);
+            curr_sequence += 1;
+        }
     }
     curr_value = false;
     //lissage_sound();
@@ -74,7 +96,7 @@ void Virtual_Sound::lissage_sound(){
 
 
 void Virtual_Sound::play_sample(){
-    uint32_t last_value = buffer_sound[curr_buffer][2*max(curr_sequence-1, 0)];
+    uint32_t last_value = mute ? 0 : buffer_sound[curr_buffer][2*max(curr_sequence-1, 0)];
     while(curr_sequence < curr_size_buffer[curr_buffer] && curr_sequence < length_max_sequence){ 
         // ading last value for not make 'empty' value
         buffer_sound[curr_buffer][2*curr_sequence] =  last_value;
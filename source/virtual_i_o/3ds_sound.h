@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SM5XX/SM5XX.h"
+#include "std/emulation_speed.h"
 #include <cstdint>
 #include <3ds.h>
 
@@ -16,7 +17,9 @@ class Virtual_Sound {
         uint8_t curr_buffer = 0;
         uint16_t curr_sequence = 0;
         uint16_t length_max_sequence;
-        uint16_t curr_wait_before_update = 0;
+        uint32_t accu_sample_q16 = 0; // part of sample done (16.16)
+        uint32_t sample_step_q16 = 1 << 16; // samples by cycle, depend of speed
+        bool mute = false;
 
         bool curr_value;
         uint32_t accu_freq_sequence = 0;
@@ -29,10 +32,13 @@ class Virtual_Sound {
         void initialize(uint32_t v_freq, uint16_t v_divide_freq, float fps_screen);
         void play_sample();
         void update_sound(SM5XX* cpu);
+        void update_sound(const Cycle_Events& events, uint32_t nb_cycle); // after a run_cycles of cpu
+        void set_speed(uint16_t percent); // Emulation_Speed : samples skipped or repeated, muted if too fast
         void Quit_Game();
         void Exit();
 
     private : 
+        void push_sound_value(bool value);
         //void lissage_sound();
 
 };